@@ -189,6 +189,7 @@ testScripts = [
     'sigma_resetsigmamint_validation.py',
     'sigma_setsigmamintstatus_validation.py',
     'sigma_spend_gettransaction.py',
+    'sigma_rest_anonymityset.py',
     'sigma_spend_validation.py',
     'sigma_spend_extra_validation.py',
     'sigma_mint_validation.py',
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Firo Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#
+# Test paging through the Sigma anonymity set with /rest/anonymityset
+#
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import *
+
+import http.client
+import json
+import urllib.parse
+
+DENOMINATION = 100000000 # 1 coin
+
+def http_get(url, path, headers = {}):
+    conn = http.client.HTTPConnection(url.hostname, url.port)
+    conn.request('GET', path, headers=headers)
+    return conn.getresponse()
+
+class SigmaRestAnonymitySetTest(BitcoinTestFramework):
+    def __init__(self):
+        super().__init__()
+        self.num_nodes = 1
+        self.setup_clean_chain = False
+
+    def setup_nodes(self):
+        # This test requires mocktime
+        enable_mocktime()
+        return start_nodes(self.num_nodes, self.options.tmpdir)
+
+    def get_chunk(self, start):
+        response = http_get(self.url, '/rest/anonymityset/%d/1/%d.json' % (DENOMINATION, start))
+        assert_equal(response.status, 200)
+        chunk = json.loads(response.read().decode('utf-8'))
+        assert_equal(response.getheader('ETag'), '"' + chunk['setHash'] + '"')
+        return chunk
+
+    def run_test(self):
+        self.url = urllib.parse.urlparse(self.nodes[0].url)
+
+        for i in range(4):
+            self.nodes[0].mint(1)
+            self.nodes[0].generate(1)
+        self.nodes[0].generate(1)
+
+        full = self.get_chunk(0)
+        assert_equal(full['total'], 4)
+        assert_equal(len(full['serializedCoins']), 4)
+
+        # a chunk starting further holds the same coins as the full set from there on
+        page = self.get_chunk(2)
+        assert_equal(page['start'], 2)
+        assert_equal(page['setHash'], full['setHash'])
+        assert_equal(page['serializedCoins'], full['serializedCoins'][2:])
+
+        # the client already has the latest set
+        response = http_get(self.url, '/rest/anonymityset/%d/1.json' % DENOMINATION, {'If-None-Match': '"' + full['setHash'] + '"'})
+        assert_equal(response.status, 304)
+
+        # a block with new coins arrives while the client pages through the set
+        self.nodes[0].mint(2)
+        self.nodes[0].generate(2)
+
+        # the coins already downloaded keep their indexes, the new ones are appended
+        page = self.get_chunk(2)
+        assert_equal(page['total'], 6)
+        assert_equal(page['serializedCoins'][:2], full['serializedCoins'][2:])
+        assert(page['setHash'] != full['setHash'])
+
+        updated = self.get_chunk(0)
+        assert_equal(updated['serializedCoins'][:4], full['serializedCoins'])
+        assert_equal(updated['serializedCoins'][2:], page['serializedCoins'])
+        assert_equal(updated['setHash'], page['setHash'])
+
+        response = http_get(self.url, '/rest/anonymityset/%d/1.json' % DENOMINATION, {'If-None-Match': '"' + full['setHash'] + '"'})
+        assert_equal(response.status, 200)
+
+        # a start past the end of the set is rejected
+        response = http_get(self.url, '/rest/anonymityset/%d/1/7.json' % DENOMINATION)
+        assert_equal(response.status, 400)
+
+if __name__ == '__main__':
+    SigmaRestAnonymitySetTest().main()
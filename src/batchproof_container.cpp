@@ -1,11 +1,82 @@
 #include "batchproof_container.h"
 #include "liblelantus/sigmaextended_verifier.h"
+#include "liblelantus/lelantus_verifier.h"
 #include "sigma/sigmaplus_verifier.h"
 #include "sigma.h"
 #include "lelantus.h"
+#include "ctpl.h"
+#include "utiltime.h"
+
+#include <numeric>
 
 std::unique_ptr<BatchProofContainer> BatchProofContainer::instance;
 
+// Splits the range [begin, end) of a batch which failed verification into halves, verifying each
+// as a separate batch, until the failing proofs are singled out. Their indexes are added to failed.
+template<typename BatchVerify>
+static void BisectFailedBatch(size_t begin, size_t end, const BatchVerify& verify, std::vector<size_t>& failed) {
+    if (end - begin == 1) {
+        failed.push_back(begin);
+        return;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    if (!verify(begin, middle))
+        BisectFailedBatch(begin, middle, verify, failed);
+    if (!verify(middle, end))
+        BisectFailedBatch(middle, end, verify, failed);
+}
+
+// Splits the groups into chunks of at least BATCH_CHUNK_MIN_PROOFS proofs, so there are about as many chunks
+// as workers, and verifies each chunk as one batch with verify(group, begin, end). Chunks run on the worker
+// pool when there is one, failed chunks are bisected on their worker.
+template<typename GroupVerify>
+static void RunBatchJobs(ctpl::thread_pool* workerPool,
+                         const std::vector<size_t>& groupSizes,
+                         const GroupVerify& verify,
+                         std::vector<BatchProofContainer::BatchJob>& jobs) {
+    size_t nWorkers = workerPool ? std::max(workerPool->size(), 1) : 1;
+    size_t nProofs = std::accumulate(groupSizes.begin(), groupSizes.end(), size_t(0));
+    size_t chunkSize = std::max(BATCH_CHUNK_MIN_PROOFS, (nProofs + nWorkers - 1) / nWorkers);
+
+    for (size_t group = 0; group < groupSizes.size(); group++) {
+        size_t nChunks = (groupSizes[group] + chunkSize - 1) / chunkSize;
+        for (size_t chunk = 0; chunk < nChunks; chunk++) {
+            BatchProofContainer::BatchJob job;
+            job.group = group;
+            // spread the proofs evenly instead of leaving a short last chunk
+            job.begin = groupSizes[group] * chunk / nChunks;
+            job.end = groupSizes[group] * (chunk + 1) / nChunks;
+            jobs.push_back(job);
+        }
+    }
+
+    auto run = [&verify](BatchProofContainer::BatchJob& job) {
+        int64_t nTimeStart = GetTimeMicros();
+        auto chunkVerify = [&](size_t begin, size_t end) { return verify(job.group, begin, end); };
+        job.fValid = chunkVerify(job.begin, job.end);
+        if (!job.fValid)
+            BisectFailedBatch(job.begin, job.end, chunkVerify, job.failed);
+        job.nTime = GetTimeMicros() - nTimeStart;
+    };
+
+    if (!workerPool || workerPool->size() == 0 || jobs.size() < 2) {
+        for (auto& job : jobs)
+            run(job);
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(jobs.size());
+    for (auto& job : jobs)
+        futures.emplace_back(workerPool->push([&run, &job](int threadId) { run(job); }));
+    // wait for all the jobs before rethrowing, they reference this frame
+    for (auto& f : futures)
+        f.wait();
+    for (auto& f : futures)
+        f.get();
+}
+
 BatchProofContainer* BatchProofContainer::get_instance() {
     if (instance) {
         return instance.get();
@@ -15,9 +86,15 @@ BatchProofContainer* BatchProofContainer::get_instance() {
     }
 }
 
-void BatchProofContainer::init() {
+BatchProofContainer::~BatchProofContainer() {
+    stopWorkers();
+}
+
+void BatchProofContainer::init(const uint256& blockHash) {
+    currentBlockHash = blockHash;
     tempSigmaProofs.clear();
     tempLelantusSigmaProofs.clear();
+    tempRangeProofs.clear();
 }
 
 void BatchProofContainer::finalize() {
@@ -29,6 +106,10 @@ void BatchProofContainer::finalize() {
         for (const auto& itr : tempLelantusSigmaProofs) {
             lelantusSigmaProofs[itr.first].insert(lelantusSigmaProofs[itr.first].begin(), itr.second.begin(), itr.second.end());
         }
+
+        for (const auto& itr : tempRangeProofs) {
+            rangeProofs[itr.first].insert(rangeProofs[itr.first].begin(), itr.second.begin(), itr.second.end());
+        }
     } else {
         batch_sigma();
         batch_lelantus();
@@ -40,16 +121,21 @@ void BatchProofContainer::add(sigma::CoinSpend* spend,
                               bool fPadding,
                               int group_id,
                               size_t setSize,
-                              bool fStartSigmaBlacklist) {
+                              bool fStartSigmaBlacklist,
+                              const uint256& txHash) {
+    LOCK(cs_tempProofs);
     std::pair<sigma::CoinDenomination,  std::pair<int, bool>> denominationAndId = std::make_pair(
             spend->getDenomination(), std::make_pair(group_id, fStartSigmaBlacklist));
-    tempSigmaProofs[denominationAndId].push_back(SigmaProofData(spend->getProof(), spend->getCoinSerialNumber(), fPadding, setSize));
+    tempSigmaProofs[denominationAndId].push_back(SigmaProofData(spend->getProof(), spend->getCoinSerialNumber(), fPadding, setSize, txHash, currentBlockHash));
 }
 
 void BatchProofContainer::add(lelantus::JoinSplit* joinSplit,
                               const std::map<uint32_t, size_t>& setSizes,
                               const Scalar& challenge,
-                              bool fStartLelantusBlacklist) {
+                              const std::vector<lelantus::PublicCoin>& Cout,
+                              bool fStartLelantusBlacklist,
+                              const uint256& txHash) {
+    LOCK(cs_tempProofs);
     const std::vector<lelantus::SigmaExtendedProof>& sigma_proofs = joinSplit->getLelantusProof().sigma_proofs;
     const std::vector<Scalar>& serials = joinSplit->getCoinSerialNumbers();
     const std::vector<uint32_t>& groupIds = joinSplit->getCoinGroupIds();
@@ -63,8 +149,11 @@ void BatchProofContainer::add(lelantus::JoinSplit* joinSplit,
         bool isSigma = sigma::IntegerToDenomination(intDenom, denomination) && joinSplit->isSigmaToLelantus();
         // pair(pair(set id, fAfterFixes), isSigmaToLelantus)
         std::pair<std::pair<uint32_t, bool>, bool> idAndFlag = std::make_pair(std::make_pair(groupIds[i], fStartLelantusBlacklist), isSigma);
-        tempLelantusSigmaProofs[idAndFlag].push_back(LelantusSigmaProofData(sigma_proofs[i], serials[i], challenge, setSizes.at(groupIds[i])));
+        tempLelantusSigmaProofs[idAndFlag].push_back(LelantusSigmaProofData(sigma_proofs[i], serials[i], challenge, setSizes.at(groupIds[i]), txHash, currentBlockHash));
     }
+
+    if (!Cout.empty())
+        tempRangeProofs[joinSplit->getVersion()].push_back(RangeProofData(joinSplit->getLelantusProof().bulletproofs, Cout, serials, txHash, currentBlockHash));
 }
 
 void BatchProofContainer::removeSigma(const sigma::spend_info_container& spendSerials) {
@@ -107,6 +196,16 @@ void BatchProofContainer::removeLelantus(std::unordered_map<Scalar, int> spentSe
             vProofs = &lelantusSigmaProofs[key2];
             erase(vProofs, spendSerial.first);
         }
+
+        for (auto& itr : rangeProofs) {
+            auto& vRangeProofs = itr.second;
+            vRangeProofs.erase(std::remove_if(vRangeProofs.begin(),
+                                              vRangeProofs.end(),
+                                              [&spendSerial](const RangeProofData& proof) {
+                                                  return std::find(proof.serials.begin(), proof.serials.end(), spendSerial.first) != proof.serials.end();
+                                              }),
+                               vRangeProofs.end());
+        }
     }
 }
 
@@ -118,58 +217,109 @@ void BatchProofContainer::erase(std::vector<LelantusSigmaProofData>* vProofs, co
 
 }
 
-void BatchProofContainer::batch_sigma() {
-    for (const auto& itr : sigmaProofs) {
-        std::vector<GroupElement> anonymity_set;
-        sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
+bool BatchProofContainer::verify_sigma(const SigmaProofs& proofs, bool fUpToLastBlock, std::vector<const SigmaProofData*>& failed) {
+    auto params = sigma::Params::get_default();
+    sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
+
+    // anonymity sets are read from the state on this thread, only the batches go to the workers
+    std::vector<const SigmaProofs::value_type*> groups;
+    std::vector<std::vector<GroupElement>> anonymity_sets;
+    for (const auto& itr : proofs) {
+        if (itr.second.empty())
+            continue;
+        groups.push_back(&itr);
+        anonymity_sets.emplace_back();
         sigmaState->GetAnonymitySet(
                 itr.first.first,
                 itr.first.second.first,
                 itr.first.second.second,
-                anonymity_set);
+                anonymity_sets.back(),
+                fUpToLastBlock);
+    }
 
-        size_t m = itr.second.size();
+    // verifies proofs [begin, end) of the group as one batch
+    auto verify = [&](size_t group, size_t begin, size_t end) {
+        const std::vector<SigmaProofData>& groupProofs = groups[group]->second;
+        sigma::SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m(), &params->get_h_multiexp());
+
+        size_t m = end - begin;
         std::vector<Scalar> serials;
         serials.reserve(m);
         std::vector<bool> fPadding;
         fPadding.reserve(m);
         std::vector<size_t> setSizes;
         setSizes.reserve(m);
-        std::vector<sigma::SigmaPlusProof<Scalar, GroupElement>> proofs;
-        proofs.reserve(m);
-
-        for (auto& proofData : itr.second) {
+        std::vector<sigma::SigmaPlusProof<Scalar, GroupElement>> sigmaProofs;
+        sigmaProofs.reserve(m);
+
+        for (size_t i = begin; i < end; i++) {
+            const SigmaProofData& proofData = groupProofs[i];
+            // a proof over more coins than the batch has can't be checked against it
+            if (proofData.anonymitySetSize == 0 || proofData.anonymitySetSize > anonymity_sets[group].size())
+                return false;
             serials.emplace_back(proofData.coinSerialNumber);
             fPadding.emplace_back(proofData.fPadding);
             setSizes.emplace_back(proofData.anonymitySetSize);
-            proofs.emplace_back(proofData.sigmaProof);
+            sigmaProofs.emplace_back(proofData.sigmaProof);
         }
 
-        auto params = sigma::Params::get_default();
-        sigma::SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m());
-
-        if (!sigmaVerifier.batch_verify(anonymity_set, serials, fPadding, setSizes, proofs)) {
-            LogPrintf("Sigma batch verification failed.");
-            throw std::invalid_argument("Sigma batch verification failed, please run Firo with -reindex -batching=0");
+        return sigmaVerifier.batch_verify(anonymity_sets[group], serials, fPadding, setSizes, sigmaProofs);
+    };
+
+    std::vector<size_t> groupSizes;
+    for (auto group : groups)
+        groupSizes.push_back(group->second.size());
+
+    std::vector<BatchJob> jobs;
+    RunBatchJobs(workerPool.get(), groupSizes, verify, jobs);
+
+    bool fValid = true;
+    std::vector<int64_t> groupTimes(groups.size(), 0);
+    for (const BatchJob& job : jobs) {
+        groupTimes[job.group] += job.nTime;
+        if (job.fValid)
+            continue;
+
+        fValid = false;
+        const std::vector<SigmaProofData>& groupProofs = groups[job.group]->second;
+        LogPrintf("Sigma batch verification failed for proofs %d-%d of denomination %d group %d\n",
+                  job.begin, job.end, (int)groups[job.group]->first.first, groups[job.group]->first.second.first);
+        for (size_t i : job.failed) {
+            const SigmaProofData& proofData = groupProofs[i];
+            LogPrintf("Sigma proof verification failed, serial %s, transaction %s, block %s\n",
+                      proofData.coinSerialNumber.GetHex(), proofData.txHash.ToString(), proofData.blockHash.ToString());
+            failed.push_back(&proofData);
         }
     }
-    sigmaProofs.clear();
+
+    for (size_t i = 0; i < groups.size(); i++)
+        LogPrint("bench", "    - Sigma batch verification of denomination %d group %d: %u proofs, %.2fms\n",
+                 (int)groups[i]->first.first, groups[i]->first.second.first, groupSizes[i], 0.001 * groupTimes[i]);
+
+    return fValid;
 }
 
-void BatchProofContainer::batch_lelantus() {
+bool BatchProofContainer::verify_lelantus(const LelantusSigmaProofs& proofs, bool fUpToLastBlock, std::vector<const LelantusSigmaProofData*>& failed) {
     auto params = lelantus::Params::get_default();
 
-    for (const auto& itr : lelantusSigmaProofs) {
-        std::vector<GroupElement> anonymity_set;
+    // anonymity sets are read from the state on this thread, only the batches go to the workers
+    std::vector<const LelantusSigmaProofs::value_type*> groups;
+    std::vector<std::vector<GroupElement>> anonymity_sets;
+    for (const auto& itr : proofs) {
+        if (itr.second.empty())
+            continue;
+        groups.push_back(&itr);
+        anonymity_sets.emplace_back();
+        std::vector<GroupElement>& anonymity_set = anonymity_sets.back();
+
         if (!itr.first.second) {
             lelantus::CLelantusState* state = lelantus::CLelantusState::GetState();
-            std::vector<lelantus::PublicCoin> coins;
-            state->GetAnonymitySet(
+            lelantus::AnonymitySetPtr coins = state->GetAnonymitySet(
                     itr.first.first.first,
                     itr.first.first.second,
-                    coins);
-            anonymity_set.reserve(coins.size());
-            for (auto& coin : coins)
+                    fUpToLastBlock);
+            anonymity_set.reserve(coins->nCoins);
+            for (auto& coin : coins->coins())
                 anonymity_set.emplace_back(coin.getValue());
         } else {
             int coinGroupId = itr.first.first.first % (CENT / 1000);
@@ -184,49 +334,227 @@ void BatchProofContainer::batch_lelantus() {
                     denomination,
                     coinGroupId,
                     true,
-                    coins);
+                    coins,
+                    fUpToLastBlock);
 
             anonymity_set.reserve(coins.size());
             for (auto& coin : coins)
                 anonymity_set.emplace_back(coin + params->get_h1() * intDenom);
         }
+    }
+
+    // verifies proofs [begin, end) of the group as one batch
+    auto verify = [&](size_t group, size_t begin, size_t end) {
+        const std::vector<LelantusSigmaProofData>& groupProofs = groups[group]->second;
+        lelantus::SigmaExtendedVerifier sigmaVerifier(params->get_g(), params->get_sigma_h(), params->get_sigma_n(),
+                                            params->get_sigma_m(), &params->get_sigma_h_multiexp());
 
-        size_t m = itr.second.size();
+        size_t m = end - begin;
         std::vector<Scalar> serials;
         serials.reserve(m);
         std::vector<size_t> setSizes;
         setSizes.reserve(m);
-        std::vector<lelantus::SigmaExtendedProof> proofs;
-        proofs.reserve(m);
+        std::vector<lelantus::SigmaExtendedProof> sigmaProofs;
+        sigmaProofs.reserve(m);
         std::vector<Scalar> challenges;
         challenges.reserve(m);
 
-        for (auto& proofData : itr.second) {
+        for (size_t i = begin; i < end; i++) {
+            const LelantusSigmaProofData& proofData = groupProofs[i];
+            // a proof over more coins than the batch has can't be checked against it
+            if (proofData.anonymitySetSize == 0 || proofData.anonymitySetSize > anonymity_sets[group].size())
+                return false;
             serials.emplace_back(proofData.serialNumber);
             setSizes.emplace_back(proofData.anonymitySetSize);
-            proofs.emplace_back(proofData.lelantusSigmaProof);
+            sigmaProofs.emplace_back(proofData.lelantusSigmaProof);
             challenges.emplace_back(proofData.challenge);
         }
 
-        lelantus::SigmaExtendedVerifier sigmaVerifier(params->get_g(), params->get_sigma_h(), params->get_sigma_n(),
-                                            params->get_sigma_m());
-
-        bool isFail = false;
         try {
-            if (!sigmaVerifier.batchverify(anonymity_set, challenges, serials, setSizes, proofs)) {
-                isFail = true;
-            }
+            return sigmaVerifier.batchverify(anonymity_sets[group], challenges, serials, setSizes, sigmaProofs);
         } catch (std::invalid_argument&) {
-            isFail = true;
+            return false;
+        }
+    };
+
+    std::vector<size_t> groupSizes;
+    for (auto group : groups)
+        groupSizes.push_back(group->second.size());
+
+    std::vector<BatchJob> jobs;
+    RunBatchJobs(workerPool.get(), groupSizes, verify, jobs);
+
+    bool fValid = true;
+    std::vector<int64_t> groupTimes(groups.size(), 0);
+    for (const BatchJob& job : jobs) {
+        groupTimes[job.group] += job.nTime;
+        if (job.fValid)
+            continue;
+
+        fValid = false;
+        const std::vector<LelantusSigmaProofData>& groupProofs = groups[job.group]->second;
+        LogPrintf("Lelantus batch verification failed for proofs %d-%d of group %d\n",
+                  job.begin, job.end, groups[job.group]->first.first.first);
+        for (size_t i : job.failed) {
+            const LelantusSigmaProofData& proofData = groupProofs[i];
+            LogPrintf("Lelantus proof verification failed, serial %s, transaction %s, block %s\n",
+                      proofData.serialNumber.GetHex(), proofData.txHash.ToString(), proofData.blockHash.ToString());
+            failed.push_back(&proofData);
         }
+    }
 
-        if (isFail) {
-            LogPrintf("Lelantus batch verification failed.");
-            throw std::invalid_argument("Lelantus batch verification failed, please run Firo with -reindex -batching=0");
+    for (size_t i = 0; i < groups.size(); i++)
+        LogPrint("bench", "    - Lelantus batch verification of group %d: %u proofs, %.2fms\n",
+                 groups[i]->first.first.first, groupSizes[i], 0.001 * groupTimes[i]);
+
+    return fValid;
+}
+
+bool BatchProofContainer::verify_range(const RangeProofs& proofs, std::vector<const RangeProofData*>& failed) {
+    auto params = lelantus::Params::get_default();
+
+    std::vector<const RangeProofs::value_type*> groups;
+    for (const auto& itr : proofs) {
+        if (!itr.second.empty())
+            groups.push_back(&itr);
+    }
+
+    // verifies proofs [begin, end) of the version as one batch
+    auto verify = [&](size_t group, size_t begin, size_t end) {
+        const std::vector<RangeProofData>& groupProofs = groups[group]->second;
+        std::vector<const std::vector<lelantus::PublicCoin>*> Couts;
+        Couts.reserve(end - begin);
+        std::vector<const lelantus::RangeProof*> bulletproofs;
+        bulletproofs.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            Couts.push_back(&groupProofs[i].Cout);
+            bulletproofs.push_back(&groupProofs[i].rangeProof);
+        }
+
+        lelantus::LelantusVerifier verifier(params, groups[group]->first);
+        try {
+            return verifier.verify_rangeproofs(Couts, bulletproofs);
+        } catch (std::invalid_argument&) {
+            return false;
+        }
+    };
+
+    std::vector<size_t> groupSizes;
+    for (auto group : groups)
+        groupSizes.push_back(group->second.size());
+
+    std::vector<BatchJob> jobs;
+    RunBatchJobs(workerPool.get(), groupSizes, verify, jobs);
+
+    bool fValid = true;
+    std::vector<int64_t> groupTimes(groups.size(), 0);
+    for (const BatchJob& job : jobs) {
+        groupTimes[job.group] += job.nTime;
+        if (job.fValid)
+            continue;
+
+        fValid = false;
+        const std::vector<RangeProofData>& groupProofs = groups[job.group]->second;
+        LogPrintf("Range proof batch verification failed for proofs %d-%d of version %d\n",
+                  job.begin, job.end, groups[job.group]->first);
+        for (size_t i : job.failed) {
+            const RangeProofData& proofData = groupProofs[i];
+            LogPrintf("Range proof verification failed, transaction %s, block %s\n",
+                      proofData.txHash.ToString(), proofData.blockHash.ToString());
+            failed.push_back(&proofData);
         }
     }
 
+    for (size_t i = 0; i < groups.size(); i++)
+        LogPrint("bench", "    - Range proof batch verification of version %d: %u proofs, %.2fms\n",
+                 groups[i]->first, groupSizes[i], 0.001 * groupTimes[i]);
+
+    return fValid;
+}
+
+void BatchProofContainer::batch_sigma() {
+    std::vector<const SigmaProofData*> failed;
+    if (!verify_sigma(sigmaProofs, false, failed)) {
+        if (failed.empty())
+            throw std::invalid_argument("Sigma batch verification failed, please run Firo with -reindex -batching=0");
+
+        for (const SigmaProofData* proofData : failed)
+            failedBlocks.insert(proofData->blockHash);
+    }
+    sigmaProofs.clear();
+}
+
+void BatchProofContainer::batch_lelantus() {
+    std::vector<const LelantusSigmaProofData*> failed;
+    if (!verify_lelantus(lelantusSigmaProofs, false, failed)) {
+        if (failed.empty())
+            throw std::invalid_argument("Lelantus batch verification failed, please run Firo with -reindex -batching=0");
+
+        for (const LelantusSigmaProofData* proofData : failed)
+            failedBlocks.insert(proofData->blockHash);
+    }
     lelantusSigmaProofs.clear();
+
+    std::vector<const RangeProofData*> failedRange;
+    if (!verify_range(rangeProofs, failedRange)) {
+        if (failedRange.empty())
+            throw std::invalid_argument("Range proof batch verification failed, please run Firo with -reindex -batching=0");
+
+        for (const RangeProofData* proofData : failedRange)
+            failedBlocks.insert(proofData->blockHash);
+    }
+    rangeProofs.clear();
+}
+
+bool BatchProofContainer::verify_block(std::set<uint256>& failedTxs) {
+    LOCK(cs_tempProofs);
+
+    std::vector<const SigmaProofData*> failedSigma;
+    std::vector<const LelantusSigmaProofData*> failedLelantus;
+    std::vector<const RangeProofData*> failedRange;
+    // a failed batch, even if bisection singles out no proof, makes the block invalid. The spends of
+    // this block may use the coins minted at the tip, so the sets go up to the last block of the group.
+    bool fValid = verify_sigma(tempSigmaProofs, true, failedSigma);
+    fValid = verify_lelantus(tempLelantusSigmaProofs, true, failedLelantus) && fValid;
+    fValid = verify_range(tempRangeProofs, failedRange) && fValid;
+
+    for (const SigmaProofData* proofData : failedSigma)
+        failedTxs.insert(proofData->txHash);
+    for (const LelantusSigmaProofData* proofData : failedLelantus)
+        failedTxs.insert(proofData->txHash);
+    for (const RangeProofData* proofData : failedRange)
+        failedTxs.insert(proofData->txHash);
+
+    // the proofs are verified, nothing is left for finalize() to collect
+    tempSigmaProofs.clear();
+    tempLelantusSigmaProofs.clear();
+    tempRangeProofs.clear();
+    fCollectProofs = false;
+    return fValid;
+}
+
+void BatchProofContainer::startWorkers(int nThreads) {
+    if (nThreads <= 1 || workerPool)
+        return;
+    workerPool.reset(new ctpl::thread_pool(nThreads));
+    RenameThreadPool(*workerPool, "firo-batchverify");
+}
+
+void BatchProofContainer::stopWorkers() {
+    if (!workerPool)
+        return;
+    workerPool->stop(true);
+    workerPool.reset();
+}
+
+std::set<uint256> BatchProofContainer::takeFailedBlocks() {
+    std::set<uint256> result;
+    result.swap(failedBlocks);
+    return result;
+}
+
+void BatchProofContainer::addFailedBlocks(const std::set<uint256>& blocks) {
+    failedBlocks.insert(blocks.begin(), blocks.end());
 }
 
 
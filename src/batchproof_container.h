@@ -2,12 +2,21 @@
 #define FIRO_BATCHPROOF_CONTAINER_H
 
 #include <memory>
+#include <set>
 #include "chain.h"
+#include "sync.h"
 #include "sigma/coinspend.h"
 #include "liblelantus/joinsplit.h"
 
 extern CChain chainActive;
 
+namespace ctpl {
+class thread_pool;
+}
+
+// groups with more proofs are split into chunks verified as separate batches, to keep all workers busy
+static const size_t BATCH_CHUNK_MIN_PROOFS = 64;
+
 class BatchProofContainer {
 public:
     static BatchProofContainer* get_instance();
@@ -17,35 +26,87 @@ public:
         SigmaProofData(const sigma::SigmaPlusProof<Scalar, GroupElement>& sigmaProof_,
                        const Scalar& coinSerialNumber_,
                        bool fPadding_,
-                       size_t anonymitySetSize_)
+                       size_t anonymitySetSize_,
+                       const uint256& txHash_,
+                       const uint256& blockHash_)
                        : sigmaProof(sigmaProof_),
                        coinSerialNumber(coinSerialNumber_),
                        fPadding(fPadding_),
-                       anonymitySetSize(anonymitySetSize_) {}
+                       anonymitySetSize(anonymitySetSize_),
+                       txHash(txHash_),
+                       blockHash(blockHash_) {}
 
         sigma::SigmaPlusProof<Scalar, GroupElement> sigmaProof;
         Scalar coinSerialNumber;
         bool fPadding;
         size_t anonymitySetSize;
+        // transaction and block the proof came from, to find them if batch verification fails
+        uint256 txHash;
+        uint256 blockHash;
     };
 
     struct LelantusSigmaProofData {
         LelantusSigmaProofData(const lelantus::SigmaExtendedProof& lelantusSigmaProof_,
                                const Scalar& serialNumber_,
                                const Scalar& challenge_,
-                               size_t anonymitySetSize_)
+                               size_t anonymitySetSize_,
+                               const uint256& txHash_,
+                               const uint256& blockHash_)
                                : lelantusSigmaProof(lelantusSigmaProof_),
                                serialNumber(serialNumber_),
                                challenge(challenge_),
-                               anonymitySetSize(anonymitySetSize_) {}
+                               anonymitySetSize(anonymitySetSize_),
+                               txHash(txHash_),
+                               blockHash(blockHash_) {}
 
         lelantus::SigmaExtendedProof lelantusSigmaProof;
         Scalar serialNumber;
         Scalar challenge;
         size_t anonymitySetSize;
+        // transaction and block the proof came from, to find them if batch verification fails
+        uint256 txHash;
+        uint256 blockHash;
+    };
+
+    struct RangeProofData {
+        RangeProofData(const lelantus::RangeProof& rangeProof_,
+                       const std::vector<lelantus::PublicCoin>& Cout_,
+                       const std::vector<Scalar>& serials_,
+                       const uint256& txHash_,
+                       const uint256& blockHash_)
+                       : rangeProof(rangeProof_),
+                       Cout(Cout_),
+                       serials(serials_),
+                       txHash(txHash_),
+                       blockHash(blockHash_) {}
+
+        lelantus::RangeProof rangeProof;
+        std::vector<lelantus::PublicCoin> Cout;
+        // serials of the joinsplit, the proof is forgotten with its spends
+        std::vector<Scalar> serials;
+        // transaction and block the proof came from, to find them if batch verification fails
+        uint256 txHash;
+        uint256 blockHash;
+    };
+
+    // A chunk of a group's proofs verified as one batch, failed batches are bisected down to the proofs in failed.
+    struct BatchJob {
+        size_t group = 0;
+        size_t begin = 0;
+        size_t end = 0;
+        bool fValid = true;
+        std::vector<size_t> failed;
+        int64_t nTime = 0; // microseconds
     };
 
-    void init();
+    ~BatchProofContainer();
+
+    // Batches are verified on nThreads workers, or on the calling thread if never started.
+    void startWorkers(int nThreads);
+    void stopWorkers();
+
+    // blockHash is the block being connected, proofs added until the next finalize() belong to it
+    void init(const uint256& blockHash);
 
     void finalize();
 
@@ -53,12 +114,16 @@ public:
              bool fPadding,
              int group_id,
              size_t setSize,
-             bool fStartSigmaBlacklist);
+             bool fStartSigmaBlacklist,
+             const uint256& txHash);
 
+    // Cout are the output coins of the joinsplit, its range proof is batched along with the sigma proofs
     void add(lelantus::JoinSplit* joinSplit,
              const std::map<uint32_t, size_t>& setSizes,
              const Scalar& challenge,
-             bool fStartLelantusBlacklist);
+             const std::vector<lelantus::PublicCoin>& Cout,
+             bool fStartLelantusBlacklist,
+             const uint256& txHash);
 
     void removeSigma(const sigma::spend_info_container& spendSerials);
     void removeLelantus(std::unordered_map<Scalar, int> spentSerials);
@@ -67,20 +132,52 @@ public:
     void batch_sigma();
     void batch_lelantus();
 
+    // Verifies the proofs collected for the block being connected right away, one batch per group and
+    // one for the range proofs of each joinsplit version, instead of keeping them for later. Returns false if any of them is invalid, failed batches are
+    // bisected and the transactions containing the invalid proofs are added to failedTxs.
+    bool verify_block(std::set<uint256>& failedTxs);
+
+    // Returns and forgets the blocks containing proofs which failed verification. When a batch fails
+    // it is bisected down to the offending proofs, the caller is expected to invalidate their blocks.
+    std::set<uint256> takeFailedBlocks();
+    // Adds blocks found to contain invalid proofs earlier, to be taken by the caller like the others.
+    void addFailedBlocks(const std::set<uint256>& blocks);
+
 public:
     bool fCollectProofs = 0;
 
+private:
+    typedef std::map<std::pair<sigma::CoinDenomination, std::pair<int, bool>>, std::vector<SigmaProofData>> SigmaProofs;
+    typedef std::map<std::pair<std::pair<uint32_t, bool>, bool>, std::vector<LelantusSigmaProofData>> LelantusSigmaProofs;
+    // map joinsplit version to range proofs
+    typedef std::map<unsigned int, std::vector<RangeProofData>> RangeProofs;
+
+    // Batch verify the proofs group by group, bisecting failed batches down to the invalid proofs,
+    // which are added to failed. Return false if any batch failed. With fUpToLastBlock the sets are
+    // taken up to the last block of each group, as the spends of the block being connected may use it.
+    bool verify_sigma(const SigmaProofs& proofs, bool fUpToLastBlock, std::vector<const SigmaProofData*>& failed);
+    bool verify_lelantus(const LelantusSigmaProofs& proofs, bool fUpToLastBlock, std::vector<const LelantusSigmaProofData*>& failed);
+    // Same for range proofs, one batch per joinsplit version as it is part of the proof transcript.
+    bool verify_range(const RangeProofs& proofs, std::vector<const RangeProofData*>& failed);
+
 private:
     static std::unique_ptr<BatchProofContainer> instance;
+    uint256 currentBlockHash;
+    std::set<uint256> failedBlocks;
+    std::unique_ptr<ctpl::thread_pool> workerPool;
+    // proofs can be added concurrently from privacy proof check threads
+    CCriticalSection cs_tempProofs;
     // temp containers, to forget in case block connection fails
     // map (denom, id) to (sigma proof, serial, set size)
-    std::map<std::pair<sigma::CoinDenomination, std::pair<int, bool>>, std::vector<SigmaProofData>> tempSigmaProofs;
+    SigmaProofs tempSigmaProofs;
     // map ((id, afterFixes), fIsSigmaToLelantus) to (sigma proof, serial, set size, challenge)
-    std::map<std::pair<std::pair<uint32_t, bool>, bool>, std::vector<LelantusSigmaProofData>> tempLelantusSigmaProofs;
+    LelantusSigmaProofs tempLelantusSigmaProofs;
+    RangeProofs tempRangeProofs;
 
     // containers to keep proofs for batching
-    std::map<std::pair<sigma::CoinDenomination, std::pair<int, bool>>, std::vector<SigmaProofData>> sigmaProofs;
-    std::map<std::pair<std::pair<uint32_t, bool>, bool>, std::vector<LelantusSigmaProofData>> lelantusSigmaProofs;
+    SigmaProofs sigmaProofs;
+    LelantusSigmaProofs lelantusSigmaProofs;
+    RangeProofs rangeProofs;
 };
 
 #endif //FIRO_BATCHPROOF_CONTAINER_H
@@ -4,6 +4,7 @@
 
 #include "bench.h"
 
+#include "chainparams.h"
 #include "key.h"
 #include "stacktraces.h"
 #include "validation.h"
@@ -19,6 +20,7 @@ main(int argc, char** argv)
     ECC_Start();
     SetupEnvironment();
     fPrintToDebugLog = false; // don't want to write to debug.log file
+    SelectParams(CBaseChainParams::MAIN); // lelantus and sigma parameters depend on the chain
 
     benchmark::BenchRunner::RunAll();
 
@@ -0,0 +1,235 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "liblelantus/challenge_generator_impl.h"
+#include "liblelantus/innerproduct_proof_generator.h"
+#include "liblelantus/innerproduct_proof_verifier.h"
+#include "liblelantus/joinsplit.h"
+#include "liblelantus/params.h"
+#include "liblelantus/range_prover.h"
+#include "liblelantus/range_verifier.h"
+#include "liblelantus/sigmaextended_prover.h"
+#include "liblelantus/sigmaextended_verifier.h"
+#include "amount.h"
+#include "arith_uint256.h"
+#include "firo_params.h"
+
+#include <cassert>
+#include <map>
+#include <vector>
+
+using namespace lelantus;
+
+// Random anonymity set of setSize coins, the spent coins are put into it by the callers
+static std::vector<GroupElement> GenerateAnonymitySet(size_t setSize)
+{
+    std::vector<GroupElement> commits(setSize);
+    for (auto &c : commits)
+        c.randomize();
+    return commits;
+}
+
+// Proofs of membership of proofCount coins of a setSize coins anonymity set, one per transaction
+// (own challenge) as they are batched by BatchProofContainer
+static void SigmaExtendedBatchVerify(benchmark::State& state, size_t setSize, size_t proofCount)
+{
+    const Params* params = Params::get_default();
+    const GroupElement& g = params->get_g();
+    const std::vector<GroupElement>& h = params->get_sigma_h();
+    int n = params->get_sigma_n();
+    int m = params->get_sigma_m();
+
+    std::vector<GroupElement> commits = GenerateAnonymitySet(setSize);
+    std::vector<Scalar> challenges, serials;
+    std::vector<size_t> setSizes(proofCount, setSize);
+    std::vector<SigmaExtendedProof> proofs;
+
+    // all the spent coins are put into the set before any proof is made over it
+    std::vector<size_t> indexes;
+    std::vector<Scalar> values, randoms;
+    for (size_t i = 0; i < proofCount; ++i) {
+        Scalar s, v, r;
+        s.randomize();
+        v.randomize();
+        r.randomize();
+        indexes.push_back((i * 7919) % setSize);
+        commits[indexes.back()] = LelantusPrimitives::double_commit(g, s, h[1], v, h[0], r);
+        serials.push_back(s);
+        values.push_back(v);
+        randoms.push_back(r);
+    }
+
+    SigmaExtendedProver prover(g, h, n, m);
+    for (size_t i = 0; i < proofCount; ++i) {
+        // the proof is done over the set shifted by the serial, as in LelantusProver
+        std::vector<GroupElement> shifted(commits);
+        GroupElement gs = g * serials[i].negate();
+        for (auto &c : shifted)
+            c += gs;
+
+        Scalar rA, rB, rC, rD, x;
+        rA.randomize();
+        rB.randomize();
+        rC.randomize();
+        rD.randomize();
+        x.randomize();
+        std::vector<Scalar> sigma, a(n * m), Tk(m), Pk(m), Yk(m);
+
+        SigmaExtendedProof proof;
+        prover.sigma_commit(shifted, indexes[i], rA, rB, rC, rD, a, Tk, Pk, Yk, sigma, proof);
+        prover.sigma_response(sigma, a, rA, rB, rC, rD, values[i], randoms[i], Tk, Pk, x, proof);
+
+        proofs.push_back(proof);
+        challenges.push_back(x);
+    }
+
+    SigmaExtendedVerifier verifier(g, h, n, m, &params->get_sigma_h_multiexp());
+    assert(verifier.batchverify(commits, challenges, serials, setSizes, proofs));
+
+    while (state.KeepRunning()) {
+        verifier.batchverify(commits, challenges, serials, setSizes, proofs);
+    }
+}
+
+static void SigmaExtendedBatchVerify_1k_1(benchmark::State& state) { SigmaExtendedBatchVerify(state, 1024, 1); }
+static void SigmaExtendedBatchVerify_1k_10(benchmark::State& state) { SigmaExtendedBatchVerify(state, 1024, 10); }
+static void SigmaExtendedBatchVerify_16k_1(benchmark::State& state) { SigmaExtendedBatchVerify(state, 16384, 1); }
+static void SigmaExtendedBatchVerify_16k_10(benchmark::State& state) { SigmaExtendedBatchVerify(state, 16384, 10); }
+static void SigmaExtendedBatchVerify_65k_1(benchmark::State& state) { SigmaExtendedBatchVerify(state, 65536, 1); }
+static void SigmaExtendedBatchVerify_65k_10(benchmark::State& state) { SigmaExtendedBatchVerify(state, 65536, 10); }
+
+// Bulletproofs of the given number of new coins, built the way LelantusProver::generate_bulletproofs does
+static void RangeVerify(benchmark::State& state, size_t outputs)
+{
+    const Params* params = Params::get_default();
+    std::size_t n = params->get_bulletproofs_n();
+    std::size_t m = outputs * 2;
+    while (m & (m - 1))
+        m++;
+
+    std::vector<PrivateCoin> coins;
+    for (size_t i = 0; i < outputs; ++i)
+        coins.emplace_back(params, (i + 1) * COIN);
+
+    std::vector<Scalar> v_s, serials, randoms;
+    std::vector<GroupElement> V, commitments;
+    for (auto const &coin : coins) {
+        v_s.push_back(coin.getV());
+        v_s.push_back(coin.getVScalar() + params->get_limit_range());
+        serials.insert(serials.end(), 2, coin.getSerialNumber());
+        randoms.insert(randoms.end(), 2, coin.getRandomness());
+        V.push_back(coin.getPublicCoin().getValue());
+        V.push_back(coin.getPublicCoin().getValue() + params->get_h1_limit_range());
+        commitments.push_back(coin.getPublicCoin().getValue());
+    }
+    v_s.resize(m);
+    serials.resize(m);
+    randoms.resize(m);
+    V.resize(m);
+
+    std::vector<GroupElement> g_(params->get_bulletproofs_g().begin(), params->get_bulletproofs_g().begin() + n * m);
+    std::vector<GroupElement> h_(params->get_bulletproofs_h().begin(), params->get_bulletproofs_h().begin() + n * m);
+
+    RangeProof proof;
+    RangeProver(params->get_h1(), params->get_h0(), params->get_g(), g_, h_, n, LELANTUS_TX_VERSION_4_5)
+        .batch_proof(v_s, serials, randoms, commitments, proof);
+
+    RangeVerifier verifier(params->get_h1(), params->get_h0(), params->get_g(), g_, h_, n, LELANTUS_TX_VERSION_4_5, &params->get_bulletproofs_multiexp());
+    assert(verifier.verify_batch(V, commitments, proof));
+
+    while (state.KeepRunning()) {
+        verifier.verify_batch(V, commitments, proof);
+    }
+}
+
+static void RangeVerify_1Output(benchmark::State& state) { RangeVerify(state, 1); }
+static void RangeVerify_4Outputs(benchmark::State& state) { RangeVerify(state, 4); }
+static void RangeVerify_8Outputs(benchmark::State& state) { RangeVerify(state, 8); }
+
+// Inner product argument over the first n bulletproofs generators, n being the size used
+// by range proofs of n / 128 outputs
+static void InnerProductVerify(benchmark::State& state, size_t n)
+{
+    const Params* params = Params::get_default();
+    std::vector<GroupElement> g(params->get_bulletproofs_g().begin(), params->get_bulletproofs_g().begin() + n);
+    std::vector<GroupElement> h(params->get_bulletproofs_h().begin(), params->get_bulletproofs_h().begin() + n);
+    GroupElement u;
+    u.randomize();
+
+    std::vector<Scalar> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i].randomize();
+        b[i].randomize();
+    }
+    Scalar x;
+    x.randomize();
+
+    InnerProductProof proof;
+    std::unique_ptr<ChallengeGenerator> challengeGenerator = std::make_unique<ChallengeGeneratorImpl<CHash256>>(1);
+    InnerProductProofGenerator generator(g, h, u, 2);
+    generator.generate_proof(a, b, x, challengeGenerator, proof);
+
+    GroupElement P = generator.get_P();
+
+    while (state.KeepRunning()) {
+        // the verifier folds the challenges into its generators, so it can't be reused
+        InnerProductProofVerifier verifier(g, h, u, P, 2, &params->get_bulletproofs_multiexp());
+        challengeGenerator.reset(new ChallengeGeneratorImpl<CHash256>(1));
+        verifier.verify_fast(n, x, proof, challengeGenerator);
+    }
+}
+
+static void InnerProductVerify_128(benchmark::State& state) { InnerProductVerify(state, 128); }
+static void InnerProductVerify_1024(benchmark::State& state) { InnerProductVerify(state, 1024); }
+
+// Whole JoinSplit spending one coin of a setSize coins group to one new coin and a transparent output
+static void JoinSplitVerify(benchmark::State& state, size_t setSize)
+{
+    const Params* params = Params::get_default();
+
+    PrivateCoin input(params, 10 * COIN);
+    PrivateCoin output(params, 5 * COIN);
+
+    std::map<uint32_t, std::vector<PublicCoin>> anonymitySets;
+    for (auto const &c : GenerateAnonymitySet(setSize))
+        anonymitySets[1].emplace_back(c);
+    anonymitySets[1][setSize / 2] = input.getPublicCoin();
+
+    std::vector<std::vector<unsigned char>> anonymitySetHashes = {std::vector<unsigned char>(32, 1)};
+    std::map<uint32_t, uint256> groupBlockHashes = {{1, ArithToUint256(1)}};
+    uint256 txHash = ArithToUint256(2);
+
+    CAmount fee = CENT;
+    uint64_t vout = 5 * COIN - fee;
+    JoinSplit joinSplit(params, {{input, 1}}, anonymitySets, anonymitySetHashes, vout, {output}, fee,
+                        groupBlockHashes, txHash, LELANTUS_TX_VERSION_4_5);
+
+    std::vector<PublicCoin> Cout = {output.getPublicCoin()};
+    assert(joinSplit.Verify(anonymitySets, anonymitySetHashes, Cout, vout, txHash));
+
+    while (state.KeepRunning()) {
+        joinSplit.Verify(anonymitySets, anonymitySetHashes, Cout, vout, txHash);
+    }
+}
+
+static void JoinSplitVerify_1k(benchmark::State& state) { JoinSplitVerify(state, 1024); }
+static void JoinSplitVerify_16k(benchmark::State& state) { JoinSplitVerify(state, 16384); }
+static void JoinSplitVerify_65k(benchmark::State& state) { JoinSplitVerify(state, 65536); }
+
+BENCHMARK(SigmaExtendedBatchVerify_1k_1);
+BENCHMARK(SigmaExtendedBatchVerify_1k_10);
+BENCHMARK(SigmaExtendedBatchVerify_16k_1);
+BENCHMARK(SigmaExtendedBatchVerify_16k_10);
+BENCHMARK(SigmaExtendedBatchVerify_65k_1);
+BENCHMARK(SigmaExtendedBatchVerify_65k_10);
+BENCHMARK(RangeVerify_1Output);
+BENCHMARK(RangeVerify_4Outputs);
+BENCHMARK(RangeVerify_8Outputs);
+BENCHMARK(InnerProductVerify_128);
+BENCHMARK(InnerProductVerify_1024);
+BENCHMARK(JoinSplitVerify_1k);
+BENCHMARK(JoinSplitVerify_16k);
+BENCHMARK(JoinSplitVerify_65k);
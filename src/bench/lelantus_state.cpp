@@ -0,0 +1,67 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "chain.h"
+#include "lelantus.h"
+#include "random.h"
+
+#include <memory>
+#include <vector>
+
+// Synthetic chain of blocks holding only lelantus mints, all in the first coin group
+static std::vector<std::unique_ptr<CBlockIndex>> GenerateMintChain(size_t blocks, size_t mintsPerBlock)
+{
+    std::vector<std::unique_ptr<CBlockIndex>> chain;
+    chain.reserve(blocks);
+    for (size_t i = 0; i < blocks; ++i) {
+        std::unique_ptr<CBlockIndex> index(new CBlockIndex());
+        index->nHeight = i;
+        index->pprev = chain.empty() ? nullptr : chain.back().get();
+        index->phashBlock = new uint256(GetRandHash());
+
+        auto &mints = index->lelantusMintedPubCoins[1];
+        for (size_t j = 0; j < mintsPerBlock; ++j) {
+            GroupElement coin;
+            coin.randomize();
+            mints.emplace_back(lelantus::PublicCoin(coin), GetRandHash());
+        }
+        chain.push_back(std::move(index));
+    }
+    return chain;
+}
+
+// Disconnects and reconnects the last reorgDepth blocks of a chain holding blocks * mintsPerBlock coins
+static void LelantusStateReorg(benchmark::State& state, size_t blocks, size_t mintsPerBlock, size_t reorgDepth)
+{
+    auto chain = GenerateMintChain(blocks, mintsPerBlock);
+
+    lelantus::CLelantusState lelantusState;
+    for (auto const &index : chain)
+        lelantusState.AddBlock(index.get());
+
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < reorgDepth; ++i)
+            lelantusState.RemoveBlock(chain[blocks - 1 - i].get());
+        for (size_t i = blocks - reorgDepth; i < blocks; ++i)
+            lelantusState.AddBlock(chain[i].get());
+    }
+
+    for (auto const &index : chain)
+        delete index->phashBlock;
+}
+
+static void LelantusStateReorg_10Blocks_20kMints(benchmark::State& state)
+{
+    LelantusStateReorg(state, 200, 100, 10);
+}
+
+static void LelantusStateReorg_10Blocks_60kMints(benchmark::State& state)
+{
+    LelantusStateReorg(state, 600, 100, 10);
+}
+
+BENCHMARK(LelantusStateReorg_10Blocks_20kMints);
+BENCHMARK(LelantusStateReorg_10Blocks_60kMints);
@@ -0,0 +1,38 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "crypto/MerkleTreeProof/mtp.h"
+#include "primitives/block.h"
+#include "random.h"
+#include "uint256.h"
+
+#include <cassert>
+#include <limits>
+#include <memory>
+
+// Verification of the MTP proof of a block header, as done for every MTP block on sync.
+// Solving the block in the setup needs the whole 4GB MTP memory once.
+static void MTPVerify(benchmark::State& state)
+{
+    CBlock block;
+    block.nVersion = CBlock::CURRENT_VERSION;
+    block.hashPrevBlock = GetRandHash();
+    block.hashMerkleRoot = GetRandHash();
+    block.nTime = GetRandInt(std::numeric_limits<decltype(block.nTime)>::max());
+    block.nBits = 0x2000ffffUL;
+    block.mtpHashData = std::make_shared<CMTPHashData>();
+    block.nVersionMTP = 1;
+
+    uint256 powLimit = uint256S("00ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    mtp::hash(block, powLimit);
+    assert(mtp::verify(block.nNonce, block, powLimit));
+
+    while (state.KeepRunning()) {
+        mtp::verify(block.nNonce, block, powLimit);
+    }
+}
+
+BENCHMARK(MTPVerify);
@@ -0,0 +1,88 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "secp256k1/include/MultiExponent.h"
+#include "secp256k1/include/FixedBaseMultiExponent.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace secp_primitives;
+
+static void RandomizeMultiExponent(size_t n, std::vector<GroupElement>& gens, std::vector<Scalar>& scalars)
+{
+    gens.resize(n);
+    scalars.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        gens[i].randomize();
+        scalars[i].randomize();
+    }
+}
+
+// Generic path, generators are normalized and tables are built on every call
+static void MultiExponentBench(benchmark::State& state, size_t n)
+{
+    std::vector<GroupElement> gens;
+    std::vector<Scalar> scalars;
+    RandomizeMultiExponent(n, gens, scalars);
+
+    while (state.KeepRunning()) {
+        MultiExponent(gens, scalars).get_multiple();
+    }
+}
+
+// Generators precomputed once, as done for lelantus::Params and sigma::Params
+static void FixedBaseMultiExponentBench(benchmark::State& state, size_t n)
+{
+    std::vector<GroupElement> gens;
+    std::vector<Scalar> scalars;
+    RandomizeMultiExponent(n, gens, scalars);
+    FixedBaseMultiExponent multiExp(gens);
+
+    while (state.KeepRunning()) {
+        multiExp.get_multiple(scalars);
+    }
+}
+
+// Size of the Sigma generators (n * m = 16 * 4), used by the abcd checks
+static void MultiExponent64(benchmark::State& state) { MultiExponentBench(state, 64); }
+static void FixedBaseMultiExponent64(benchmark::State& state) { FixedBaseMultiExponentBench(state, 64); }
+
+// Size of the Bulletproofs generators for 4 outputs (2 * 64 * 4 * 2)
+static void MultiExponent1024(benchmark::State& state) { MultiExponentBench(state, 1024); }
+static void FixedBaseMultiExponent1024(benchmark::State& state) { FixedBaseMultiExponentBench(state, 1024); }
+
+// All the Bulletproofs generators (2 * 64 * 16)
+static void MultiExponent2048(benchmark::State& state) { MultiExponentBench(state, 2048); }
+static void FixedBaseMultiExponent2048(benchmark::State& state) { FixedBaseMultiExponentBench(state, 2048); }
+
+// Multi-threaded generic path, for the batch verification over full anonymity sets
+static void ParallelMultiExponentBench(benchmark::State& state, size_t n)
+{
+    std::vector<GroupElement> gens;
+    std::vector<Scalar> scalars;
+    RandomizeMultiExponent(n, gens, scalars);
+
+    MultiExponent::set_parallelism(std::max(std::thread::hardware_concurrency(), 1u));
+    while (state.KeepRunning()) {
+        MultiExponent(gens, scalars).get_multiple();
+    }
+    MultiExponent::set_parallelism(1);
+}
+
+// Lelantus anonymity set size (65536), single and multi-threaded
+static void MultiExponent65536(benchmark::State& state) { MultiExponentBench(state, 65536); }
+static void ParallelMultiExponent65536(benchmark::State& state) { ParallelMultiExponentBench(state, 65536); }
+
+BENCHMARK(MultiExponent64);
+BENCHMARK(FixedBaseMultiExponent64);
+BENCHMARK(MultiExponent1024);
+BENCHMARK(FixedBaseMultiExponent1024);
+BENCHMARK(MultiExponent2048);
+BENCHMARK(FixedBaseMultiExponent2048);
+BENCHMARK(MultiExponent65536);
+BENCHMARK(ParallelMultiExponent65536);
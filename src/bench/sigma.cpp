@@ -0,0 +1,76 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "sigma/params.h"
+#include "sigma/sigmaplus_prover.h"
+#include "sigma/sigmaplus_verifier.h"
+
+#include <cassert>
+#include <vector>
+
+using namespace secp_primitives;
+
+// Spend proofs of proofCount coins of a setSize coins anonymity set, batched as done
+// by BatchProofContainer. Sigma sets are at most n^m = 16384 coins.
+static void SigmaPlusBatchVerify(benchmark::State& state, size_t setSize, size_t proofCount)
+{
+    sigma::Params* params = sigma::Params::get_default();
+    const GroupElement& g = params->get_g();
+    const std::vector<GroupElement>& h = params->get_h();
+    int n = params->get_n();
+    int m = params->get_m();
+
+    std::vector<GroupElement> commits(setSize);
+    for (auto &c : commits)
+        c.randomize();
+
+    std::vector<Scalar> serials;
+    std::vector<bool> fPadding(proofCount, true);
+    std::vector<size_t> setSizes(proofCount, setSize);
+    std::vector<sigma::SigmaPlusProof<Scalar, GroupElement>> proofs;
+
+    // all the spent coins are put into the set before any proof is made over it
+    std::vector<size_t> indexes;
+    std::vector<Scalar> randoms;
+    for (size_t i = 0; i < proofCount; ++i) {
+        Scalar s, r;
+        s.randomize();
+        r.randomize();
+        indexes.push_back((i * 7919) % setSize);
+        commits[indexes.back()] = sigma::SigmaPrimitives<Scalar, GroupElement>::commit(g, s, h[0], r);
+        serials.push_back(s);
+        randoms.push_back(r);
+    }
+
+    sigma::SigmaPlusProver<Scalar, GroupElement> prover(g, h, n, m);
+    for (size_t i = 0; i < proofCount; ++i) {
+        // the proof is done over the set shifted by the serial, as in CoinSpend
+        std::vector<GroupElement> shifted(commits);
+        GroupElement gs = (g * serials[i]).inverse();
+        for (auto &c : shifted)
+            c += gs;
+
+        proofs.emplace_back(n, m);
+        prover.proof(shifted, indexes[i], randoms[i], true, proofs.back());
+    }
+
+    sigma::SigmaPlusVerifier<Scalar, GroupElement> verifier(g, h, n, m, &params->get_h_multiexp());
+    assert(verifier.batch_verify(commits, serials, fPadding, setSizes, proofs));
+
+    while (state.KeepRunning()) {
+        verifier.batch_verify(commits, serials, fPadding, setSizes, proofs);
+    }
+}
+
+static void SigmaPlusBatchVerify_1k_1(benchmark::State& state) { SigmaPlusBatchVerify(state, 1024, 1); }
+static void SigmaPlusBatchVerify_1k_10(benchmark::State& state) { SigmaPlusBatchVerify(state, 1024, 10); }
+static void SigmaPlusBatchVerify_16k_1(benchmark::State& state) { SigmaPlusBatchVerify(state, 16384, 1); }
+static void SigmaPlusBatchVerify_16k_10(benchmark::State& state) { SigmaPlusBatchVerify(state, 16384, 10); }
+
+BENCHMARK(SigmaPlusBatchVerify_1k_1);
+BENCHMARK(SigmaPlusBatchVerify_1k_10);
+BENCHMARK(SigmaPlusBatchVerify_16k_1);
+BENCHMARK(SigmaPlusBatchVerify_16k_10);
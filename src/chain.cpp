@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "chain.h"
+#include "memusage.h"
 
 /**
  * CChain implementation
@@ -117,6 +118,31 @@ void CBlockIndex::BuildSkip()
         pskip = pprev->GetAncestor(GetSkipHeight(nHeight));
 }
 
+size_t CBlockIndex::PrivacyIndexDynamicUsage() const
+{
+    size_t usage = memusage::DynamicUsage(mintedPubCoins) +
+            memusage::DynamicUsage(accumulatorChanges) +
+            memusage::DynamicUsage(spentSerials) +
+            memusage::DynamicUsage(sigmaMintedPubCoins) +
+            memusage::DynamicUsage(lelantusMintedPubCoins) +
+            memusage::DynamicUsage(anonymitySetHash) +
+            memusage::DynamicUsage(sigmaSpentSerials) +
+            memusage::DynamicUsage(lelantusSpentSerials) +
+            memusage::DynamicUsage(activeDisablingSporks);
+
+    // coin vectors stored in the maps
+    for (const auto& coins : mintedPubCoins)
+        usage += memusage::DynamicUsage(coins.second);
+    for (const auto& coins : sigmaMintedPubCoins)
+        usage += memusage::DynamicUsage(coins.second);
+    for (const auto& coins : lelantusMintedPubCoins)
+        usage += memusage::DynamicUsage(coins.second);
+    for (const auto& hash : anonymitySetHash)
+        usage += memusage::DynamicUsage(hash.second);
+
+    return usage;
+}
+
 arith_uint256 GetBlockProof(const CBlockIndex& block)
 {
     arith_uint256 bnTarget;
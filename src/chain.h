@@ -21,6 +21,7 @@
 #include "chainparams.h"
 #include "coin_containers.h"
 #include "streams.h"
+#include "lazycontainer.h"
 
 #include <vector>
 #include <unordered_set>
@@ -224,34 +225,37 @@ public:
     //! (memory only) Maximum nTime in the chain upto and including this block.
     unsigned int nTimeMax;
 
+    // Privacy index entries below are empty for the vast majority of blocks and are
+    // kept in memory for every block index, so they're only allocated once used.
+
     //! Public coin values of mints in this block, ordered by serialized value of public coin
     //! Maps <denomination,id> to vector of public coins
-    std::map<std::pair<int,int>, std::vector<CBigNum>> mintedPubCoins;
+    lazycontainer<std::map<std::pair<int,int>, std::vector<CBigNum>>> mintedPubCoins;
 
     //! Accumulator updates. Contains only changes made by mints in this block
     //! Maps <denomination, id> to <accumulator value (CBigNum), number of such mints in this block>
-    std::map<std::pair<int,int>, std::pair<CBigNum,int>> accumulatorChanges;
+    lazycontainer<std::map<std::pair<int,int>, std::pair<CBigNum,int>>> accumulatorChanges;
 
     //! Values of coin serials spent in this block
-	std::set<CBigNum> spentSerials;
+    lazycontainer<std::set<CBigNum>> spentSerials;
 
 /////////////////////// Sigma index entries. ////////////////////////////////////////////
 
     //! Public coin values of mints in this block, ordered by serialized value of public coin
     //! Maps <denomination,id> to vector of public coins
-    std::map<std::pair<sigma::CoinDenomination, int>, std::vector<sigma::PublicCoin>> sigmaMintedPubCoins;
+    lazycontainer<std::map<std::pair<sigma::CoinDenomination, int>, std::vector<sigma::PublicCoin>>> sigmaMintedPubCoins;
     //! Map id to <public coin, tag>
-    std::map<int, std::vector<std::pair<lelantus::PublicCoin, uint256>>>  lelantusMintedPubCoins;
+    lazycontainer<std::map<int, std::vector<std::pair<lelantus::PublicCoin, uint256>>>> lelantusMintedPubCoins;
     //! Map id to <hash of the set>
-    std::map<int, std::vector<unsigned char>> anonymitySetHash;
+    lazycontainer<std::map<int, std::vector<unsigned char>>> anonymitySetHash;
 
     //! Values of coin serials spent in this block
-    sigma::spend_info_container sigmaSpentSerials;
-    std::unordered_map<Scalar, int> lelantusSpentSerials;
+    lazycontainer<sigma::spend_info_container> sigmaSpentSerials;
+    lazycontainer<std::unordered_map<Scalar, int>> lelantusSpentSerials;
 
     //! list of disabling sporks active at this block height
     //! std::map {feature name} -> {block number when feature is re-enabled again, parameter}
-    ActiveSporkMap activeDisablingSporks;
+    lazycontainer<ActiveSporkMap> activeDisablingSporks;
 
     void SetNull()
     {
@@ -421,6 +425,9 @@ public:
     //! Efficiently find an ancestor of this block.
     CBlockIndex* GetAncestor(int height);
     const CBlockIndex* GetAncestor(int height) const;
+
+    //! Heap memory held by the privacy index entries (mints, spends, set hashes, sporks)
+    size_t PrivacyIndexDynamicUsage() const;
 };
 
 arith_uint256 GetBlockProof(const CBlockIndex& block);
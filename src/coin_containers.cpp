@@ -55,10 +55,11 @@ std::size_t CPublicCoinHash::operator ()(const lelantus::PublicCoin& coin) const
     return result;
 }
 
-CMintedCoinInfo CMintedCoinInfo::make(int coinGroupId, int nHeight) {
+CMintedCoinInfo CMintedCoinInfo::make(int coinGroupId, int nHeight, const uint256& tag) {
     CMintedCoinInfo coinInfo;
     coinInfo.coinGroupId = coinGroupId;
     coinInfo.nHeight = nHeight;
+    coinInfo.tag = tag;
     return coinInfo;
 }
 
@@ -4,6 +4,7 @@
 #include <secp256k1/include/Scalar.h>
 #include "sigma/coin.h"
 #include "liblelantus/coin.h"
+#include "uint256.h"
 
 #include <unordered_map>
 
@@ -67,8 +68,10 @@ struct CPublicCoinHash {
 struct CMintedCoinInfo {
     int coinGroupId;
     int nHeight;
+    // tag the coin was minted with, to find its entry in the tag index on removal
+    uint256 tag;
 
-    static CMintedCoinInfo make(int coinGroupId, int nHeight);
+    static CMintedCoinInfo make(int coinGroupId, int nHeight, const uint256& tag = uint256());
 };
 
 using mint_info_container = std::unordered_map<lelantus::PublicCoin, CMintedCoinInfo, lelantus::CPublicCoinHash>;
@@ -110,7 +110,10 @@ CSporkManager *CSporkManager::sharedSporkManager = new CSporkManager();
 
 bool CSporkManager::BlockConnected(const CBlock &block, CBlockIndex *pindex)
 {
-    return UpdateActiveSporkMap(pindex->activeDisablingSporks, pindex->pprev->activeDisablingSporks, pindex->nHeight, block.vtx);
+    ActiveSporkMap sporkMap = pindex->activeDisablingSporks;
+    bool result = UpdateActiveSporkMap(sporkMap, pindex->pprev->activeDisablingSporks, pindex->nHeight, block.vtx);
+    pindex->activeDisablingSporks = sporkMap;
+    return result;
 }
 
 bool CSporkManager::UpdateActiveSporkMap(ActiveSporkMap &sporkMap, const ActiveSporkMap &previousSporkMap, int nHeight, const std::vector<CTransactionRef> &sporkTransactions)
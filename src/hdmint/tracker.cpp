@@ -29,7 +29,11 @@ CHDMintTracker::CHDMintTracker(std::string strWalletFile)
     this->strWalletFile = strWalletFile;
     mapSerialHashes.clear();
     mapLelantusSerialHashes.clear();
+    mapPubcoinHashes.clear();
+    mapLelantusPubcoinHashes.clear();
+    mapLelantusReducedHashes.clear();
     mapPendingSpends.clear();
+    nUpdateCounter = 0;
     fInitialized = false;
 }
 
@@ -44,6 +48,9 @@ CHDMintTracker::~CHDMintTracker()
 {
     mapSerialHashes.clear();
     mapLelantusSerialHashes.clear();
+    mapPubcoinHashes.clear();
+    mapLelantusPubcoinHashes.clear();
+    mapLelantusReducedHashes.clear();
     mapPendingSpends.clear();
 }
 
@@ -75,8 +82,10 @@ bool CHDMintTracker::Archive(CMintMeta& meta)
 {
     uint256 hashPubcoin = meta.GetPubCoinValueHash();
 
-    if (HasSerialHash(meta.hashSerial))
+    if (HasSerialHash(meta.hashSerial)) {
         mapSerialHashes.at(meta.hashSerial).isArchived = true;
+        UpdatePubcoinIndex(mapSerialHashes.at(meta.hashSerial));
+    }
 
    CWalletDB walletdb(strWalletFile);
     CHDMint dMint;
@@ -93,8 +102,10 @@ bool CHDMintTracker::Archive(CLelantusMintMeta& meta)
 {
     uint256 hashPubcoin = meta.GetPubCoinValueHash();
 
-    if (HasLelantusSerialHash(meta.hashSerial))
+    if (HasLelantusSerialHash(meta.hashSerial)) {
         mapLelantusSerialHashes.at(meta.hashSerial).isArchived = true;
+        UpdatePubcoinIndex(mapLelantusSerialHashes.at(meta.hashSerial));
+    }
 
     CWalletDB walletdb(strWalletFile);
     CHDMint dMint;
@@ -168,26 +179,20 @@ bool CHDMintTracker::GetMetaFromSerial(const uint256 &hashSerial, CLelantusMintM
  */
 bool CHDMintTracker::GetMetaFromPubcoin(const uint256& hashPubcoin, CMintMeta& mMeta)
 {
-    for (auto it : mapSerialHashes) {
-        if (it.second.GetPubCoinValueHash() == hashPubcoin){
-            mMeta = it.second;
-            return true;
-        }
-    }
+    auto it = mapPubcoinHashes.find(hashPubcoin);
+    if (it == mapPubcoinHashes.end())
+        return false;
 
-    return false;
+    return GetMetaFromSerial(it->second, mMeta);
 }
 
 bool CHDMintTracker::GetLelantusMetaFromPubcoin(const uint256& hashPubcoin, CLelantusMintMeta& mMeta)
 {
-    for (auto it : mapLelantusSerialHashes) {
-        if (it.second.GetPubCoinValueHash() == hashPubcoin){
-            mMeta = it.second;
-            return true;
-        }
-    }
+    auto it = mapLelantusPubcoinHashes.find(hashPubcoin);
+    if (it == mapLelantusPubcoinHashes.end())
+        return false;
 
-    return false;
+    return GetMetaFromSerial(it->second, mMeta);
 }
 
 /**
@@ -217,21 +222,8 @@ std::vector<uint256> CHDMintTracker::GetSerialHashes()
  */
 bool CHDMintTracker::HasPubcoinHash(const uint256& hashPubcoin, CWalletDB& walletdb) const
 {
-    for (auto const & it : mapSerialHashes) {
-        CMintMeta meta = it.second;
-        if (meta.GetPubCoinValueHash() == hashPubcoin)
-            return true;
-    }
-
-    for (auto const & it : mapLelantusSerialHashes) {
-        CLelantusMintMeta meta = it.second;
-        uint256 reducedHash;
-        walletdb.ReadPubcoinHashes(meta.GetPubCoinValueHash(), reducedHash);
-        if (reducedHash == hashPubcoin)
-            return true;
-    }
-
-    return false;
+    // Lelantus mint pool entries are keyed by the pubcoin without the amount
+    return mapPubcoinHashes.count(hashPubcoin) > 0 || mapLelantusReducedHashes.count(hashPubcoin) > 0;
 }
 
 /**
@@ -252,6 +244,40 @@ bool CHDMintTracker::HasLelantusSerialHash(const uint256& hashSerial) const
     return it != mapLelantusSerialHashes.end();
 }
 
+/**
+ * Index a mint by its pubcoin hash, so mints can be found by the pubcoin of their output
+ * without scanning all of them. Archived mints are dropped from the index, like they are
+ * left out when the mints are loaded from the database. As this is called whenever a meta
+ * object is stored, it also bumps the update counter used to invalidate data derived
+ * from the mints.
+ *
+ * @param meta mint meta object, which must already be in mapSerialHashes
+ * @return void
+ */
+void CHDMintTracker::UpdatePubcoinIndex(const CMintMeta& meta)
+{
+    nUpdateCounter++;
+    if (meta.isArchived)
+        mapPubcoinHashes.erase(meta.GetPubCoinValueHash());
+    else
+        mapPubcoinHashes[meta.GetPubCoinValueHash()] = meta.hashSerial;
+}
+
+void CHDMintTracker::UpdatePubcoinIndex(const CLelantusMintMeta& meta)
+{
+    nUpdateCounter++;
+    auto reducedPubcoin = meta.GetPubCoinValue() + lelantus::Params::get_default()->get_h1() * Scalar(meta.amount).negate();
+    uint256 reducedHash = primitives::GetPubCoinValueHash(reducedPubcoin);
+
+    if (meta.isArchived) {
+        mapLelantusPubcoinHashes.erase(meta.GetPubCoinValueHash());
+        mapLelantusReducedHashes.erase(reducedHash);
+    } else {
+        mapLelantusPubcoinHashes[meta.GetPubCoinValueHash()] = meta.hashSerial;
+        mapLelantusReducedHashes[reducedHash] = meta.hashSerial;
+    }
+}
+
 /**
  * Update the tracker state
  *
@@ -326,6 +352,7 @@ bool CHDMintTracker::UpdateState(const CMintMeta& meta)
     }
 
     mapSerialHashes[meta.hashSerial] = meta;
+    UpdatePubcoinIndex(meta);
 
     return true;
 }
@@ -375,6 +402,7 @@ bool CHDMintTracker::UpdateState(const CLelantusMintMeta& meta)
             CT_UPDATED);
 
     mapLelantusSerialHashes[meta.hashSerial] = meta;
+    UpdatePubcoinIndex(meta);
 
     return true;
 }
@@ -407,6 +435,7 @@ void CHDMintTracker::Add(CWalletDB& walletdb, const CHDMint& dMint, bool isNew,
     meta.isDeterministic = true;
     meta.isSeedCorrect = true;
     mapSerialHashes[meta.hashSerial] = meta;
+    UpdatePubcoinIndex(meta);
 
     pwalletMain->NotifyZerocoinChanged(
         pwalletMain,
@@ -431,6 +460,7 @@ void CHDMintTracker::AddLelantus(CWalletDB& walletdb, const CHDMint& dMint, bool
     meta.isArchived = isArchived;
     meta.isSeedCorrect = true;
     mapLelantusSerialHashes[meta.hashSerial] = meta;
+    UpdatePubcoinIndex(meta);
 
     pwalletMain->NotifyZerocoinChanged(
             pwalletMain,
@@ -459,6 +489,7 @@ void CHDMintTracker::Add(CWalletDB& walletdb, const CSigmaEntry& sigma, bool isN
     meta.isDeterministic = false;
     meta.isSeedCorrect = true;
     mapSerialHashes[meta.hashSerial] = meta;
+    UpdatePubcoinIndex(meta);
 
     if (isNew)
         walletdb.WriteSigmaEntry(sigma);
@@ -1296,4 +1327,9 @@ std::set<uint256> CHDMintTracker::GetMempoolTxids(){
 void CHDMintTracker::Clear()
 {
     mapSerialHashes.clear();
+    mapLelantusSerialHashes.clear();
+    mapPubcoinHashes.clear();
+    mapLelantusPubcoinHashes.clear();
+    mapLelantusReducedHashes.clear();
+    nUpdateCounter++;
 }
@@ -18,9 +18,15 @@ class CHDMintTracker
 private:
     bool fInitialized;
     std::string strWalletFile;
+    uint64_t nUpdateCounter; // incremented on every change of the in-memory mint state
     std::map<uint256, CMintMeta> mapSerialHashes;
     std::map<uint256, CLelantusMintMeta> mapLelantusSerialHashes;
+    std::map<uint256, uint256> mapPubcoinHashes; //pubcoinhash, serialhash of unarchived mints
+    std::map<uint256, uint256> mapLelantusPubcoinHashes; //pubcoinhash, serialhash
+    std::map<uint256, uint256> mapLelantusReducedHashes; //hash of pubcoin without amount, serialhash
     std::map<uint256, uint256> mapPendingSpends; //serialhash, txid of spend
+    void UpdatePubcoinIndex(const CMintMeta& meta);
+    void UpdatePubcoinIndex(const CLelantusMintMeta& meta);
     bool IsMempoolSpendOurs(const std::set<uint256>& setMempool, const uint256& hashSerial);
     bool UpdateMetaStatus(const std::set<uint256>& setMempool, CMintMeta& mint, bool fSpend=false);
     bool UpdateLelantusMetaStatus(const std::set<uint256>& setMempool, CLelantusMintMeta& mint, bool fSpend=false);
@@ -38,6 +44,7 @@ public:
     bool HasSerialHash(const uint256& hashSerial) const;
     bool HasLelantusSerialHash(const uint256& hashSerial) const;
     bool IsEmpty() const { return mapSerialHashes.empty(); }
+    uint64_t GetUpdateCounter() const { return nUpdateCounter; }
     void Init();
     bool GetMetaFromSerial(const uint256& hashSerial, CMintMeta& mMeta);
     bool GetMetaFromSerial(const uint256& hashSerial, CLelantusMintMeta& mMeta);
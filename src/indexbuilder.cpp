@@ -0,0 +1,310 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "indexbuilder.h"
+
+#include "chainparams.h"
+#include "lelantus.h"
+#include "sigma.h"
+#include "txdb.h"
+#include "undo.h"
+#include "util.h"
+#include "utiltime.h"
+#include "validation.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+namespace {
+
+// Seconds between two logs of the progress of the build
+const int64_t BUILD_LOG_INTERVAL = 60;
+
+// Adds the coins spent by the transactions of the block to view, and sums the fees of the block
+bool GetSpentCoins(const CBlock& block, const CBlockUndo& blockUndo, CCoinsViewCache& view, CAmount& nFees)
+{
+    nFees = 0;
+    for (size_t i = 1; i < block.vtx.size(); i++) {
+        const CTransaction &tx = *block.vtx[i];
+
+        if (tx.IsSigmaSpend()) {
+            nFees += sigma::GetSigmaSpendInput(tx) - tx.GetValueOut();
+        } else if (tx.IsLelantusJoinSplit()) {
+            try {
+                nFees += lelantus::ParseLelantusJoinSplit(tx.vin[0])->getFee();
+            }
+            catch (CBadTxIn&) {
+                return error("%s: unable to parse joinsplit %s", __func__, tx.GetHash().ToString());
+            }
+        } else if (!tx.IsZerocoinSpend() && !tx.IsZerocoinRemint()) {
+            // same inputs as the ones UpdateCoins wrote the undo data of
+            const CTxUndo &txundo = blockUndo.vtxundo[i - 1];
+            if (txundo.vprevout.size() != tx.vin.size())
+                return error("%s: transaction %s and undo data inconsistent", __func__, tx.GetHash().ToString());
+
+            for (size_t j = 0; j < tx.vin.size(); j++) {
+                nFees += txundo.vprevout[j].out.nValue;
+                view.AddCoin(tx.vin[j].prevout, Coin(txundo.vprevout[j]), true);
+            }
+            nFees -= tx.GetValueOut();
+        }
+    }
+    return true;
+}
+
+// Reads the block and its undo data, and adds the index records of the block to dbIndexHelper, or the
+// ones to remove if fDisconnect, the same way ConnectBlock and DisconnectBlock do. nSupply is what the
+// block added to the total supply.
+bool ReadBlockIndexRecords(const CBlockIndex* pindex, bool fDisconnect, CDbIndexHelper& dbIndexHelper, CAmount& nSupply,
+                           const Consensus::Params& consensusParams)
+{
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pindex, consensusParams, false))
+        return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+
+    CBlockUndo blockUndo;
+    CDiskBlockPos pos = pindex->GetUndoPos();
+    if (pos.IsNull() || !UndoReadFromDisk(blockUndo, pos, pindex->pprev->GetBlockHash()))
+        return error("%s: failed to read the undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    if (blockUndo.vtxundo.size() + 1 != block.vtx.size())
+        return error("%s: block %s and undo data inconsistent", __func__, pindex->GetBlockHash().ToString());
+
+    // the index entries of the inputs are made of the coins they spent, which the undo data has
+    CCoinsView viewDummy;
+    CCoinsViewCache view(&viewDummy);
+    CAmount nFees;
+    if (!GetSpentCoins(block, blockUndo, view, nFees))
+        return false;
+
+    if (!fDisconnect) {
+        for (size_t i = 0; i < block.vtx.size(); i++)
+            dbIndexHelper.ConnectTransaction(*block.vtx[i], pindex->nHeight, i, view);
+    } else {
+        for (int i = block.vtx.size() - 1; i >= 0; i--) {
+            dbIndexHelper.DisconnectTransactionOutputs(*block.vtx[i], pindex->nHeight, i, view);
+            dbIndexHelper.DisconnectTransactionInputs(*block.vtx[i], pindex->nHeight, i, view);
+        }
+    }
+
+    nSupply = block.vtx[0]->GetValueOut() - nFees;
+    return true;
+}
+
+// Adds the block to the indexes being built, or removes it from them if fDisconnect, and moves the
+// build state to it
+bool IndexBlock(const CBlockIndex* pindex, bool fDisconnect, CIndexBuildState& state, const Consensus::Params& consensusParams)
+{
+    CDbIndexHelper dbIndexHelper(state.fAddressIndex, state.fSpentIndex);
+    CAmount nSupply;
+    if (!ReadBlockIndexRecords(pindex, fDisconnect, dbIndexHelper, nSupply, consensusParams))
+        return false;
+
+    // the progress is written along with the records, a build resumed after a crash starts right after them
+    state.hashBlock = fDisconnect ? pindex->pprev->GetBlockHash() : pindex->GetBlockHash();
+
+    CDBBatch batch(*pindexdb);
+    if (state.fAddressIndex) {
+        pindexdb->UpdateAddressIndex(batch, dbIndexHelper, pindex->nHeight, fDisconnect, state.hashBlock);
+        state.nTotalSupply += fDisconnect ? -nSupply : nSupply;
+    }
+    if (state.fSpentIndex)
+        pindexdb->UpdateSpentIndex(batch, dbIndexHelper.getSpentIndex());
+    // as with DisconnectBlock, the timestamps of disconnected blocks stay
+    if (state.fTimestampIndex && !fDisconnect)
+        pindexdb->WriteTimestampIndex(batch, CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash()));
+
+    pindexdb->WriteBuildState(batch, state);
+    return pindexdb->WriteBatch(batch);
+}
+
+// Adds the block to the address index, or removes it from it if fDisconnect, as ConnectBlock and
+// DisconnectBlock would
+bool UpdateAddressIndex(const CBlockIndex* pindex, bool fDisconnect, const Consensus::Params& consensusParams)
+{
+    CDbIndexHelper dbIndexHelper(true, false);
+    CAmount nSupply;
+    if (!ReadBlockIndexRecords(pindex, fDisconnect, dbIndexHelper, nSupply, consensusParams))
+        return false;
+
+    CDBBatch batch(*pindexdb);
+    pindexdb->UpdateAddressIndex(batch, dbIndexHelper, pindex->nHeight, fDisconnect,
+                                 fDisconnect ? pindex->pprev->GetBlockHash() : pindex->GetBlockHash());
+    return pindexdb->WriteBatch(batch) && pblocktree->AddTotalSupply(fDisconnect ? -nSupply : nSupply);
+}
+
+// Switches the built indexes on, the blocks connected from now on are indexed by ConnectBlock
+bool FinishIndexBuild(const CIndexBuildState& state)
+{
+    AssertLockHeld(cs_main);
+
+    if (state.fAddressIndex) {
+        // the build summed the supply of the whole chain, whatever was stored before is stale
+        if (!pblocktree->WriteTotalSupply(state.nTotalSupply) ||
+                !pblocktree->WriteFlag("addressbalanceindex", true) ||
+                !pblocktree->WriteFlag("addressindex", true))
+            return false;
+        fAddressIndex = true;
+    }
+    if (state.fSpentIndex) {
+        if (!pblocktree->WriteFlag("spentindex", true))
+            return false;
+        fSpentIndex = true;
+    }
+    if (state.fTimestampIndex) {
+        if (!pblocktree->WriteFlag("timestampindex", true))
+            return false;
+        fTimestampIndex = true;
+    }
+
+    // a state left behind by a crash right now is dropped on the next start, the flags being set
+    return pindexdb->EraseBuildState();
+}
+
+void ThreadBuildIndexes(CIndexBuildState state)
+{
+    RenameThread("bitcoin-indexbuild");
+
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    int64_t nLastLogTime = GetTime();
+
+    while (true) {
+        boost::this_thread::interruption_point();
+
+        const CBlockIndex* pindex;
+        bool fDisconnect = false;
+        int nTipHeight;
+        {
+            LOCK(cs_main);
+            BlockMap::const_iterator mi = mapBlockIndex.find(state.hashBlock);
+            if (mi == mapBlockIndex.end()) {
+                error("%s: unknown block %s", __func__, state.hashBlock.ToString());
+                break;
+            }
+
+            if (!chainActive.Contains(mi->second)) {
+                pindex = mi->second;
+                fDisconnect = true;
+            } else if ((pindex = chainActive.Next(mi->second)) == NULL) {
+                if (!FinishIndexBuild(state)) {
+                    error("%s: failed to switch the built indexes on", __func__);
+                    break;
+                }
+                LogPrintf("Indexes built up to block %s at height %d\n", state.hashBlock.ToString(), chainActive.Height());
+                return;
+            }
+            nTipHeight = chainActive.Height();
+        }
+
+        // the blocks are read without holding cs_main, the node keeps working meanwhile
+        if (!IndexBlock(pindex, fDisconnect, state, consensusParams)) {
+            error("%s: failed to index block %s", __func__, pindex->GetBlockHash().ToString());
+            break;
+        }
+
+        if (GetTime() - nLastLogTime >= BUILD_LOG_INTERVAL) {
+            LogPrintf("Building indexes, at height %d of %d\n", pindex->nHeight, nTipHeight);
+            nLastLogTime = GetTime();
+        }
+    }
+
+    LogPrintf("Index build stopped, it will be resumed on the next start\n");
+}
+
+}
+
+bool SyncAddressIndex(const CChainParams& chainparams)
+{
+    AssertLockHeld(cs_main);
+
+    const CBlockIndex* pindexTip = chainActive.Tip();
+    if (!fAddressIndex || pindexTip == NULL)
+        return true;
+
+    uint256 hashBest;
+    if (!pindexdb->ReadAddressIndexBestBlock(hashBest)) {
+        // written by a version which didn't keep track of it, taken as being at the tip from now on
+        CDBBatch batch(*pindexdb);
+        pindexdb->WriteAddressIndexBestBlock(batch, pindexTip->GetBlockHash());
+        return pindexdb->WriteBatch(batch);
+    }
+
+    BlockMap::const_iterator mi = mapBlockIndex.find(hashBest);
+    if (mi == mapBlockIndex.end())
+        return error("%s: the address index is at unknown block %s", __func__, hashBest.ToString());
+    const CBlockIndex* pindex = mi->second;
+    if (pindex == pindexTip)
+        return true;
+
+    LogPrintf("Address index at block %s, bringing it to the chain state tip %s\n", hashBest.ToString(),
+              pindexTip->GetBlockHash().ToString());
+
+    // the blocks which aren't in the chain state are removed, they are counted again if connected again
+    const CBlockIndex* pindexFork = chainActive.FindFork(pindex);
+    for (; pindex != pindexFork; pindex = pindex->pprev) {
+        if (!UpdateAddressIndex(pindex, true, chainparams.GetConsensus()))
+            return error("%s: failed to remove block %s from the address index", __func__, pindex->GetBlockHash().ToString());
+    }
+    while (pindex != pindexTip) {
+        pindex = chainActive.Next(pindex);
+        if (!UpdateAddressIndex(pindex, false, chainparams.GetConsensus()))
+            return error("%s: failed to add block %s to the address index", __func__, pindex->GetBlockHash().ToString());
+    }
+    return true;
+}
+
+bool StartIndexBuilder(boost::thread_group& threadGroup, std::string& strError)
+{
+    CIndexBuildState requested;
+    uint256 hashGenesis;
+    {
+        LOCK(cs_main);
+        requested.fAddressIndex = !fAddressIndex && GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
+        requested.fSpentIndex = !fSpentIndex && GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
+        requested.fTimestampIndex = !fTimestampIndex && GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
+        if (chainActive.Genesis())
+            hashGenesis = chainActive.Genesis()->GetBlockHash();
+    }
+
+    CIndexBuildState state;
+    bool fBuilding = pindexdb->ReadBuildState(state);
+
+    if (requested.IsNull()) {
+        if (fBuilding && !pindexdb->EraseBuildState()) {
+            strError = _("Failed to write to the index database");
+            return false;
+        }
+        return true;
+    }
+
+    if (fPruneMode) {
+        strError = _("Indexes can't be built in prune mode, rebuild the database using -reindex without -prune instead");
+        return false;
+    }
+
+    if (!fBuilding || state.fAddressIndex != requested.fAddressIndex || state.fSpentIndex != requested.fSpentIndex
+            || state.fTimestampIndex != requested.fTimestampIndex) {
+        // records of an earlier build of other indexes are dropped too
+        LogPrintf("Starting the build of the requested indexes\n");
+        if (!pindexdb->EraseIndexes(requested.fAddressIndex || state.fAddressIndex, requested.fSpentIndex || state.fSpentIndex,
+                                    requested.fTimestampIndex || state.fTimestampIndex)) {
+            strError = _("Failed to write to the index database");
+            return false;
+        }
+
+        // the genesis block isn't connected, its outputs aren't indexed
+        state = requested;
+        state.hashBlock = hashGenesis;
+        CDBBatch batch(*pindexdb);
+        pindexdb->WriteBuildState(batch, state);
+        if (!pindexdb->WriteBatch(batch, true)) {
+            strError = _("Failed to write to the index database");
+            return false;
+        }
+    } else {
+        LogPrintf("Resuming the build of the requested indexes after block %s\n", state.hashBlock.ToString());
+    }
+
+    threadGroup.create_thread(boost::bind(&ThreadBuildIndexes, state));
+    return true;
+}
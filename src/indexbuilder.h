@@ -0,0 +1,43 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FIRO_INDEXBUILDER_H
+#define FIRO_INDEXBUILDER_H
+
+#include <string>
+
+class CChainParams;
+
+namespace boost {
+class thread_group;
+}
+
+/**
+ * Builds the indexes requested by -addressindex, -spentindex and -timestampindex which
+ * the node's databases were created without, so they don't need a -reindex.
+ *
+ * A background thread goes through the blocks of the active chain, read from the block
+ * and undo files, while the node keeps running. The index records of each block are
+ * written along with the progress, so a build interrupted by a shutdown resumes where it
+ * was. Blocks disconnected from the active chain in the meantime are removed from the
+ * indexes. Once the build reaches the tip, the indexes are switched on: from then on
+ * ConnectBlock maintains them and the RPCs using them are available.
+ *
+ * Must be called once the block index is loaded. Returns false, with strError set, if the
+ * indexes can't be built.
+ */
+bool StartIndexBuilder(boost::thread_group& threadGroup, std::string& strError);
+
+/**
+ * Brings the address index to the tip of the chain state. The index is written as blocks are
+ * connected and disconnected, ahead of the chain state, which is flushed from time to time: after
+ * a crash the chain state can be at an earlier block, or on another branch. The blocks in between
+ * are removed from or added to the index, its balance records then follow the blocks the node
+ * connects and disconnects from there without counting any of them twice.
+ *
+ * Must be called with cs_main held, once the chain state is loaded.
+ */
+bool SyncAddressIndex(const CChainParams& chainparams);
+
+#endif // FIRO_INDEXBUILDER_H
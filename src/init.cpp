@@ -32,6 +32,8 @@
 #include "scheduler.h"
 #include "timedata.h"
 #include "txdb.h"
+#include "privacystatedb.h"
+#include "indexbuilder.h"
 #include "txmempool.h"
 #include "torcontrol.h"
 #include "ui_interface.h"
@@ -41,6 +43,10 @@
 #include "validation.h"
 #include "mtpstate.h"
 #include "batchproof_container.h"
+#include "mtp_precheck.h"
+#include "sigma.h"
+#include "lelantus.h"
+#include "secp256k1/include/MultiExponent.h"
 
 #ifdef ENABLE_WALLET
 #include "wallet/wallet.h"
@@ -255,6 +261,12 @@ void Shutdown()
     llmq::StopLLMQSystem();
 
     BatchProofContainer::get_instance()->finalize();
+    // blocks holding proofs which failed the last batch verification are invalidated on the next start
+    if (pblocktree != NULL && !WriteBlocksFailedBatchVerification())
+        LogPrintf("%s: failed to store the blocks which failed batch verification\n", __func__);
+    BatchProofContainer::get_instance()->stopWorkers();
+    MTPPrecheck::get_instance()->stopWorkers();
+    secp_primitives::MultiExponent::set_parallelism(1);
 
 #ifdef ENABLE_WALLET
     if (pwalletMain)
@@ -286,7 +298,12 @@ void Shutdown()
         LOCK(cs_main);
         if (pcoinsTip != NULL) {
             FlushStateToDisk();
+            if (pprivacystatedb && chainActive.Tip())
+                pprivacystatedb->WriteState(chainActive.Tip()->GetBlockHash(),
+                    *sigma::CSigmaState::GetState(), *lelantus::CLelantusState::GetState());
         }
+        delete pprivacystatedb;
+        pprivacystatedb = NULL;
         delete pcoinsTip;
         pcoinsTip = NULL;
         delete pcoinscatcher;
@@ -295,6 +312,8 @@ void Shutdown()
         pcoinsdbview = NULL;
         delete pblocktree;
         pblocktree = NULL;
+        delete pindexdb;
+        pindexdb = NULL;
         llmq::DestroyLLMQSystem();
         delete deterministicMNManager;
         deterministicMNManager = NULL;
@@ -343,6 +362,10 @@ void Shutdown()
 #endif
     UnregisterAllValidationInterfaces();
 #ifdef ENABLE_WALLET
+    if (pwalletMain) {
+        mempool.NotifyEntryRemoved.disconnect(boost::bind(&CWallet::TransactionRemovedFromMempool, pwalletMain, _1, _2));
+        txpools.getStemTxPool().NotifyEntryRemoved.disconnect(boost::bind(&CWallet::TransactionRemovedFromMempool, pwalletMain, _1, _2));
+    }
     delete pwalletMain;
     pwalletMain = NULL;
 #endif
@@ -437,6 +460,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-maxmempool=<n>", strprintf(_("Keep the transaction memory pool below <n> megabytes (default: %u)"), DEFAULT_MAX_MEMPOOL_SIZE));
     strUsage += HelpMessageOpt("-mempoolexpiry=<n>", strprintf(_("Do not keep transactions in the mempool longer than <n> hours (default: %u)"), DEFAULT_MEMPOOL_EXPIRY));
     strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Extra transactions to keep in memory for compact block reconstructions (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
+    strUsage += HelpMessageOpt("-rawblockcache=<n>", strprintf(_("Keep the blocks recently sent to peers in memory, up to <n> megabytes (default: %u)"), DEFAULT_RAW_BLOCK_CACHE_SIZE));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
 #ifndef WIN32
@@ -451,6 +475,9 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-sysperms", _("Create new files with system default permissions, instead of umask 077 (only effective with disabled wallet functionality)"));
 #endif
     strUsage += HelpMessageOpt("-txindex", strprintf(_("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)"), DEFAULT_TXINDEX));
+    strUsage += HelpMessageOpt("-addressindex", strprintf(_("Maintain a full address index, used by the getaddress* rpc calls. When enabled on an existing node it is built in the background and the rpc calls are available once that's done (default: %u)"), DEFAULT_ADDRESSINDEX));
+    strUsage += HelpMessageOpt("-spentindex", strprintf(_("Maintain a full spent index, used by the getspentinfo rpc call. When enabled on an existing node it is built in the background and the rpc call is available once that's done (default: %u)"), DEFAULT_SPENTINDEX));
+    strUsage += HelpMessageOpt("-timestampindex", strprintf(_("Maintain a timestamp index for block hashes, used by the getblockhashes rpc call. When enabled on an existing node it is built in the background and the rpc call is available once that's done (default: %u)"), DEFAULT_TIMESTAMPINDEX));
 
     strUsage += HelpMessageGroup(_("Connection options:"));
     strUsage += HelpMessageOpt("-addnode=<ip>", _("Add a node to connect to and attempt to keep the connection open"));
@@ -517,6 +544,7 @@ std::string HelpMessage(HelpMessageMode mode)
         strUsage += HelpMessageOpt("-checkblockindex", strprintf("Do a full consistency check for mapBlockIndex, setBlockIndexCandidates, chainActive and mapBlocksUnlinked occasionally. Also sets -checkmempool (default: %u)", Params(CBaseChainParams::MAIN).DefaultConsistencyChecks()));
         strUsage += HelpMessageOpt("-checkmempool=<n>", strprintf("Run checks every <n> transactions (default: %u)", Params(CBaseChainParams::MAIN).DefaultConsistencyChecks()));
         strUsage += HelpMessageOpt("-checkpoints", strprintf("Disable expensive verification for known chain history (default: %u)", DEFAULT_CHECKPOINTS_ENABLED));
+        strUsage += HelpMessageOpt("-paranoidblockreads", strprintf("Check proof of work of every block read from disk, even already validated ones (default: %u)", DEFAULT_PARANOID_BLOCK_READS));
         strUsage += HelpMessageOpt("-disablesafemode", strprintf("Disable safemode, override a real safe mode event (default: %u)", DEFAULT_DISABLE_SAFEMODE));
         strUsage += HelpMessageOpt("-testsafemode", strprintf("Force safe mode (default: %u)", DEFAULT_TESTSAFEMODE));
         strUsage += HelpMessageOpt("-dropmessagestest=<n>", "Randomly drop 1 of every <n> network messages");
@@ -1239,6 +1267,7 @@ bool AppInitParameterInteraction()
     }
     fCheckBlockIndex = GetBoolArg("-checkblockindex", chainparams.DefaultConsistencyChecks());
     fCheckpointsEnabled = GetBoolArg("-checkpoints", DEFAULT_CHECKPOINTS_ENABLED);
+    fParanoidBlockReads = GetBoolArg("-paranoidblockreads", DEFAULT_PARANOID_BLOCK_READS);
 
     hashAssumeValid = uint256S(GetArg("-assumevalid", chainparams.GetConsensus().defaultAssumeValid.GetHex()));
     if (!hashAssumeValid.IsNull())
@@ -1482,11 +1511,19 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
 
     InitSignatureCache();
 
-    LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
+    LogPrintf("Using %u threads for script and sigma/lelantus proof verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
-        for (int i=0; i<nScriptCheckThreads-1; i++)
+        for (int i=0; i<nScriptCheckThreads-1; i++) {
             threadGroup.create_thread(&ThreadScriptCheck);
+            threadGroup.create_thread(&ThreadPrivacyProofCheck);
+        }
     }
+    // batch verification of collected sigma/lelantus proofs is spread over the same number of threads
+    BatchProofContainer::get_instance()->startWorkers(nScriptCheckThreads);
+    // so are multi-exponentiations over large anonymity sets
+    secp_primitives::MultiExponent::set_parallelism(std::max(nScriptCheckThreads, 1));
+    // and MTP proofs of blocks received from peers, ahead of the message handler processing them
+    MTPPrecheck::get_instance()->startWorkers(nScriptCheckThreads);
 
     // Start the lightweight task scheduler thread
     CScheduler::Function serviceLoop = boost::bind(&CScheduler::serviceQueue, &scheduler);
@@ -1715,6 +1752,11 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     if (nBlockTreeDBCache > (1 << 21) && !GetBoolArg("-txindex", false))
         nBlockTreeDBCache = (1 << 21); // block tree db cache shouldn't be larger than 2 MiB
     nTotalCache -= nBlockTreeDBCache;
+    int64_t nIndexDBCache = nMinIndexDBCache << 20;
+    if (GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) || GetBoolArg("-spentindex", DEFAULT_SPENTINDEX) ||
+            GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX))
+        nIndexDBCache = std::max(std::min(nTotalCache / 8, nMaxIndexDBCache << 20), nIndexDBCache);
+    nTotalCache -= nIndexDBCache;
     int64_t nCoinDBCache = std::min(nTotalCache / 2,
                                     (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     nCoinDBCache = std::min(nCoinDBCache, nMaxCoinsDBCache << 20); // cap total coins db cache
@@ -1725,6 +1767,7 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     int64_t nEvoDbCache = 1024 * 1024 * 16; // TODO
     LogPrintf("Cache configuration:\n");
     LogPrintf("* Using %.1fMiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
+    LogPrintf("* Using %.1fMiB for index database\n", nIndexDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of unused mempool space)\n", nCoinCacheUsage * (1.0 / 1024 / 1024), nMempoolSizeMax * (1.0 / 1024 / 1024));
 
@@ -1743,6 +1786,8 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                 delete pcoinscatcher;
                 llmq::DestroyLLMQSystem();
                 delete pblocktree;
+                delete pindexdb;
+                delete pprivacystatedb;
                 delete evoDb;
 
                 MTPState::GetMTPState()->SetMTPStartBlock(chainparams.GetConsensus().nMTPStartBlock);
@@ -1759,9 +1804,17 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     }
                 }
 
+                // the indexes are written again as the blocks are connected again, the total supply with them
+                pindexdb = new CIndexDB(nIndexDBCache, false, fReindex || fReindexChainState);
+                if (fReindexChainState && !fReindex && !pblocktree->WriteTotalSupply(0)) {
+                    strLoadError = _("Error resetting the total supply");
+                    break;
+                }
+
                 evoDb = new CEvoDB(nEvoDbCache, false, fReindex || fReindexChainState);
                 deterministicMNManager = new CDeterministicMNManager(*evoDb);
 
+                pprivacystatedb = new CPrivacyStateDB(nPrivacyStateDBCache << 20, false, fReindex || fReindexChainState);
                 pcoinsdbview = new CCoinsViewDB(nCoinDBCache, false, fReindex || fReindexChainState);
                 pcoinscatcher = new CCoinsViewErrorCatcher(pcoinsdbview);
                 pcoinsTip = new CCoinsViewCache(pcoinscatcher);
@@ -1832,6 +1885,14 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
 
                 deterministicMNManager->UpgradeDBIfNeeded();
 
+                {
+                    LOCK(cs_main);
+                    if (!SyncAddressIndex(chainparams)) {
+                        strLoadError = _("Error bringing the address index to the chain state");
+                        break;
+                    }
+                }
+
                 if (!fReindex && chainActive.Tip() != NULL) {
                     uiInterface.InitMessage(_("Rewinding blocks..."));
                     if (!RewindBlockIndex(chainparams)) {
@@ -1863,6 +1924,15 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     strLoadError = _("Corrupted block database detected");
                     break;
                 }
+
+                {
+                    LOCK(cs_main);
+                    CValidationState state;
+                    if (!LoadBlocksFailedBatchVerification(state, chainparams)) {
+                        strLoadError = _("Error invalidating blocks which failed batch verification");
+                        break;
+                    }
+                }
             } catch (const std::exception& e) {
                 if (fDebug) LogPrintf("%s\n", e.what());
                 strLoadError = _("Error opening block database");
@@ -2101,6 +2171,11 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
         uiInterface.NotifyBlockTip.disconnect(BlockNotifyGenesisWait);
     }
 
+    // Indexes enabled on a node with existing databases are built while it runs
+    std::string strIndexError;
+    if (!StartIndexBuilder(threadGroup, strIndexError))
+        return InitError(strIndexError);
+
     // ********************************************************* Step 12: start node
 
     //// debug print
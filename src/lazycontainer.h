@@ -0,0 +1,159 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FIRO_LAZYCONTAINER_H
+#define FIRO_LAZYCONTAINER_H
+
+#include "serialize.h"
+
+#include <memory>
+#include <utility>
+
+/* Standard container which is only allocated once it holds an element.
+ *
+ * Meant for members of objects kept in large numbers (e.g. CBlockIndex) which
+ * are empty for nearly all of them: an empty lazycontainer costs one pointer
+ * instead of the (much larger) empty map/set header, and no heap allocation.
+ *
+ * The interface mirrors the wrapped container for the operations the callers
+ * need. Read-only access to an unallocated container goes to a shared empty
+ * instance, mutating operations allocate it on demand. Iterators of different
+ * lazycontainer objects must not be compared with each other.
+ */
+template <typename C>
+class lazycontainer {
+private:
+    std::unique_ptr<C> c;
+
+    static const C& empty_instance() {
+        static const C empty;
+        return empty;
+    }
+
+    // Target of mutable iterators while unallocated. It's never modified: the
+    // only iterator of an empty container is end(), which can't be written through.
+    static C& empty_mutable_instance() {
+        static C empty;
+        return empty;
+    }
+
+    C& get_mutable() { return c ? *c : empty_mutable_instance(); }
+
+    C& get_or_create() {
+        if (!c)
+            c.reset(new C());
+        return *c;
+    }
+
+public:
+    typedef C container_type;
+    typedef typename C::iterator iterator;
+    typedef typename C::const_iterator const_iterator;
+    typedef typename C::size_type size_type;
+    // key_type/value_type are deliberately not exposed: serialize.h picks its
+    // map/set overloads by them, this class serializes through its own members.
+    typedef typename C::key_type key_type_t;
+
+    lazycontainer() {}
+    lazycontainer(const lazycontainer& other) { *this = other; }
+    lazycontainer(lazycontainer&& other) noexcept : c(std::move(other.c)) {}
+    lazycontainer(const C& other) { *this = other; }
+
+    lazycontainer& operator=(const lazycontainer& other) {
+        if (this != &other)
+            *this = other.get();
+        return *this;
+    }
+
+    lazycontainer& operator=(lazycontainer&& other) noexcept {
+        c = std::move(other.c);
+        return *this;
+    }
+
+    lazycontainer& operator=(const C& other) {
+        if (other.empty())
+            c.reset();
+        else if (c)
+            *c = other;
+        else
+            c.reset(new C(other));
+        return *this;
+    }
+
+    //! Returns the wrapped container, or an empty one if it was never allocated
+    const C& get() const { return c ? *c : empty_instance(); }
+    operator const C&() const { return get(); }
+
+    //! Whether the container is allocated (used for memory usage accounting)
+    bool allocated() const { return (bool)c; }
+
+    size_type size() const { return c ? c->size() : 0; }
+    bool empty() const { return !c || c->empty(); }
+    size_type count(const key_type_t& k) const { return c ? c->count(k) : 0; }
+
+    const_iterator begin() const { return get().begin(); }
+    const_iterator end() const { return get().end(); }
+    const_iterator find(const key_type_t& k) const { return get().find(k); }
+
+    // Iterating (including range-for over a non-const object) must not allocate.
+    iterator begin() { return get_mutable().begin(); }
+    iterator end() { return get_mutable().end(); }
+    iterator find(const key_type_t& k) { return get_mutable().find(k); }
+
+    // Map only members, templated on the container so they're not instantiated for sets.
+    template <typename CC = C>
+    typename CC::mapped_type& operator[](const key_type_t& k) {
+        return get_or_create()[k];
+    }
+
+    template <typename CC = C>
+    const typename CC::mapped_type& at(const key_type_t& k) const {
+        return get().at(k);
+    }
+
+    template <typename... Args>
+    auto insert(Args&&... args) -> decltype(std::declval<C&>().insert(std::forward<Args>(args)...)) {
+        return get_or_create().insert(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    auto emplace(Args&&... args) -> decltype(std::declval<C&>().emplace(std::forward<Args>(args)...)) {
+        return get_or_create().emplace(std::forward<Args>(args)...);
+    }
+
+    size_type erase(const key_type_t& k) {
+        if (!c)
+            return 0;
+        size_type n = c->erase(k);
+        if (c->empty())
+            c.reset();
+        return n;
+    }
+
+    // Iterator overload, the container is necessarily allocated as the iterator
+    // points to an element. It is not released here as callers may go on iterating.
+    iterator erase(const_iterator it) { return c->erase(it); }
+
+    void clear() { c.reset(); }
+
+    template <typename Stream>
+    void Serialize(Stream& s) const {
+        ::Serialize(s, get());
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s) {
+        C tmp;
+        ::Unserialize(s, tmp);
+        if (tmp.empty())
+            c.reset();
+        else
+            c.reset(new C(std::move(tmp)));
+    }
+
+    friend bool operator==(const lazycontainer& a, const lazycontainer& b) { return a.get() == b.get(); }
+    friend bool operator!=(const lazycontainer& a, const lazycontainer& b) { return a.get() != b.get(); }
+};
+
+#endif // FIRO_LAZYCONTAINER_H
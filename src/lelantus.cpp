@@ -17,6 +17,7 @@
 #include "policy/policy.h"
 #include "coins.h"
 #include "batchproof_container.h"
+#include "privacyproof_check.h"
 
 #include <atomic>
 #include <sstream>
@@ -342,7 +343,8 @@ bool CheckLelantusJoinSplitTransaction(
         bool isCheckWallet,
         bool fStatefulSigmaCheck,
         sigma::CSigmaTxInfo* sigmaTxInfo,
-        CLelantusTxInfo* lelantusTxInfo) {
+        CLelantusTxInfo* lelantusTxInfo,
+        std::vector<CPrivacyProofCheck> *pvProofChecks) {
     std::unordered_set<Scalar, sigma::CScalarHash> txSerials;
 
     Consensus::Params const & params = ::Params().GetConsensus();
@@ -355,7 +357,7 @@ bool CheckLelantusJoinSplitTransaction(
     }
 
     const CTxIn &txin = tx.vin[0];
-    std::unique_ptr<lelantus::JoinSplit> joinsplit;
+    std::shared_ptr<lelantus::JoinSplit> joinsplit;
 
     try {
         joinsplit = ParseLelantusJoinSplit(txin);
@@ -393,7 +395,7 @@ bool CheckLelantusJoinSplitTransaction(
     }
 
     bool passVerify = false;
-    std::map<uint32_t, std::vector<PublicCoin>> anonymity_sets;
+    std::map<uint32_t, AnonymitySetPtr> anonymity_sets;
     std::vector<PublicCoin> Cout;
     uint64_t Vout = 0;
 
@@ -411,7 +413,6 @@ bool CheckLelantusJoinSplitTransaction(
     std::vector<std::vector<unsigned char>> anonymity_set_hashes;
 
     for (auto& idAndHash : joinsplit->getIdAndBlockHashes()) {
-        auto& anonymity_set = anonymity_sets[idAndHash.first];
         int coinGroupId = idAndHash.first % (CENT / 1000);
         int64_t intDenom = (idAndHash.first - coinGroupId);
         intDenom *= 1000;
@@ -434,6 +435,7 @@ bool CheckLelantusJoinSplitTransaction(
             std::pair<sigma::CoinDenomination, int> denominationAndId = std::make_pair(denomination, coinGroupId);
 
             auto lelantusParams = lelantus::Params::get_default();
+            std::vector<PublicCoin> anonymity_set;
             while (true) {
                 if (index->sigmaMintedPubCoins.count(denominationAndId) > 0) {
                     BOOST_FOREACH(
@@ -450,6 +452,7 @@ bool CheckLelantusJoinSplitTransaction(
                     break;
                 index = index->pprev;
             }
+            anonymity_sets[idAndHash.first] = std::make_shared<AnonymitySetSnapshot>(std::move(anonymity_set));
         } else {
             CLelantusState::LelantusCoinGroupInfo coinGroup;
             if (!lelantusState.GetCoinGroupInfo(idAndHash.first, coinGroup))
@@ -469,47 +472,40 @@ bool CheckLelantusJoinSplitTransaction(
                 if (!set_hash.empty())
                     anonymity_set_hashes.push_back(set_hash);
             }
-            // Build a vector with all the public coins with given id before
-            // the block on which the spend occured.
+            // Take all the public coins with given id before the block on which the spend occured.
             // This list of public coins is required by function "Verify" of JoinSplit.
-
-            while (true) {
-                if(index->lelantusMintedPubCoins.count(idAndHash.first) > 0) {
-                    BOOST_FOREACH(
-                    const auto& pubCoinValue,
-                    index->lelantusMintedPubCoins[idAndHash.first]) {
-                        // skip mints from blacklist if nLelantusFixesStartBlock is passed
-                        if (chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock) {
-                            if (::Params().GetConsensus().lelantusBlacklist.count(pubCoinValue.first.getValue()) > 0) {
-                                continue;
-                            }
-                        }
-                        anonymity_set.push_back(pubCoinValue.first);
-                    }
-                }
-                if (index == coinGroup.firstBlock)
-                    break;
-                index = index->pprev;
-            }
+            // skip mints from blacklist if nLelantusFixesStartBlock is passed
+            bool fSkipBlacklisted = chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock;
+            anonymity_sets[idAndHash.first] = lelantusState.GetAnonymitySetSnapshot(idAndHash.first, index, false, fSkipBlacklisted);
         }
-        anonymity_sets[idAndHash.first] = anonymity_set;
     }
 
     BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
     bool useBatching = batchProofContainer->fCollectProofs && !isVerifyDB && !isCheckWallet && lelantusTxInfo && !lelantusTxInfo->fInfoIsComplete;
 
-    Scalar challenge;
-    // if we are collecting proofs, skip verification and collect proofs
-    passVerify = joinsplit->Verify(anonymity_sets, anonymity_set_hashes, Cout, Vout, txHashForMetadata, challenge, useBatching);
+    if (pvProofChecks) {
+        // proof is verified later by the check queue, the state checks below don't depend on it
+        pvProofChecks->emplace_back(joinsplit, std::move(anonymity_sets), std::move(anonymity_set_hashes), std::move(Cout), Vout,
+                                    txHashForMetadata, nHeight >= params.nLelantusFixesStartBlock, useBatching, hashTx, nHeight);
+        passVerify = true;
+    } else {
+        std::map<uint32_t, PublicCoinRange> ranges;
+        for (const auto& set : anonymity_sets)
+            ranges[set.first] = set.second->coins();
+
+        Scalar challenge;
+        // if we are collecting proofs, skip verification and collect proofs
+        passVerify = joinsplit->Verify(ranges, anonymity_set_hashes, Cout, Vout, txHashForMetadata, challenge, useBatching);
 
-    // add proofs into container
-    if(useBatching) {
-        std::map<uint32_t, size_t> idAndSizes;
+        // add proofs into container
+        if(useBatching) {
+            std::map<uint32_t, size_t> idAndSizes;
 
-        for(auto itr : anonymity_sets)
-            idAndSizes[itr.first] = itr.second.size();
+            for(auto itr : ranges)
+                idAndSizes[itr.first] = itr.second.size();
 
-        batchProofContainer->add(joinsplit.get(), idAndSizes, challenge, nHeight >= params.nLelantusFixesStartBlock);
+            batchProofContainer->add(joinsplit.get(), idAndSizes, challenge, Cout, nHeight >= params.nLelantusFixesStartBlock, hashTx);
+        }
     }
 
     if (passVerify) {
@@ -658,7 +654,8 @@ bool CheckLelantusTransaction(
         bool isCheckWallet,
         bool fStatefulSigmaCheck,
         sigma::CSigmaTxInfo* sigmaTxInfo,
-        CLelantusTxInfo* lelantusTxInfo)
+        CLelantusTxInfo* lelantusTxInfo,
+        std::vector<CPrivacyProofCheck> *pvProofChecks)
 {
     Consensus::Params const & consensus = ::Params().GetConsensus();
 
@@ -719,7 +716,7 @@ bool CheckLelantusTransaction(
         if (!isVerifyDB) {
             if (!CheckLelantusJoinSplitTransaction(
                 tx, state, hashTx, isVerifyDB, nHeight,
-                isCheckWallet, fStatefulSigmaCheck, sigmaTxInfo, lelantusTxInfo)) {
+                isCheckWallet, fStatefulSigmaCheck, sigmaTxInfo, lelantusTxInfo, pvProofChecks)) {
                     return false;
             }
         }
@@ -860,9 +857,8 @@ bool ConnectBlockLelantus(
         // create first anonymity set hash with whole existing set, at HF block
         if (pindexNew->nHeight == params.nLelantusFixesStartBlock) {
             updateHash = true;
-            std::vector<lelantus::PublicCoin> coins;
-            lelantusState.GetAnonymitySet(1, false, coins);
-            for (auto &coin : coins) {
+            AnonymitySetPtr anonymitySet = lelantusState.GetAnonymitySet(1, false);
+            for (auto &coin : anonymitySet->coins()) {
                 coin.getValue().serialize(data.data());
                 hash.Write(data.data(), data.size());
             }
@@ -1015,9 +1011,9 @@ CLelantusState::Containers::Containers(std::atomic<bool> & surgeCondition)
 : surgeCondition(surgeCondition)
 {}
 
-void CLelantusState::Containers::AddMint(lelantus::PublicCoin const & pubCoin, CMintedCoinInfo const & coinInfo, const uint256& tag) {
+void CLelantusState::Containers::AddMint(lelantus::PublicCoin const & pubCoin, CMintedCoinInfo const & coinInfo) {
     mintedPubCoins.insert(std::make_pair(pubCoin, coinInfo));
-    tagToPublicCoin.insert(std::make_pair(tag, pubCoin));
+    tagToPublicCoin.insert(std::make_pair(coinInfo.tag, pubCoin));
     mintMetaInfo[coinInfo.coinGroupId] += 1;
     CheckSurgeCondition();
 }
@@ -1025,11 +1021,10 @@ void CLelantusState::Containers::AddMint(lelantus::PublicCoin const & pubCoin, C
 void CLelantusState::Containers::RemoveMint(lelantus::PublicCoin const & pubCoin) {
     mint_info_container::const_iterator iter = mintedPubCoins.find(pubCoin);
     if (iter != mintedPubCoins.end()) {
-        for(auto hashPair =  tagToPublicCoin.begin(); hashPair !=  tagToPublicCoin.end(); hashPair++)
-            if(hashPair->second == pubCoin) {
-                tagToPublicCoin.erase(hashPair);
-                break;
-            }
+        // the tag may be shared with other coins (coins minted without one), only the entry of this coin goes
+        auto tagIter = tagToPublicCoin.find(iter->second.tag);
+        if (tagIter != tagToPublicCoin.end() && tagIter->second == pubCoin)
+            tagToPublicCoin.erase(tagIter);
 
         mintMetaInfo[iter->second.coinGroupId] -= 1;
         mintedPubCoins.erase(iter);
@@ -1185,7 +1180,7 @@ void CLelantusState::AddMintsToStateAndBlockIndex(
     }
 
     for (const auto& mint : blockMints) {
-        containers.AddMint(mint.first, CMintedCoinInfo::make(latestCoinId, index->nHeight), mint.second);
+        containers.AddMint(mint.first, CMintedCoinInfo::make(latestCoinId, index->nHeight, mint.second));
 
         LogPrintf("AddMintsToStateAndBlockIndex: Lelantus mint added id=%d\n", latestCoinId);
         index->lelantusMintedPubCoins[latestCoinId].push_back(mint);
@@ -1220,7 +1215,7 @@ void CLelantusState::AddBlock(CBlockIndex *index) {
 
         latestCoinId = pubCoins.first;
         for (auto const &coin : pubCoins.second) {
-            containers.AddMint(coin.first, CMintedCoinInfo::make(pubCoins.first, index->nHeight), coin.second);
+            containers.AddMint(coin.first, CMintedCoinInfo::make(pubCoins.first, index->nHeight, coin.second));
         }
     }
 
@@ -1266,6 +1261,7 @@ void CLelantusState::RemoveBlock(CBlockIndex *index) {
         if ((!isExtended && coinGroup.nCoins == 0) || (isExtended && isEdgedBlock)) {
             // all the coins of this group have been erased, remove the group altogether
             coinGroups.erase(coins.first);
+            RemoveCachedAnonymitySets(coins.first, nullptr);
             // decrease pubcoin id
             latestCoinId--;
             // erase from containers
@@ -1299,6 +1295,10 @@ void CLelantusState::RemoveBlock(CBlockIndex *index) {
     for (auto const &serial : index->lelantusSpentSerials) {
         containers.RemoveSpend(serial.first);
     }
+
+    // forget anonymity sets ending at this block
+    uint256 blockHash = index->GetBlockHash();
+    RemoveCachedAnonymitySets(0, &blockHash);
 }
 
 bool CLelantusState::GetCoinGroupInfo(
@@ -1357,7 +1357,27 @@ int CLelantusState::GetCoinSetForSpend(
     std::vector<lelantus::PublicCoin>& coins_out,
     std::vector<unsigned char>& setHash_out) {
 
+    AnonymitySetPtr anonymitySet;
+    int nMintedCoins = GetCoinSetForSpend(chain, maxHeight, coinGroupID, blockHash_out, anonymitySet, setHash_out);
+
     coins_out.clear();
+    if (anonymitySet) {
+        auto coins = anonymitySet->coins();
+        coins_out.assign(coins.begin(), coins.end());
+    }
+
+    return nMintedCoins;
+}
+
+int CLelantusState::GetCoinSetForSpend(
+    CChain *chain,
+    int maxHeight,
+    int coinGroupID,
+    uint256& blockHash_out,
+    AnonymitySetPtr& anonymitySet_out,
+    std::vector<unsigned char>& setHash_out) {
+
+    anonymitySet_out.reset();
 
     if (coinGroups.count(coinGroupID) == 0) {
         return 0;
@@ -1365,102 +1385,187 @@ int CLelantusState::GetCoinSetForSpend(
 
     LelantusCoinGroupInfo &coinGroup = coinGroups[coinGroupID];
 
-    int numberOfCoins = 0;
-    for (CBlockIndex *block = coinGroup.lastBlock;; block = block->pprev) {
-
+    // latest block satisfying given conditions, check coins in group coinGroupID - 1
+    // in the case that using coins from prev group.
+    CBlockIndex *last = coinGroup.lastBlock;
+    int id = 0;
+    for (;; last = last->pprev) {
         // ignore block heigher than max height
-        if (block->nHeight > maxHeight) {
-            continue;
+        if (last->nHeight <= maxHeight) {
+            if (CountCoinInBlock(last, coinGroupID)) {
+                id = coinGroupID;
+            } else if (CountCoinInBlock(last, coinGroupID - 1)) {
+                id = coinGroupID - 1;
+            }
         }
 
-        // check coins in group coinGroupID - 1 in the case that using coins from prev group.
-        int id = 0;
-        if (CountCoinInBlock(block, coinGroupID)) {
-            id = coinGroupID;
-        } else if (CountCoinInBlock(block, coinGroupID - 1)) {
-            id = coinGroupID - 1;
+        if (id || last == coinGroup.firstBlock) {
+            break;
         }
+    }
 
-        if (id) {
-            if (numberOfCoins == 0) {
-                // latest block satisfying given conditions
-                // remember block hash and set hash
-                blockHash_out = block->GetBlockHash();
-                setHash_out =  GetAnonymitySetHash(block, id);
-            }
-            numberOfCoins += block->lelantusMintedPubCoins[id].size();
-            if (block->lelantusMintedPubCoins.count(id) > 0) {
-                for (const auto &coin : block->lelantusMintedPubCoins[id]) {
-                    LOCK(cs_main);
-                    // skip mints from blacklist if nLelantusFixesStartBlock is passed
-                    if (chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock) {
-                        if (::Params().GetConsensus().lelantusBlacklist.count(coin.first.getValue()) > 0) {
-                            continue;
-                        }
-                    }
-                    coins_out.push_back(coin.first);
-                }
-            }
-        }
+    if (!id) {
+        return 0;
+    }
 
-        if (block == coinGroup.firstBlock) {
-            break ;
-        }
+    // remember block hash and set hash
+    blockHash_out = last->GetBlockHash();
+    setHash_out = GetAnonymitySetHash(last, id);
+
+    bool fSkipBlacklisted;
+    {
+        LOCK(cs_main);
+        // skip mints from blacklist if nLelantusFixesStartBlock is passed
+        fSkipBlacklisted = chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock;
     }
 
-    return numberOfCoins;
+    anonymitySet_out = GetAnonymitySetSnapshot(coinGroupID, last, true, fSkipBlacklisted);
+
+    return anonymitySet_out->nMintedCoins;
 }
 
-void CLelantusState::GetAnonymitySet(
+AnonymitySetPtr CLelantusState::GetAnonymitySet(
         int coinGroupID,
         bool fStartLelantusBlacklist,
-        std::vector<lelantus::PublicCoin>& coins_out) {
-
-    coins_out.clear();
+        bool fUpToLastBlock) {
 
     if (coinGroups.count(coinGroupID) == 0) {
-        return;
+        return std::make_shared<AnonymitySetSnapshot>();
     }
 
     LelantusCoinGroupInfo &coinGroup = coinGroups[coinGroupID];
     auto params = ::Params().GetConsensus();
     LOCK(cs_main);
+
+    if (fUpToLastBlock) {
+        // same snapshot as in CheckLelantusJoinSplitTransaction
+        bool fSkipBlacklisted = chainActive.Height() >= params.nLelantusFixesStartBlock;
+        return GetAnonymitySetSnapshot(coinGroupID, coinGroup.lastBlock, false, fSkipBlacklisted);
+    }
+
     int maxHeight = fStartLelantusBlacklist ? (chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1)) : (params.nLelantusFixesStartBlock - 1);
 
-    for (CBlockIndex *block = coinGroup.lastBlock;; block = block->pprev) {
+    // ignore blocks heigher than max height
+    CBlockIndex *last = coinGroup.lastBlock;
+    while (last != coinGroup.firstBlock && last->nHeight > maxHeight)
+        last = last->pprev;
 
-        // ignore block heigher than max height
-        if (block->nHeight > maxHeight) {
-            continue;
+    if (last->nHeight > maxHeight) {
+        return std::make_shared<AnonymitySetSnapshot>();
+    }
+
+    bool fSkipBlacklisted = fStartLelantusBlacklist && chainActive.Height() >= params.nLelantusFixesStartBlock;
+    return GetAnonymitySetSnapshot(coinGroupID, last, true, fSkipBlacklisted);
+}
+
+AnonymitySetSnapshot::AnonymitySetSnapshot(std::vector<lelantus::PublicCoin>&& coins)
+    : buffer(std::make_shared<Buffer>(0)), offset(0), nCoins(coins.size()), nMintedCoins(coins.size()) {
+    buffer->coins = std::move(coins);
+}
+
+AnonymitySetPtr CLelantusState::GetAnonymitySetSnapshot(
+        int coinGroupID,
+        CBlockIndex *last,
+        bool fExtendFromPrevGroup,
+        bool fSkipBlacklisted) {
+
+    auto result = std::make_shared<AnonymitySetSnapshot>();
+
+    if (coinGroups.count(coinGroupID) == 0) {
+        return result;
+    }
+
+    LelantusCoinGroupInfo &coinGroup = coinGroups[coinGroupID];
+    auto const &blacklist = ::Params().GetConsensus().lelantusBlacklist;
+
+    LOCK(cs_anonymitySetCache);
+
+    auto it = anonymitySetCache.find(std::make_tuple(coinGroupID, last->GetBlockHash(), fExtendFromPrevGroup, fSkipBlacklisted));
+    if (it != anonymitySetCache.end()) {
+        return it->second.second;
+    }
+
+    // coins of the blocks above the nearest cached snapshot, the rest of the set is taken from it
+    std::vector<lelantus::PublicCoin> newCoins;
+    AnonymitySetPtr older;
+    for (CBlockIndex *block = last;; block = block->pprev) {
+        if (block != last) {
+            auto cached = anonymitySetCache.find(std::make_tuple(coinGroupID, block->GetBlockHash(), fExtendFromPrevGroup, fSkipBlacklisted));
+            if (cached != anonymitySetCache.end()) {
+                older = cached->second.second;
+                break;
+            }
         }
 
-        // check coins in group coinGroupID - 1 in the case that using coins from prev group.
         int id = 0;
         if (CountCoinInBlock(block, coinGroupID)) {
             id = coinGroupID;
-        } else if (CountCoinInBlock(block, coinGroupID - 1)) {
+        } else if (fExtendFromPrevGroup && CountCoinInBlock(block, coinGroupID - 1)) {
             id = coinGroupID - 1;
         }
 
         if (id) {
-            if(block->lelantusMintedPubCoins.count(id) > 0) {
-                for (const auto &coin : block->lelantusMintedPubCoins[id]) {
-                    if (fStartLelantusBlacklist &&
-                        chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock) {
-                        std::vector<unsigned char> vch = coin.first.getValue().getvch();
-                        if (::Params().GetConsensus().lelantusBlacklist.count(coin.first.getValue()) > 0) {
-                            continue;
-                        }
-                    }
-                    coins_out.push_back(coin.first);
+            auto const &mints = block->lelantusMintedPubCoins[id];
+            result->nMintedCoins += mints.size();
+            for (const auto &coin : mints) {
+                if (fSkipBlacklisted && blacklist.count(coin.first.getValue()) > 0) {
+                    continue;
                 }
+                newCoins.push_back(coin.first);
             }
         }
 
         if (block == coinGroup.firstBlock) {
-            break ;
+            break;
         }
     }
+
+    result->nCoins = newCoins.size();
+    if (older) {
+        result->nCoins += older->nCoins;
+        result->nMintedCoins += older->nMintedCoins;
+    }
+
+    if (older && older->buffer && older->offset == older->buffer->front && older->offset >= newCoins.size()) {
+        // nothing was put in front of the older snapshot yet, use the free slots there
+        result->buffer = older->buffer;
+        result->offset = older->offset - newCoins.size();
+    } else {
+        // keep as many free slots as there are coins, so growing the set copies each coin O(1) times on average
+        result->buffer = std::make_shared<AnonymitySetSnapshot::Buffer>(2 * result->nCoins);
+        result->offset = result->nCoins;
+        if (older) {
+            auto olderCoins = older->coins();
+            std::copy(olderCoins.begin(), olderCoins.end(), result->buffer->coins.begin() + result->offset + newCoins.size());
+        }
+    }
+    std::move(newCoins.begin(), newCoins.end(), result->buffer->coins.begin() + result->offset);
+    result->buffer->front = result->offset;
+
+    // keep the cache bounded, evict snapshots ending at the lowest blocks first
+    while (anonymitySetCache.size() >= maxCachedAnonymitySets) {
+        auto oldest = anonymitySetCache.begin();
+        for (auto entry = anonymitySetCache.begin(); entry != anonymitySetCache.end(); ++entry) {
+            if (entry->second.first < oldest->second.first)
+                oldest = entry;
+        }
+        anonymitySetCache.erase(oldest);
+    }
+
+    anonymitySetCache[std::make_tuple(coinGroupID, last->GetBlockHash(), fExtendFromPrevGroup, fSkipBlacklisted)] =
+            std::make_pair(last->nHeight, result);
+
+    return result;
+}
+
+void CLelantusState::RemoveCachedAnonymitySets(int coinGroupID, const uint256 *blockHash) {
+    LOCK(cs_anonymitySetCache);
+    for (auto it = anonymitySetCache.begin(); it != anonymitySetCache.end();) {
+        if (blockHash ? std::get<1>(it->first) == *blockHash : std::get<0>(it->first) == coinGroupID)
+            it = anonymitySetCache.erase(it);
+        else
+            ++it;
+    }
 }
 
 std::pair<int, int> CLelantusState::GetMintedCoinHeightAndId(
@@ -1523,6 +1628,9 @@ void CLelantusState::Reset() {
     coinGroups.clear();
     latestCoinId = 0;
     containers.Reset();
+
+    LOCK(cs_anonymitySetCache);
+    anonymitySetCache.clear();
 }
 
 CLelantusState* CLelantusState::GetState() {
@@ -12,7 +12,13 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <functional>
+#include <memory>
+#include <tuple>
 #include "coin_containers.h"
+#include "sync.h"
+
+class CPrivacyProofCheck;
+class CPrivacyStateDB;
 
 namespace lelantus_mintspend { class lelantus_mintspend_test; }
 
@@ -67,7 +73,8 @@ bool CheckLelantusTransaction(
 	bool isCheckWallet,
 	bool fStatefulSigmaCheck,
     sigma::CSigmaTxInfo* sigmaTxInfo,
-	CLelantusTxInfo* lelantusTxInfo);
+	CLelantusTxInfo* lelantusTxInfo,
+	std::vector<CPrivacyProofCheck> *pvProofChecks = NULL);
 
 void DisconnectTipLelantus(CBlock &block, CBlockIndex *pindexDelete);
 
@@ -129,6 +136,38 @@ public:
     void Reset();
 };
 
+/*
+ * Immutable snapshot of an anonymity set, shared between all the users of the same set.
+ * Snapshots of a group share one buffer: the coins of newer blocks go in front of the older
+ * ones, so extending a snapshot by a few blocks doesn't copy the coins already there.
+ */
+struct AnonymitySetSnapshot {
+    struct Buffer {
+        Buffer(size_t size) : coins(size), front(size) {}
+
+        std::vector<lelantus::PublicCoin> coins;
+        // first used slot, the ones before it are free for the newer snapshots
+        size_t front;
+    };
+
+    AnonymitySetSnapshot() : offset(0), nCoins(0), nMintedCoins(0) {}
+    // snapshot owning the coins of a set built outside of the state
+    explicit AnonymitySetSnapshot(std::vector<lelantus::PublicCoin>&& coins);
+
+    // coins in the order they are fed to the proofs, latest block first
+    lelantus::PublicCoinRange coins() const {
+        return buffer ? lelantus::PublicCoinRange(buffer->coins.data() + offset, nCoins) : lelantus::PublicCoinRange();
+    }
+
+    // the coins are at [offset, offset + nCoins) of the buffer, the slots are never written once in a snapshot
+    std::shared_ptr<Buffer> buffer;
+    size_t offset;
+    size_t nCoins;
+    // number of coins minted in the set, including blacklisted ones skipped in coins
+    size_t nMintedCoins;
+};
+typedef std::shared_ptr<const AnonymitySetSnapshot> AnonymitySetPtr;
+
 /*
  * State of minted/spent coins as extracted from the index
  */
@@ -190,10 +229,32 @@ public:
         std::vector<lelantus::PublicCoin>& coins_out,
         std::vector<unsigned char>& setHash_out);
 
-    void GetAnonymitySet(
+    // Same as above, returns the shared snapshot of the set instead of a copy of its coins
+    int GetCoinSetForSpend(
+        CChain *chain,
+        int maxHeight,
+        int id,
+        uint256& blockHash_out,
+        AnonymitySetPtr& anonymitySet_out,
+        std::vector<unsigned char>& setHash_out);
+
+    // Coins minted in the last ZC_MINT_CONFIRMATIONS-1 blocks are left out, unless fUpToLastBlock is set:
+    // then the set is the snapshot up to the last block of the group, the one the spends of the block
+    // being connected are checked against
+    AnonymitySetPtr GetAnonymitySet(
             int coinGroupID,
             bool fStartLelantusBlacklist,
-            std::vector<lelantus::PublicCoin>& coins_out);
+            bool fUpToLastBlock = false);
+
+    // Coins of group coinGroupID minted from the first block of the group up to the block `last`.
+    // If fExtendFromPrevGroup is set, blocks without coins of the group contribute coins of the previous
+    // group (the way an extended group starts). Snapshots are cached by (group id, last block hash) and
+    // a new snapshot only walks the blocks above the nearest cached one
+    AnonymitySetPtr GetAnonymitySetSnapshot(
+            int coinGroupID,
+            CBlockIndex *last,
+            bool fExtendFromPrevGroup,
+            bool fSkipBlacklisted);
 
     // Return height of mint transaction and id of minted coin
     std::pair<int, int> GetMintedCoinHeightAndId(const lelantus::PublicCoin& pubCoin);
@@ -235,6 +296,8 @@ public:
 private:
     size_t CountLastNCoins(int groupId, size_t required, CBlockIndex* &first);
 
+    void RemoveCachedAnonymitySets(int coinGroupID, const uint256 *blockHash);
+
 private:
     // Group Limit
     size_t maxCoinInGroup;
@@ -248,10 +311,19 @@ private:
 
     std::atomic<bool> surgeCondition;
 
+    // Maximum number of anonymity set snapshots kept in the cache, each one can be up to
+    // ZC_LELANTUS_MAX_MINT_NUM coins
+    static const size_t maxCachedAnonymitySets = 16;
+
+    // (group id, last block hash, fExtendFromPrevGroup, fSkipBlacklisted) mapped to (last block height, snapshot)
+    typedef std::tuple<int, uint256, bool, bool> AnonymitySetKey;
+    CCriticalSection cs_anonymitySetCache;
+    std::map<AnonymitySetKey, std::pair<int, AnonymitySetPtr>> anonymitySetCache;
+
     struct Containers {
         Containers(std::atomic<bool> & surgeCondition);
 
-        void AddMint(lelantus::PublicCoin const & pubCoin, CMintedCoinInfo const & coinInfo, const uint256& tag);
+        void AddMint(lelantus::PublicCoin const & pubCoin, CMintedCoinInfo const & coinInfo);
         void RemoveMint(lelantus::PublicCoin const & pubCoin);
 
         void AddSpend(Scalar const & serial, int coinGroupId);
@@ -284,11 +356,13 @@ private:
         void CheckSurgeCondition();
 
         friend class lelantus_mintspend::lelantus_mintspend_test;
+        friend class ::CPrivacyStateDB;
     };
 
     Containers containers;
 
     friend class lelantus_mintspend::lelantus_mintspend_test;
+    friend class ::CPrivacyStateDB;
 };
 
 } // end of namespace lelantus
@@ -41,6 +41,27 @@ private:
     GroupElement value;
 };
 
+// Consecutive public coins owned by someone else, lets an anonymity set shared
+// between several transactions be verified without copying it
+class PublicCoinRange {
+public:
+    PublicCoinRange() : first(nullptr), count(0) {}
+
+    PublicCoinRange(const PublicCoin* first_, std::size_t count_) : first(first_), count(count_) {}
+
+    PublicCoinRange(const std::vector<PublicCoin>& coins) : first(coins.data()), count(coins.size()) {}
+
+    const PublicCoin* begin() const { return first; }
+    const PublicCoin* end() const { return first + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const PublicCoin& operator[](std::size_t i) const { return first[i]; }
+
+private:
+    const PublicCoin* first;
+    std::size_t count;
+};
+
 class PrivateCoin {
 public:
 
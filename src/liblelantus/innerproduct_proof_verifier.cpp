@@ -7,12 +7,14 @@ InnerProductProofVerifier::InnerProductProofVerifier(
         const std::vector<GroupElement>& h,
         const GroupElement& u,
         const GroupElement& P,
-        int version)
+        int version,
+        const FixedBaseMultiExponent* gh_multiexp)
         : g_(g)
         , h_(h)
         , u_(u)
         , P_(P)
         , version_(version)
+        , gh_multiexp_(gh_multiexp)
 {
 }
 
@@ -106,13 +108,25 @@ bool InnerProductProofVerifier::verify_fast_util(
         s_inv[i] = x_i.inverse();
     }
 
-    secp_primitives::MultiExponent g_mult(g_, s);
-    secp_primitives::MultiExponent h_mult(h_, s_inv);
-    GroupElement g = g_mult.get_multiple();
-    GroupElement h = h_mult.get_multiple();
-
     GroupElement left;
-    left += g * proof.a_ +  h * proof.b_ + u_ * (proof.a_ * proof.b_);
+    std::size_t max_n = gh_multiexp_ ? gh_multiexp_->size() / 2 : 0;
+    if (n <= max_n) {
+        // g^a * h^b is computed directly from the precomputed generators
+        std::vector<Scalar> gh_exponents(max_n + n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            gh_exponents[i] = s[i] * proof.a_;
+            gh_exponents[max_n + i] = s_inv[i] * proof.b_;
+        }
+        left = gh_multiexp_->get_multiple(gh_exponents, {u_}, {proof.a_ * proof.b_});
+    } else {
+        secp_primitives::MultiExponent g_mult(g_, s);
+        secp_primitives::MultiExponent h_mult(h_, s_inv);
+        GroupElement g = g_mult.get_multiple();
+        GroupElement h = h_mult.get_multiple();
+
+        left += g * proof.a_ +  h * proof.b_ + u_ * (proof.a_ * proof.b_);
+    }
     GroupElement right = P_;
     GroupElement multi;
     for (std::size_t j = 0; j < log_n; ++j)
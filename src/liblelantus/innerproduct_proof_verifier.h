@@ -10,12 +10,15 @@ class InnerProductProofVerifier {
 
 public:
     //g and h are being kept by reference, be sure it will not be modified from outside
+    //gh_multiexp, if given, is a precomputed multi-exponentiation over g followed by h,
+    //both extended to the same maximal size, it is used by verify_fast
     InnerProductProofVerifier(
             const std::vector<GroupElement>& g,
             const std::vector<GroupElement>& h,
             const GroupElement& u,
             const GroupElement& P,
-            int version); // if(version >= 2) we should pass CHash256 in verify
+            int version, // if(version >= 2) we should pass CHash256 in verify
+            const FixedBaseMultiExponent* gh_multiexp = nullptr);
 
     bool verify(const Scalar& x, const InnerProductProof& proof, std::unique_ptr<ChallengeGenerator>& challengeGenerator);
     bool verify_fast(uint64_t n, const Scalar& x, const InnerProductProof& proof, std::unique_ptr<ChallengeGenerator>& challengeGenerator);
@@ -35,6 +38,7 @@ private:
     GroupElement u_;
     GroupElement P_;
     int version_;
+    const FixedBaseMultiExponent* gh_multiexp_;
 
 };
 
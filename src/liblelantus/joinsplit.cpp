@@ -16,7 +16,9 @@ JoinSplit::JoinSplit(const Params *p,
              uint64_t fee,
              const std::map<uint32_t, uint256>& groupBlockHashes,
              const uint256& txHash,
-             unsigned int nVersion)
+             unsigned int nVersion,
+             std::size_t nProverThreads,
+             const std::map<uint32_t, std::shared_ptr<const FixedBaseMultiExponent>>& precomputedSets)
         :
         params (p),
         fee (fee),
@@ -50,7 +52,7 @@ JoinSplit::JoinSplit(const Params *p,
     // generate public keys here, as we need it for challenge generation starting from LELANTUS_TX_VERSION_4_5
     generatePubKeys(Cin);
 
-    LelantusProver prover(p, version);
+    LelantusProver prover(p, version, nProverThreads, precomputedSets);
     prover.proof(anonymity_sets, anonymity_set_hashes, uint64_t(0), Cin, indexes, ecdsaPubkeys, Vout, Cout, fee, lelantusProof, qkSchnorrProof);
 
     if(groupBlockHashes.size() != anonymity_sets.size())
@@ -126,6 +128,20 @@ bool JoinSplit::Verify(
         uint64_t Vout,
         const uint256& txHash,
         Scalar& challenge,
+        bool fSkipVerification) const {
+    std::map<uint32_t, PublicCoinRange> ranges;
+    for (const auto& set : anonymity_sets)
+        ranges.emplace(set.first, set.second);
+    return Verify(ranges, anonymity_set_hashes, Cout, Vout, txHash, challenge, fSkipVerification);
+}
+
+bool JoinSplit::Verify(
+        const std::map<uint32_t, PublicCoinRange>& anonymity_sets,
+        const std::vector<std::vector<unsigned char>>& anonymity_set_hashes,
+        const std::vector<PublicCoin>& Cout,
+        uint64_t Vout,
+        const uint256& txHash,
+        Scalar& challenge,
         bool fSkipVerification ) const {
     std::map<uint32_t, uint256> groupBlockHashes;
 
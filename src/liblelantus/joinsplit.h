@@ -24,7 +24,9 @@ public:
               uint64_t fee,
               const std::map<uint32_t, uint256>& groupBlockHashes,
               const uint256& txHash,
-              unsigned int nVersion);
+              unsigned int nVersion,
+              std::size_t nProverThreads = 1,
+              const std::map<uint32_t, std::shared_ptr<const FixedBaseMultiExponent>>& precomputedSets = {});
 
     bool Verify(const std::map<uint32_t, std::vector<PublicCoin>>& anonymity_sets,
                 const std::vector<std::vector<unsigned char>>& anonymity_set_hashes,
@@ -40,6 +42,15 @@ public:
                 Scalar& challenge,
                 bool fSkipVerification = false) const;
 
+    // same as above, with the anonymity sets kept by the caller
+    bool Verify(const std::map<uint32_t, PublicCoinRange>& anonymity_sets,
+                const std::vector<std::vector<unsigned char>>& anonymity_set_hashes,
+                const std::vector<PublicCoin>& Cout,
+                uint64_t Vout,
+                const uint256& txHash,
+                Scalar& challenge,
+                bool fSkipVerification = false) const;
+
     void generatePubKeys(const std::vector<std::pair<PrivateCoin, uint32_t>>& Cin);
 
     void signMetaData(const std::vector<std::pair<PrivateCoin, uint32_t>>& Cin, const SpendMetaData& m, size_t coutSize);
@@ -4,6 +4,7 @@
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
 #include <secp256k1/include/MultiExponent.h>
+#include <secp256k1/include/FixedBaseMultiExponent.h>
 #include "sigmaextended_proof.h"
 #include "lelantus_proof.h"
 #include "schnorr_proof.h"
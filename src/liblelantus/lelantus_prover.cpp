@@ -1,8 +1,24 @@
 #include "lelantus_prover.h"
+#include "ctpl.h"
+
+#include <future>
 
 namespace lelantus {
 
-LelantusProver::LelantusProver(const Params* p, unsigned int v) : params(p), version(v) {
+namespace {
+
+// Waits for all the tasks before rethrowing the first failure, as they refer to the caller's locals.
+void wait_all(std::vector<std::future<void>>& tasks) {
+    for (auto& task : tasks)
+        task.wait();
+    for (auto& task : tasks)
+        task.get();
+}
+
+}
+
+LelantusProver::LelantusProver(const Params* p, unsigned int v, std::size_t nThreads_, const PrecomputedSets& precomputedSets_)
+        : params(p), version(v), nThreads(std::max(nThreads_, std::size_t(1))), precomputedSets(precomputedSets_) {
 }
 
 void LelantusProver::proof(
@@ -34,9 +50,27 @@ void LelantusProver::proof(
     Yk_sum.resize(Cin.size());
     // we are passing challengeGenerator ptr here, as after LELANTUS_TX_VERSION_4_5 we need  it back, with filled data, to use in schnorr proof,
     std::unique_ptr<ChallengeGenerator> challengeGenerator;
-    generate_sigma_proofs(anonymity_sets, anonymity_set_hashes, Cin, Cout, indexes, ecdsaPubkeys, x, challengeGenerator, Yk_sum, proof_out.sigma_proofs, qkSchnorrProof);
 
-    generate_bulletproofs(Cout, proof_out.bulletproofs);
+    // The range proof doesn't depend on the Sigma proofs, so it's built next to them
+    std::unique_ptr<ctpl::thread_pool> pool;
+    std::future<void> bulletproofsTask;
+    if (nThreads > 1) {
+        pool.reset(new ctpl::thread_pool(std::min(nThreads, Cin.size() + 1)));
+        bulletproofsTask = pool->push([&](int) { generate_bulletproofs(Cout, proof_out.bulletproofs); });
+    }
+
+    try {
+        generate_sigma_proofs(anonymity_sets, anonymity_set_hashes, Cin, Cout, indexes, ecdsaPubkeys, pool.get(), x, challengeGenerator, Yk_sum, proof_out.sigma_proofs, qkSchnorrProof);
+    } catch (...) {
+        if (bulletproofsTask.valid())
+            bulletproofsTask.wait();
+        throw;
+    }
+
+    if (bulletproofsTask.valid())
+        bulletproofsTask.get();
+    else
+        generate_bulletproofs(Cout, proof_out.bulletproofs);
 
     Scalar x_m = x.exponent(params->get_sigma_m());
 
@@ -78,6 +112,7 @@ void LelantusProver::generate_sigma_proofs(
         const std::vector<PrivateCoin>& Cout,
         const std::vector<size_t>& indexes,
         const std::vector<std::vector<unsigned char>>& ecdsaPubkeys,
+        ctpl::thread_pool* pool,
         Scalar& x,
         std::unique_ptr<ChallengeGenerator>& challengeGenerator,
         std::vector<Scalar>& Yk_sum,
@@ -101,22 +136,23 @@ void LelantusProver::generate_sigma_proofs(
     a.resize(N);
     std::vector<Scalar> serialNumbers;
     serialNumbers.reserve(N);
+    if (indexes.size() != N)
+        throw std::invalid_argument("Number of indexes doesn't match the number of inputs");
     for (std::size_t i = 0; i < N; ++i)
     {
         if (!c.count(Cin[i].second))
             throw std::invalid_argument("No such anonymity set or id is not correct");
-
-        GroupElement gs = (params->get_g() * Cin[i].first.getSerialNumber().negate());
         serialNumbers.emplace_back(Cin[i].first.getSerialNumber());
-        std::vector<GroupElement> C_;
-        C_.reserve(c.size());
+    }
 
+    // The commitments of the inputs are independent, each one only writes its own slots.
+    // The challenge is generated from all of them afterwards, in input order.
+    auto commit = [&](std::size_t i) {
         const auto& set = c.find(Cin[i].second);
-        if (set == c.end())
-            throw std::invalid_argument("No such anonymity set");
+        if (indexes[i] >= set->second.size())
+            throw std::invalid_argument("Index of the input is outside of its anonymity set");
 
-        for (auto const &coin : set->second)
-            C_.emplace_back(coin.getValue() + gs);
+        GroupElement gs = (params->get_g() * Cin[i].first.getSerialNumber().negate());
 
         rA[i].randomize();
         rB[i].randomize();
@@ -126,7 +162,30 @@ void LelantusProver::generate_sigma_proofs(
         Pk[i].resize(params->get_sigma_m());
         Yk[i].resize(params->get_sigma_m());
         a[i].resize(params->get_sigma_n() * params->get_sigma_m());
+
+        auto precomputed = precomputedSets.find(Cin[i].second);
+        if (precomputed != precomputedSets.end() && precomputed->second && precomputed->second->size() == set->second.size()) {
+            sigmaProver.sigma_commit(*precomputed->second, gs, indexes[i], rA[i], rB[i], rC[i], rD[i], a[i], Tk[i], Pk[i], Yk[i], sigma[i], sigma_proofs[i]);
+            return;
+        }
+
+        std::vector<GroupElement> C_;
+        C_.reserve(set->second.size());
+        for (auto const &coin : set->second)
+            C_.emplace_back(coin.getValue() + gs);
+
         sigmaProver.sigma_commit(C_, indexes[i], rA[i], rB[i], rC[i], rD[i], a[i], Tk[i], Pk[i], Yk[i], sigma[i], sigma_proofs[i]);
+    };
+
+    if (pool && N > 1) {
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(N);
+        for (std::size_t i = 0; i < N; ++i)
+            tasks.emplace_back(pool->push([&commit, i](int) { commit(i); }));
+        wait_all(tasks);
+    } else {
+        for (std::size_t i = 0; i < N; ++i)
+            commit(i);
     }
 
     std::vector<GroupElement> PubcoinsOut;
@@ -6,11 +6,21 @@
 #include "range_prover.h"
 #include "coin.h"
 
+namespace ctpl {
+class thread_pool;
+}
+
 namespace lelantus {
 
 class LelantusProver {
 public:
-    LelantusProver(const Params* p, unsigned int v);
+    // Multi-exponentiation precomputations over anonymity sets, by group id. Meant to be
+    // kept by the caller across all the spends from the same set.
+    typedef std::map<uint32_t, std::shared_ptr<const FixedBaseMultiExponent>> PrecomputedSets;
+
+    // With nThreads > 1 the Sigma commitments of the inputs and the range proof are
+    // generated concurrently. The resulting proof doesn't depend on the number of threads.
+    LelantusProver(const Params* p, unsigned int v, std::size_t nThreads = 1, const PrecomputedSets& precomputedSets = PrecomputedSets());
     void proof(
             const std::map<uint32_t, std::vector<PublicCoin>>& anonymity_sets,
             const std::vector<std::vector<unsigned char>>& anonymity_set_hashes,
@@ -32,6 +42,7 @@ private:
             const std::vector<PrivateCoin>& Cout,
             const std::vector<size_t>& indexes,
             const std::vector<std::vector<unsigned char>>& ecdsaPubkeys,
+            ctpl::thread_pool* pool,
             Scalar& x,
             std::unique_ptr<ChallengeGenerator>& challengeGenerator,
             std::vector<Scalar>& Yk_sum,
@@ -45,6 +56,8 @@ private:
 private:
     const Params* params;
     unsigned int version;
+    std::size_t nThreads;
+    PrecomputedSets precomputedSets;
 };
 }// namespace lelantus
 
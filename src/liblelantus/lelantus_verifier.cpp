@@ -20,13 +20,16 @@ bool LelantusVerifier::verify(
         const std::vector<PublicCoin>& Cout,
         const LelantusProof& proof,
         const SchnorrProof& qkSchnorrProof) {
+    std::map<uint32_t, PublicCoinRange> ranges;
+    for (const auto& set : anonymity_sets)
+        ranges.emplace(set.first, set.second);
     Scalar x;
     bool fSkipVerification = 0;
-    return verify(anonymity_sets, anonymity_set_hashes, serialNumbers, ecdsaPubkeys, groupIds, Vin, Vout, fee, Cout, proof, qkSchnorrProof, x, fSkipVerification);
+    return verify(ranges, anonymity_set_hashes, serialNumbers, ecdsaPubkeys, groupIds, Vin, Vout, fee, Cout, proof, qkSchnorrProof, x, fSkipVerification);
 }
 
 bool LelantusVerifier::verify(
-        const std::map<uint32_t, std::vector<PublicCoin>>& anonymity_sets,
+        const std::map<uint32_t, PublicCoinRange>& anonymity_sets,
         const std::vector<std::vector<unsigned char>>& anonymity_set_hashes,
         const std::vector<Scalar>& serialNumbers,
         const std::vector<std::vector<unsigned char>>& ecdsaPubkeys,
@@ -57,7 +60,7 @@ bool LelantusVerifier::verify(
         return false;
     }
 
-    std::vector<std::vector<PublicCoin>> vAnonymity_sets;
+    std::vector<PublicCoinRange> vAnonymity_sets;
     std::vector<std::vector<Scalar>> vSin;
     vAnonymity_sets.reserve(anonymity_sets.size());
     vSin.resize(anonymity_sets.size());
@@ -78,7 +81,7 @@ bool LelantusVerifier::verify(
     try {
         // we are passing challengeGenerator ptr here, as after LELANTUS_TX_VERSION_4_5 we need  it back, with filled data, to use in schnorr proof,
         if (!(verify_sigma(vAnonymity_sets, anonymity_set_hashes, vSin, serialNumbers, ecdsaPubkeys, Cout, proof.sigma_proofs, qkSchnorrProof, x, challengeGenerator, zV, zR, fSkipVerification) &&
-             verify_rangeproof(Cout, proof.bulletproofs) &&
+             (fSkipVerification || verify_rangeproof(Cout, proof.bulletproofs)) &&
              verify_schnorrproof(x, zV, zR, Vin, Vout, fee, Cout, proof, challengeGenerator)))
             return false;
     } catch (std::invalid_argument&) {
@@ -89,7 +92,7 @@ bool LelantusVerifier::verify(
 }
 
 bool LelantusVerifier::verify_sigma(
-        const std::vector<std::vector<PublicCoin>>& anonymity_sets,
+        const std::vector<PublicCoinRange>& anonymity_sets,
         const std::vector<std::vector<unsigned char>>& anonymity_set_hashes,
         const std::vector<std::vector<Scalar>>& Sin,
         const std::vector<Scalar>& serialNumbers,
@@ -118,7 +121,7 @@ bool LelantusVerifier::verify_sigma(
             x);
 
     SigmaExtendedVerifier sigmaVerifier(params->get_g(), params->get_sigma_h(), params->get_sigma_n(),
-                                                          params->get_sigma_m());
+                                                          params->get_sigma_m(), &params->get_sigma_h_multiexp());
 
     if (Sin.size() != anonymity_sets.size())
         throw std::invalid_argument("Number of anonymity sets and number of vectors containing serial numbers must be equal");
@@ -179,27 +182,17 @@ bool LelantusVerifier::verify_sigma(
     return true;
 }
 
-bool LelantusVerifier::verify_rangeproof(
+void LelantusVerifier::get_rangeproof_values(
         const std::vector<PublicCoin>& Cout,
-        const RangeProof& bulletproofs) {
-    if (Cout.empty())
-        return true;
-
-    std::size_t n = params->get_bulletproofs_n();
+        std::vector<GroupElement>& V,
+        std::vector<GroupElement>& commitments) {
     std::size_t m = Cout.size() * 2;
 
     while (m & (m - 1))
         m++;
 
-    std::vector<GroupElement> g_, h_;
-    g_.reserve(n * m);
-    h_.reserve(n * m);
-    g_.insert(g_.end(), params->get_bulletproofs_g().begin(), params->get_bulletproofs_g().begin() + (n * m));
-    h_.insert(h_.end(), params->get_bulletproofs_h().begin(), params->get_bulletproofs_h().begin() + (n * m));
-
-    std::vector<GroupElement> V;
     V.reserve(m);
-    std::vector<GroupElement> commitments(Cout.size());
+    commitments.resize(Cout.size());
     for (std::size_t i = 0; i < Cout.size(); ++i) {
         V.push_back(Cout[i].getValue());
         V.push_back(Cout[i].getValue() + params->get_h1_limit_range());
@@ -208,8 +201,26 @@ bool LelantusVerifier::verify_rangeproof(
 
     for (std::size_t i = Cout.size() * 2; i < m; ++i)
         V.push_back(GroupElement());
+}
+
+bool LelantusVerifier::verify_rangeproof(
+        const std::vector<PublicCoin>& Cout,
+        const RangeProof& bulletproofs) {
+    if (Cout.empty())
+        return true;
+
+    std::size_t n = params->get_bulletproofs_n();
+    std::vector<GroupElement> V, commitments;
+    get_rangeproof_values(Cout, V, commitments);
+    std::size_t m = V.size();
 
-    RangeVerifier  rangeVerifier(params->get_h1(), params->get_h0(), params->get_g(), g_, h_, n, version);
+    std::vector<GroupElement> g_, h_;
+    g_.reserve(n * m);
+    h_.reserve(n * m);
+    g_.insert(g_.end(), params->get_bulletproofs_g().begin(), params->get_bulletproofs_g().begin() + (n * m));
+    h_.insert(h_.end(), params->get_bulletproofs_h().begin(), params->get_bulletproofs_h().begin() + (n * m));
+
+    RangeVerifier  rangeVerifier(params->get_h1(), params->get_h0(), params->get_g(), g_, h_, n, version, &params->get_bulletproofs_multiexp());
     if (!rangeVerifier.verify_batch(V, commitments, bulletproofs)) {
         LogPrintf("Lelantus verification failed due range proof verification failed.");
         return false;
@@ -217,6 +228,39 @@ bool LelantusVerifier::verify_rangeproof(
     return true;
 }
 
+bool LelantusVerifier::verify_rangeproofs(
+        const std::vector<const std::vector<PublicCoin>*>& Couts,
+        const std::vector<const RangeProof*>& bulletproofs) {
+    if (Couts.size() != bulletproofs.size())
+        return false;
+
+    // all the proofs are over prefixes of the precomputed generators, so the verifier never needs the vectors
+    RangeVerifier rangeVerifier(params->get_h1(), params->get_h0(), params->get_g(), params->get_bulletproofs_g(),
+                                params->get_bulletproofs_h(), params->get_bulletproofs_n(), version, &params->get_bulletproofs_multiexp());
+
+    std::vector<Scalar> gh_exponents;
+    std::vector<GroupElement> points;
+    std::vector<Scalar> exponents;
+    for (std::size_t i = 0; i < Couts.size(); ++i) {
+        if (Couts[i]->empty())
+            continue;
+
+        std::vector<GroupElement> V, commitments;
+        get_rangeproof_values(*Couts[i], V, commitments);
+        if (!rangeVerifier.add_to_batch(V, commitments, *bulletproofs[i], gh_exponents, points, exponents))
+            return false;
+    }
+
+    if (points.empty())
+        return true;
+
+    if (!rangeVerifier.verify_added(gh_exponents, points, exponents)) {
+        LogPrintf("Lelantus verification failed due range proof batch verification failed.");
+        return false;
+    }
+    return true;
+}
+
 bool LelantusVerifier::verify_schnorrproof(
         const Scalar& x,
         const Scalar& zV,
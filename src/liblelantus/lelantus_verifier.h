@@ -26,7 +26,7 @@ public:
             const SchnorrProof& qkSchnorrProof);
 
     bool verify(
-            const std::map<uint32_t, std::vector<PublicCoin>>& anonymity_sets,
+            const std::map<uint32_t, PublicCoinRange>& anonymity_sets,
             const std::vector<std::vector<unsigned char>>& anonymity_set_hashes,
             const std::vector<Scalar>& serialNumbers,
             const std::vector<std::vector<unsigned char>>& ecdsaPubkeys,
@@ -40,9 +40,15 @@ public:
             Scalar& x,
             bool fSkipVerification = false);
 
+    // Verifies the range proofs of several transactions, skipped by verify() with fSkipVerification,
+    // with one multi-exponentiation. All of them must be of this verifier's version.
+    bool verify_rangeproofs(
+            const std::vector<const std::vector<PublicCoin>*>& Couts,
+            const std::vector<const RangeProof*>& bulletproofs);
+
 private:
     bool verify_sigma(
-            const std::vector<std::vector<PublicCoin>>& anonymity_sets,
+            const std::vector<PublicCoinRange>& anonymity_sets,
             const std::vector<std::vector<unsigned char>>& anonymity_set_hashes,
             const std::vector<std::vector<Scalar>>& Sin,
             const std::vector<Scalar>& serialNumbers,
@@ -55,6 +61,10 @@ private:
             Scalar& zV,
             Scalar& zR,
             bool fSkipVerification = false);
+    void get_rangeproof_values(
+            const std::vector<PublicCoin>& Cout,
+            std::vector<GroupElement>& V,
+            std::vector<GroupElement>& commitments);
     bool verify_rangeproof(
             const std::vector<PublicCoin>& Cout,
             const RangeProof& bulletproofs);
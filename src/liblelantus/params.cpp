@@ -81,6 +81,11 @@ Params::Params(const GroupElement& g_, int n_sigma_, int m_sigma_, int n_rangePr
 
     limit_range = Scalar(uint64_t(2)).exponent(get_bulletproofs_n()) - ::Params().GetConsensus().nMaxValueLelantusMint;
     h1_limit_range = get_h1() * limit_range;
+
+    h_sigma_multiexp.reset(new FixedBaseMultiExponent(h_sigma));
+    std::vector<GroupElement> gh_rangeProof(g_rangeProof);
+    gh_rangeProof.insert(gh_rangeProof.end(), h_rangeProof.begin(), h_rangeProof.end());
+    gh_rangeProof_multiexp.reset(new FixedBaseMultiExponent(gh_rangeProof));
 }
 
 const GroupElement& Params::get_g() const {
@@ -130,4 +135,12 @@ const GroupElement& Params::get_h1_limit_range() const {
     return h1_limit_range;
 }
 
+const FixedBaseMultiExponent& Params::get_sigma_h_multiexp() const {
+    return *h_sigma_multiexp;
+}
+
+const FixedBaseMultiExponent& Params::get_bulletproofs_multiexp() const {
+    return *gh_rangeProof_multiexp;
+}
+
 } //namespace lelantus
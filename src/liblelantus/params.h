@@ -3,6 +3,7 @@
 
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
+#include <secp256k1/include/FixedBaseMultiExponent.h>
 #include <serialize.h>
 #include <sync.h>
 
@@ -25,6 +26,10 @@ public:
     int get_bulletproofs_max_m() const;
     const Scalar& get_limit_range() const;
     const GroupElement& get_h1_limit_range() const;
+    // precomputed multi-exponentiation over get_sigma_h()
+    const FixedBaseMultiExponent& get_sigma_h_multiexp() const;
+    // precomputed multi-exponentiation over get_bulletproofs_g() followed by get_bulletproofs_h()
+    const FixedBaseMultiExponent& get_bulletproofs_multiexp() const;
 
 private:
     Params(const GroupElement& g_sigma_, int n, int m, int n_rangeProof_, int max_m_rangeProof_);
@@ -46,6 +51,9 @@ private:
     std::vector<GroupElement> h_rangeProof;
     Scalar limit_range;
     GroupElement h1_limit_range;
+
+    std::unique_ptr<FixedBaseMultiExponent> h_sigma_multiexp;
+    std::unique_ptr<FixedBaseMultiExponent> gh_rangeProof_multiexp;
 };
 
 } // namespace lelantus
@@ -10,7 +10,8 @@ RangeVerifier::RangeVerifier(
         const std::vector<GroupElement>& g_vector,
         const std::vector<GroupElement>& h_vector,
         uint64_t n,
-        unsigned int v)
+        unsigned int v,
+        const FixedBaseMultiExponent* gh_multiexp)
         : g (g)
         , h1 (h1)
         , h2 (h2)
@@ -18,9 +19,88 @@ RangeVerifier::RangeVerifier(
         , h_(h_vector)
         , n (n)
         , version (v)
+        , gh_multiexp (gh_multiexp)
 {}
 
 bool RangeVerifier::verify_batch(const std::vector<GroupElement>& V, const std::vector<GroupElement>& commitments, const RangeProof& proof) {
+    uint64_t m = V.size();
+    std::vector<Scalar> l_r;
+    std::vector<GroupElement> points;
+    std::vector<Scalar> exponents;
+    if (!get_check(V, commitments, proof, l_r, points, exponents))
+        return false;
+
+    GroupElement result;
+    std::size_t max_nm = gh_multiexp ? gh_multiexp->size() / 2 : 0;
+    if (n * m <= max_nm) {
+        // the generators g_ and h_ are prefixes of the two halves of precomputed set
+        std::vector<Scalar> gh_exponents(max_nm + n * m);
+        std::copy(l_r.begin(), l_r.begin() + n * m, gh_exponents.begin());
+        std::copy(l_r.begin() + n * m, l_r.end(), gh_exponents.begin() + max_nm);
+        result = gh_multiexp->get_multiple(gh_exponents, points, exponents);
+    } else {
+        points.insert(points.begin(), h_.begin(), h_.end());
+        points.insert(points.begin(), g_.begin(), g_.end());
+        exponents.insert(exponents.begin(), l_r.begin(), l_r.end());
+        secp_primitives::MultiExponent mult(points, exponents);
+        result = mult.get_multiple();
+    }
+
+    //checking whether the result is equal to 1 (in elliptic curve it is infinity)
+    if(!result.isInfinity())
+        return false;
+    return true;
+}
+
+bool RangeVerifier::add_to_batch(
+        const std::vector<GroupElement>& V,
+        const std::vector<GroupElement>& commitments,
+        const RangeProof& proof,
+        std::vector<Scalar>& gh_exponents,
+        std::vector<GroupElement>& points,
+        std::vector<Scalar>& exponents) {
+    uint64_t m = V.size();
+    std::size_t max_nm = gh_multiexp ? gh_multiexp->size() / 2 : 0;
+    if (n * m > max_nm)
+        return false;
+
+    std::vector<Scalar> l_r;
+    std::vector<GroupElement> proofPoints;
+    std::vector<Scalar> proofExponents;
+    if (!get_check(V, commitments, proof, l_r, proofPoints, proofExponents))
+        return false;
+
+    // the check of each proof is multiplied by its own random weight, so invalid proofs can't cancel out
+    Scalar weight;
+    weight.randomize();
+
+    gh_exponents.resize(2 * max_nm);
+    for (std::size_t i = 0; i < n * m; ++i) {
+        gh_exponents[i] += l_r[i] * weight;
+        gh_exponents[max_nm + i] += l_r[n * m + i] * weight;
+    }
+    points.insert(points.end(), proofPoints.begin(), proofPoints.end());
+    for (const auto& exponent : proofExponents)
+        exponents.emplace_back(exponent * weight);
+    return true;
+}
+
+bool RangeVerifier::verify_added(
+        const std::vector<Scalar>& gh_exponents,
+        const std::vector<GroupElement>& points,
+        const std::vector<Scalar>& exponents) const {
+    if (!gh_multiexp)
+        return false;
+    return gh_multiexp->get_multiple(gh_exponents, points, exponents).isInfinity();
+}
+
+bool RangeVerifier::get_check(
+        const std::vector<GroupElement>& V,
+        const std::vector<GroupElement>& commitments,
+        const RangeProof& proof,
+        std::vector<Scalar>& l_r,
+        std::vector<GroupElement>& points,
+        std::vector<Scalar>& exponents) {
     if(!membership_checks(proof))
         return false;
     uint64_t m = V.size();
@@ -89,7 +169,6 @@ bool RangeVerifier::verify_batch(const std::vector<GroupElement>& V, const std::
         z_m.go_next();
     }
 
-    std::vector<Scalar> l_r;
     l_r.resize(n * m * 2);
     NthPower y_n_(y.inverse());
     NthPower z_j(z, z.square());
@@ -132,11 +211,6 @@ bool RangeVerifier::verify_batch(const std::vector<GroupElement>& V, const std::
     Scalar c;
     c.randomize();
 
-    std::vector<GroupElement> points;
-    points.insert(points.end(), g_.begin(), g_.end());
-    points.insert(points.end(), h_.begin(), h_.end());
-    std::vector<Scalar> exponents(l_r);
-
     points.emplace_back(g);
     exponents.emplace_back((innerProductProof.c_ - delta) * c + x_u *  (innerProductProof.a_ * innerProductProof.b_ - innerProductProof.c_));
     points.emplace_back(h1);
@@ -165,12 +239,6 @@ bool RangeVerifier::verify_batch(const std::vector<GroupElement>& V, const std::
     points.insert(points.end(), innerProductProof.L_.begin(), innerProductProof.L_.end());
     points.insert(points.end(), innerProductProof.R_.begin(), innerProductProof.R_.end());
     exponents.insert(exponents.end(), x_j_sq_neg.begin(), x_j_sq_neg.end());
-
-    secp_primitives::MultiExponent mult(points, exponents);
-
-    //checking whether the result is equal to 1 (in elliptic curve it is infinity)
-    if(!mult.get_multiple().isInfinity())
-        return false;
     return true;
 }
 
@@ -8,6 +8,8 @@ namespace lelantus {
 class RangeVerifier {
 public:
     //g_vector and h_vector are being kept by reference, be sure it will not be modified from outside
+    //gh_multiexp, if given, is a precomputed multi-exponentiation over g_vector followed by h_vector,
+    //both extended to the same maximal size, it is kept by pointer too
     RangeVerifier(
             const GroupElement& g
             , const GroupElement& h1
@@ -15,14 +17,40 @@ public:
             , const std::vector<GroupElement>& g_vector
             , const std::vector<GroupElement>& h_vector
             , uint64_t n
-            , unsigned int v);
+            , unsigned int v
+            , const FixedBaseMultiExponent* gh_multiexp = nullptr);
 
     // commitments are included into transcript if version >= LELANTUS_TX_VERSION_4_5
     bool verify_batch(const std::vector<GroupElement>& V, const std::vector<GroupElement>& commitments, const RangeProof& proof);
 
+    // Verification of several proofs, possibly of different verifiers, with one multi-exponentiation:
+    // add_to_batch() adds the check of the proof, weighted randomly, to gh_exponents over the precomputed
+    // generators and to the other points and exponents, verify_added() runs the check of all the added proofs.
+    // add_to_batch() returns false if the proof is malformed or gh_multiexp doesn't cover it.
+    bool add_to_batch(
+            const std::vector<GroupElement>& V,
+            const std::vector<GroupElement>& commitments,
+            const RangeProof& proof,
+            std::vector<Scalar>& gh_exponents,
+            std::vector<GroupElement>& points,
+            std::vector<Scalar>& exponents);
+    bool verify_added(
+            const std::vector<Scalar>& gh_exponents,
+            const std::vector<GroupElement>& points,
+            const std::vector<Scalar>& exponents) const;
+
 private:
     bool membership_checks(const RangeProof& proof);
 
+    // computes the terms of the proof check, which must sum up to infinity, l_r are the exponents of g_ and h_
+    bool get_check(
+            const std::vector<GroupElement>& V,
+            const std::vector<GroupElement>& commitments,
+            const RangeProof& proof,
+            std::vector<Scalar>& l_r,
+            std::vector<GroupElement>& points,
+            std::vector<Scalar>& exponents);
+
 private:
     GroupElement g;
     GroupElement h1;
@@ -31,6 +59,7 @@ private:
     const std::vector<GroupElement>& h_;
     uint64_t n;
     unsigned int version;
+    const FixedBaseMultiExponent* gh_multiexp;
 };
 
 }//namespace lelantus
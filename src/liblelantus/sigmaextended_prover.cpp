@@ -26,7 +26,51 @@ void SigmaExtendedProver::sigma_commit(
         std::vector<Scalar>& Yk,
         std::vector<Scalar>& sigma,
         SigmaExtendedProof& proof_out) {
-    std::size_t setSize = commits.size();
+    auto multiexp = [&commits](const std::vector<Scalar>& P_i) {
+        secp_primitives::MultiExponent mult(commits, P_i);
+        return mult.get_multiple();
+    };
+    sigma_commit(commits.size(), multiexp, l, rA, rB, rC, rD, a, Tk, Pk, Yk, sigma, proof_out);
+}
+
+void SigmaExtendedProver::sigma_commit(
+        const secp_primitives::FixedBaseMultiExponent& set,
+        const GroupElement& offset,
+        int l,
+        const Scalar& rA,
+        const Scalar& rB,
+        const Scalar& rC,
+        const Scalar& rD,
+        std::vector<Scalar>& a,
+        std::vector<Scalar>& Tk,
+        std::vector<Scalar>& Pk,
+        std::vector<Scalar>& Yk,
+        std::vector<Scalar>& sigma,
+        SigmaExtendedProof& proof_out) {
+    // sum(P_i * (set_i + offset)) = sum(P_i * set_i) + sum(P_i) * offset
+    auto multiexp = [&set, &offset](const std::vector<Scalar>& P_i) {
+        Scalar P_sum(uint64_t(0));
+        for (const Scalar& p : P_i)
+            P_sum += p;
+        return set.get_multiple(P_i, {offset}, {P_sum});
+    };
+    sigma_commit(set.size(), multiexp, l, rA, rB, rC, rD, a, Tk, Pk, Yk, sigma, proof_out);
+}
+
+void SigmaExtendedProver::sigma_commit(
+        std::size_t setSize,
+        const CommitmentsMultiExp& multiexp,
+        int l,
+        const Scalar& rA,
+        const Scalar& rB,
+        const Scalar& rC,
+        const Scalar& rD,
+        std::vector<Scalar>& a,
+        std::vector<Scalar>& Tk,
+        std::vector<Scalar>& Pk,
+        std::vector<Scalar>& Yk,
+        std::vector<Scalar>& sigma,
+        SigmaExtendedProof& proof_out) {
     assert(setSize > 0);
     LelantusPrimitives::convert_to_sigma(l, n_, m_, sigma);
     for (std::size_t k = 0; k < m_; ++k)
@@ -142,8 +186,7 @@ void SigmaExtendedProver::sigma_commit(
         for (std::size_t i = 0; i < N; ++i){
             P_i.emplace_back(P_i_k[i][k]);
         }
-        secp_primitives::MultiExponent mult(commits, P_i);
-        GroupElement c_k = mult.get_multiple();
+        GroupElement c_k = multiexp(P_i);
         proof_out.Gk_.emplace_back(c_k + h_[0] * Yk[k].negate());
         proof_out.Qk.emplace_back(LelantusPrimitives::double_commit(g_, Scalar(uint64_t(0)), h_[1], Pk[k], h_[0], Tk[k]) + h_[0] * Yk[k]);
 
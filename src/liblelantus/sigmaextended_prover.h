@@ -3,6 +3,8 @@
 
 #include "lelantus_primitives.h"
 
+#include <functional>
+
 namespace lelantus {
 
 class SigmaExtendedProver{
@@ -25,6 +27,23 @@ public:
             std::vector<Scalar>& sigma,
             SigmaExtendedProof& proof_out);
 
+    // Same as above for commits[i] = set[i] + offset, with the multi-exponentiations
+    // done over the set precomputed once for all the spends from it.
+    void sigma_commit(
+            const secp_primitives::FixedBaseMultiExponent& set,
+            const GroupElement& offset,
+            int l,
+            const Scalar& rA,
+            const Scalar& rB,
+            const Scalar& rC,
+            const Scalar& rD,
+            std::vector<Scalar>& a,
+            std::vector<Scalar>& Tk,
+            std::vector<Scalar>& Pk,
+            std::vector<Scalar>& Yk,
+            std::vector<Scalar>& sigma,
+            SigmaExtendedProof& proof_out);
+
     void sigma_response(
             const std::vector<Scalar>& sigma,
             const std::vector<Scalar>& a,
@@ -40,6 +59,25 @@ public:
             SigmaExtendedProof& proof_out);
 
 
+private:
+    // Returns the sum of the commitments weighted by the given coefficients
+    typedef std::function<GroupElement(const std::vector<Scalar>&)> CommitmentsMultiExp;
+
+    void sigma_commit(
+            std::size_t setSize,
+            const CommitmentsMultiExp& multiexp,
+            int l,
+            const Scalar& rA,
+            const Scalar& rB,
+            const Scalar& rC,
+            const Scalar& rD,
+            std::vector<Scalar>& a,
+            std::vector<Scalar>& Tk,
+            std::vector<Scalar>& Pk,
+            std::vector<Scalar>& Yk,
+            std::vector<Scalar>& sigma,
+            SigmaExtendedProof& proof_out);
+
 private:
     GroupElement g_;
     std::vector<GroupElement> h_;
@@ -7,11 +7,13 @@ SigmaExtendedVerifier::SigmaExtendedVerifier(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         uint64_t n,
-        uint64_t m)
+        uint64_t m,
+        const FixedBaseMultiExponent* h_multiexp)
         : g_(g)
         , h_(h_gens)
         , n(n)
-        , m(m){
+        , m(m)
+        , h_multiexp_(h_multiexp){
 }
 
 bool SigmaExtendedVerifier::batchverify(
@@ -333,6 +335,16 @@ bool SigmaExtendedVerifier::abcd_checks(
     for (std::size_t i = 0; i < f_.size(); i++)
         f_plus_f_prime.emplace_back(f_[i] * c + f_[i] * (x - f_[i]));
 
+    if (h_multiexp_) {
+        // Comm(..) - (B^x * A)^c - C^x * D computed as a single multi-exponentiation, it should be infinity
+        Scalar one(uint64_t(1));
+        GroupElement check = h_multiexp_->get_multiple(
+                f_plus_f_prime,
+                {g_, proof.B_, proof.A_, proof.C_, proof.D_},
+                {proof.ZA_ * c + proof.ZC_, (x * c).negate(), c.negate(), x.negate(), one.negate()});
+        return check.isInfinity();
+    }
+
     GroupElement right;
     LelantusPrimitives::commit(g_, h_, f_plus_f_prime, proof.ZA_ * c + proof.ZC_, right);
     if (((proof.B_ * x + proof.A_) * c + proof.C_ * x + proof.D_) != right)
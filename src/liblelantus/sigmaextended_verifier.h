@@ -8,9 +8,12 @@ namespace lelantus {
 class SigmaExtendedVerifier{
 
 public:
+    // h_multiexp, if given, is a precomputed multi-exponentiation over h_gens,
+    // it is kept by pointer and should outlive the verifier
     SigmaExtendedVerifier(const GroupElement& g,
                       const std::vector<GroupElement>& h_gens,
-                      uint64_t n, uint64_t m_);
+                      uint64_t n, uint64_t m_,
+                      const FixedBaseMultiExponent* h_multiexp = nullptr);
 
     //gets initial double-blinded Pedersen commitments,
     //verifies proofs from single transaction, where set size and challenge are the same
@@ -60,6 +63,7 @@ private:
     std::vector<GroupElement> h_;
     uint64_t n;
     uint64_t m;
+    const FixedBaseMultiExponent* h_multiexp_;
 };
 
 } // namespace lelantus
@@ -108,6 +108,19 @@ BOOST_AUTO_TEST_CASE(prove_verify)
     BOOST_CHECK(ProofVerifier(gens_g, gens_h, u, ComputePInit(), 2).verify(x, proof, challengeGenerator));
     challengeGenerator.reset(new ChallengeGeneratorImpl<CHash256>(1));
     BOOST_CHECK(ProofVerifier(gens_g, gens_h, u, ComputePInit(), 2).verify_fast(n, x, proof, challengeGenerator));
+
+    // precomputed generators
+    std::vector<GroupElement> gh(gens_g);
+    gh.insert(gh.end(), gens_h.begin(), gens_h.end());
+    FixedBaseMultiExponent ghMultiExp(gh);
+
+    challengeGenerator.reset(new ChallengeGeneratorImpl<CHash256>(1));
+    BOOST_CHECK(ProofVerifier(gens_g, gens_h, u, ComputePInit(), 2, &ghMultiExp).verify_fast(n, x, proof, challengeGenerator));
+
+    auto fakeProof = proof;
+    fakeProof.b_.randomize();
+    challengeGenerator.reset(new ChallengeGeneratorImpl<CHash256>(1));
+    BOOST_CHECK(!ProofVerifier(gens_g, gens_h, u, ComputePInit(), 2, &ghMultiExp).verify_fast(n, x, fakeProof, challengeGenerator));
 }
 
 BOOST_AUTO_TEST_CASE(fake_proof_not_verify)
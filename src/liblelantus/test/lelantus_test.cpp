@@ -129,6 +129,108 @@ BOOST_AUTO_TEST_CASE(prove_verify_many_coins)
 //    BOOST_CHECK(verifier.verify(anonymity_sets, {}, Sin, {}, groupIds, Vin, Vout + f, uint64_t(0), Cout_Public, proof));
 }
 
+BOOST_AUTO_TEST_CASE(prove_verify_many_coins_multithreaded)
+{
+    size_t N = 100;
+
+    PrivateCoin input1(params ,2), input2(params, 2), input3(params, 1);
+    std::vector<std::pair<PrivateCoin, uint32_t>> Cin = {
+        {input1, 0}, {input2, 0}, {input3, 1}
+    };
+
+    std::vector <size_t> indexes = {0, 1, 0};
+
+    auto anonymity_sets = GenerateAnonymitySets({N, N});
+    anonymity_sets[0][0] = Cin[0].first.getPublicCoin();
+    anonymity_sets[0][1] = Cin[1].first.getPublicCoin();
+    anonymity_sets[1][0] = Cin[2].first.getPublicCoin();
+
+    Scalar Vin(5);
+    uint64_t Vout(6), f(1);
+    std::vector<PrivateCoin> Cout = {{params, 2}, {params, 1}};
+
+    std::vector<uint32_t> groupIds;
+    auto Sin = ExtractSerials(anonymity_sets.size(), Cin, groupIds);
+    auto Cout_Public = ExtractPublicCoins(Cout);
+
+    lelantus::LelantusVerifier verifier(params, LELANTUS_TX_VERSION_4_5);
+    for (std::size_t threads : {2, 4, 8}) {
+        LelantusProof proof;
+        SchnorrProof qkSchnorrProof;
+
+        LelantusProver prover(params, LELANTUS_TX_VERSION_4_5, threads);
+        prover.proof(anonymity_sets, {}, Vin, Cin, indexes, {}, Vout, Cout, f,  proof, qkSchnorrProof);
+
+        BOOST_CHECK_EQUAL(proof.sigma_proofs.size(), Cin.size());
+        BOOST_CHECK(verifier.verify(anonymity_sets, {}, Sin, {}, groupIds, Vin, Vout, f, Cout_Public, proof, qkSchnorrProof));
+    }
+
+    // A failing input must not leave tasks running: the last commitment fails in its own task,
+    // after the ones of the other inputs and the range proof have been pushed to the pool
+    std::vector <size_t> wrongIndexes = {0, 1, N};
+    for (int i = 0; i < 10; ++i) {
+        LelantusProof proof;
+        SchnorrProof qkSchnorrProof;
+        LelantusProver prover(params, LELANTUS_TX_VERSION_4_5, 4);
+        BOOST_CHECK_THROW(prover.proof(anonymity_sets, {}, Vin, Cin, wrongIndexes, {}, Vout, Cout, f,  proof, qkSchnorrProof), std::invalid_argument);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(prove_verify_precomputed_sets)
+{
+    size_t N = 100;
+
+    PrivateCoin input1(params ,2), input2(params, 2), input3(params, 1);
+    std::vector<std::pair<PrivateCoin, uint32_t>> Cin = {
+        {input1, 0}, {input2, 0}, {input3, 1}
+    };
+
+    std::vector <size_t> indexes = {0, 1, 0};
+
+    auto anonymity_sets = GenerateAnonymitySets({N, N});
+    anonymity_sets[0][0] = Cin[0].first.getPublicCoin();
+    anonymity_sets[0][1] = Cin[1].first.getPublicCoin();
+    anonymity_sets[1][0] = Cin[2].first.getPublicCoin();
+
+    Scalar Vin(5);
+    uint64_t Vout(6), f(1);
+    std::vector<PrivateCoin> Cout = {{params, 2}, {params, 1}};
+
+    std::vector<uint32_t> groupIds;
+    auto Sin = ExtractSerials(anonymity_sets.size(), Cin, groupIds);
+    auto Cout_Public = ExtractPublicCoins(Cout);
+
+    // Only the first set is precomputed, the second one goes through the regular path
+    std::vector<GroupElement> points;
+    for (auto const &coin : anonymity_sets[0])
+        points.push_back(coin.getValue());
+
+    LelantusProver::PrecomputedSets precomputedSets;
+    precomputedSets[0] = std::make_shared<const FixedBaseMultiExponent>(points);
+
+    lelantus::LelantusVerifier verifier(params, LELANTUS_TX_VERSION_4_5);
+    for (std::size_t threads : {1, 4}) {
+        LelantusProof proof;
+        SchnorrProof qkSchnorrProof;
+
+        LelantusProver prover(params, LELANTUS_TX_VERSION_4_5, threads, precomputedSets);
+        prover.proof(anonymity_sets, {}, Vin, Cin, indexes, {}, Vout, Cout, f,  proof, qkSchnorrProof);
+
+        BOOST_CHECK(verifier.verify(anonymity_sets, {}, Sin, {}, groupIds, Vin, Vout, f, Cout_Public, proof, qkSchnorrProof));
+    }
+
+    // A precomputation which doesn't match the set is not used
+    points.pop_back();
+    precomputedSets[0] = std::make_shared<const FixedBaseMultiExponent>(points);
+
+    LelantusProof proof;
+    SchnorrProof qkSchnorrProof;
+    LelantusProver prover(params, LELANTUS_TX_VERSION_4_5, 1, precomputedSets);
+    prover.proof(anonymity_sets, {}, Vin, Cin, indexes, {}, Vout, Cout, f,  proof, qkSchnorrProof);
+
+    BOOST_CHECK(verifier.verify(anonymity_sets, {}, Sin, {}, groupIds, Vin, Vout, f, Cout_Public, proof, qkSchnorrProof));
+}
+
 BOOST_AUTO_TEST_CASE(imbalance_proof_should_fail)
 {
     size_t N = 100;
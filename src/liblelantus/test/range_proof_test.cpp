@@ -38,6 +38,83 @@ BOOST_AUTO_TEST_CASE(prove_verify)
 
     RangeVerifier rangeVerifier(g_gen, h_gen1, h_gen2, g_, h_, n, LELANTUS_TX_VERSION_4_5);
     BOOST_CHECK(rangeVerifier.verify_batch(V, V, proof));
+
+    // precomputed generators, g_ and h_ are prefixes of larger sets
+    auto gh = g_;
+    gh.resize(2 * n * m);
+    for (uint64_t i = n * m; i < 2 * n * m; ++i)
+        gh[i].randomize();
+    gh.insert(gh.end(), h_.begin(), h_.end());
+    gh.resize(4 * n * m);
+    for (uint64_t i = 3 * n * m; i < 4 * n * m; ++i)
+        gh[i].randomize();
+    FixedBaseMultiExponent ghMultiExp(gh);
+
+    RangeVerifier fixedBaseVerifier(g_gen, h_gen1, h_gen2, g_, h_, n, LELANTUS_TX_VERSION_4_5, &ghMultiExp);
+    BOOST_CHECK(fixedBaseVerifier.verify_batch(V, V, proof));
+
+    auto fakeProof = proof;
+    fakeProof.innerProductProof.a_.randomize();
+    BOOST_CHECK(!fixedBaseVerifier.verify_batch(V, V, fakeProof));
+}
+
+BOOST_AUTO_TEST_CASE(batch_several_proofs)
+{
+    uint64_t n = 64;
+    uint64_t max_m = 4;
+    secp_primitives::GroupElement g_gen, h_gen1, h_gen2;
+    g_gen.randomize();
+    h_gen1.randomize();
+    h_gen2.randomize();
+
+    auto g_ = RandomizeGroupElements(n * max_m);
+    auto h_ = RandomizeGroupElements(n * max_m);
+    auto gh = g_;
+    gh.insert(gh.end(), h_.begin(), h_.end());
+    FixedBaseMultiExponent ghMultiExp(gh);
+
+    // proofs of different sizes, over prefixes of the same generators
+    std::vector<std::vector<GroupElement>> Vs;
+    std::vector<RangeProof> proofs;
+    for (uint64_t m : {2, 4, 2}) {
+        auto serials = RandomizeScalars(m);
+        auto randoms = RandomizeScalars(m);
+        std::vector<secp_primitives::Scalar> v_s;
+        std::vector<secp_primitives::GroupElement> V;
+        for (uint64_t i = 0; i < m; ++i) {
+            v_s.emplace_back(701 + i);
+            V.push_back(g_gen * v_s.back() + h_gen1 * randoms[i] + h_gen2 * serials[i]);
+        }
+
+        std::vector<GroupElement> g_m(g_.begin(), g_.begin() + n * m), h_m(h_.begin(), h_.begin() + n * m);
+        RangeProver rangeProver(g_gen, h_gen1, h_gen2, g_m, h_m, n, LELANTUS_TX_VERSION_4_5);
+        proofs.emplace_back();
+        rangeProver.batch_proof(v_s, serials, randoms, V, proofs.back());
+        Vs.push_back(V);
+    }
+
+    RangeVerifier rangeVerifier(g_gen, h_gen1, h_gen2, g_, h_, n, LELANTUS_TX_VERSION_4_5, &ghMultiExp);
+    auto verifyAll = [&](const std::vector<RangeProof>& batch) {
+        std::vector<Scalar> gh_exponents;
+        std::vector<GroupElement> points;
+        std::vector<Scalar> exponents;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!rangeVerifier.add_to_batch(Vs[i], Vs[i], batch[i], gh_exponents, points, exponents))
+                return false;
+        }
+        return rangeVerifier.verify_added(gh_exponents, points, exponents);
+    };
+
+    BOOST_CHECK(verifyAll(proofs));
+
+    // one invalid proof fails the whole batch
+    auto fakeProofs = proofs;
+    fakeProofs[1].innerProductProof.a_.randomize();
+    BOOST_CHECK(!verifyAll(fakeProofs));
+
+    // so does a valid proof checked against other values
+    std::swap(Vs[0], Vs[2]);
+    BOOST_CHECK(!verifyAll(proofs));
 }
 
 BOOST_AUTO_TEST_CASE(out_of_range_notVerify)
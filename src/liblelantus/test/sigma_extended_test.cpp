@@ -131,10 +131,19 @@ BOOST_AUTO_TEST_CASE(one_out_of_N_batch)
     Verifier verifier(g, h_gens, n, m);
     BOOST_CHECK(verifier.batchverify(commits, x, serials, proofs));
 
+    // precomputed generators
+    FixedBaseMultiExponent hMultiExp(h_gens);
+    Verifier fixedBaseVerifier(g, h_gens, n, m, &hMultiExp);
+    BOOST_CHECK(fixedBaseVerifier.batchverify(commits, x, serials, proofs));
+
     // verify subset of valid proofs should success also
     serials.pop_back();
     proofs.pop_back();
     BOOST_CHECK(verifier.batchverify(commits, x, serials, proofs));
+    BOOST_CHECK(fixedBaseVerifier.batchverify(commits, x, serials, proofs));
+
+    proofs.back().A_.randomize();
+    BOOST_CHECK(!fixedBaseVerifier.batchverify(commits, x, serials, proofs));
 }
 
 BOOST_AUTO_TEST_CASE(one_out_of_N_batch_with_some_invalid_proof)
@@ -6,6 +6,7 @@
 #define BITCOIN_MEMUSAGE_H
 
 #include "indirectmap.h"
+#include "lazycontainer.h"
 
 #include <stdlib.h>
 
@@ -179,6 +180,14 @@ static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z>& m)
     return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
+// lazycontainer owns its container through a pointer, nothing is allocated while empty
+
+template<typename C>
+static inline size_t DynamicUsage(const lazycontainer<C>& c)
+{
+    return c.allocated() ? MallocUsage(sizeof(C)) + DynamicUsage(c.get()) : 0;
+}
+
 }
 
 #endif // BITCOIN_MEMUSAGE_H
@@ -0,0 +1,105 @@
+#include "mtp_precheck.h"
+#include "chainparams.h"
+#include "ctpl.h"
+#include "hash.h"
+#include "pow.h"
+#include "primitives/block.h"
+#include "util.h"
+#include "utiltime.h"
+#include "version.h"
+
+std::unique_ptr<MTPPrecheck> MTPPrecheck::instance;
+
+MTPPrecheck* MTPPrecheck::get_instance() {
+    if (!instance)
+        instance.reset(new MTPPrecheck());
+    return instance.get();
+}
+
+MTPPrecheck::~MTPPrecheck() {
+    stopWorkers();
+}
+
+void MTPPrecheck::startWorkers(int nThreads) {
+    LOCK(cs);
+    if (nThreads <= 1 || workerPool)
+        return;
+    workerPool.reset(new ctpl::thread_pool(nThreads));
+    RenameThreadPool(*workerPool, "firo-mtpcheck");
+}
+
+void MTPPrecheck::stopWorkers() {
+    std::unique_ptr<ctpl::thread_pool> pool;
+    {
+        LOCK(cs);
+        pool.swap(workerPool);
+    }
+    // queued checks are still run, so nobody waits on a verdict which will never come
+    if (pool)
+        pool->stop(true);
+}
+
+bool MTPPrecheck::hasWorkers() {
+    LOCK(cs);
+    return (bool)workerPool;
+}
+
+uint256 MTPPrecheck::GetProofKey(const CBlockHeader& block) {
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << block.GetHash() << *block.mtpHashData;
+    return ss.GetHash();
+}
+
+void MTPPrecheck::submit(const std::shared_ptr<const CBlockHeader>& header) {
+    if (!header->IsMTP() || !header->mtpHashData)
+        return;
+
+    uint256 key = GetProofKey(*header);
+
+    LOCK(cs);
+    if (!workerPool || verdicts.count(key))
+        return;
+
+    const Consensus::Params& params = Params().GetConsensus();
+    std::shared_future<bool> verdict = workerPool->push([header, &params](int) {
+        return CheckMerkleTreeProof(*header, params);
+    }).share();
+
+    verdicts.emplace(key, verdict);
+    verdictsOrder.push_back(key);
+    while (verdictsOrder.size() > MTP_PRECHECK_MAX_VERDICTS) {
+        verdicts.erase(verdictsOrder.front());
+        verdictsOrder.pop_front();
+    }
+}
+
+bool MTPPrecheck::check(const CBlockHeader& block, const Consensus::Params& params) {
+    if (!block.IsMTP())
+        return true;
+
+    if (!block.mtpHashData)
+        return false;
+
+    std::shared_future<bool> verdict;
+    {
+        LOCK(cs);
+        if (!verdicts.empty()) {
+            auto it = verdicts.find(GetProofKey(block));
+            if (it != verdicts.end())
+                verdict = it->second;
+        }
+    }
+
+    if (!verdict.valid()) {
+        nCheckedInline++;
+        return CheckMerkleTreeProof(block, params);
+    }
+
+    int64_t nTimeStart = GetTimeMicros();
+    bool fValid = verdict.get();
+    nPrechecked++;
+    LogPrint("bench", "    - MTP proof of %s verified ahead (waited %.2fms) [%u ahead, %u inline]\n",
+             block.GetHash().ToString(), 0.001 * (GetTimeMicros() - nTimeStart),
+             (uint64_t)nPrechecked, (uint64_t)nCheckedInline);
+    return fValid;
+}
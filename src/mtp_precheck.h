@@ -0,0 +1,68 @@
+#ifndef FIRO_MTP_PRECHECK_H
+#define FIRO_MTP_PRECHECK_H
+
+#include "consensus/params.h"
+#include "sync.h"
+#include "uint256.h"
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+
+class CBlockHeader;
+
+namespace ctpl {
+class thread_pool;
+}
+
+namespace mtp_tests {
+class TestMTPPrecheck;
+}
+
+// number of MTP proof verdicts kept for CheckBlock to consume
+static const size_t MTP_PRECHECK_MAX_VERDICTS = 1024;
+
+/**
+ * Verifies MTP proofs of blocks received from peers on a pool of worker threads, ahead of
+ * the message handler thread getting to process them. CheckBlock then takes the verdict
+ * instead of running mtp::verify itself (or waits for it if it's still being computed).
+ *
+ * Verdicts are keyed by the block hash together with the hash of the MTP proof data, as the
+ * block hash alone doesn't commit to the proof data: a peer could send a valid header with
+ * a bogus proof.
+ */
+class MTPPrecheck {
+friend class mtp_tests::TestMTPPrecheck; // for test access to the verdicts and counters
+public:
+    static MTPPrecheck* get_instance();
+
+    ~MTPPrecheck();
+
+    void startWorkers(int nThreads);
+    void stopWorkers();
+    bool hasWorkers();
+
+    // Queues verification of the MTP proof of the block. Does nothing without workers, for non-MTP
+    // blocks, or if the block was queued already. Callers filter out blocks not worth verifying.
+    void submit(const std::shared_ptr<const CBlockHeader>& header);
+
+    // Same result as CheckMerkleTreeProof, using the verdict computed by the workers when there's one.
+    bool check(const CBlockHeader& block, const Consensus::Params& params);
+
+private:
+    static uint256 GetProofKey(const CBlockHeader& block);
+
+    static std::unique_ptr<MTPPrecheck> instance;
+
+    CCriticalSection cs;
+    std::map<uint256, std::shared_future<bool>> verdicts;
+    std::deque<uint256> verdictsOrder;
+    std::unique_ptr<ctpl::thread_pool> workerPool;
+
+    std::atomic<uint64_t> nPrechecked{0};
+    std::atomic<uint64_t> nCheckedInline{0};
+};
+
+#endif //FIRO_MTP_PRECHECK_H
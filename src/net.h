@@ -676,12 +676,15 @@ public:
 
     int64_t nTime;                  // time (in microseconds) of message receipt.
 
+    bool fPrechecked;               // block message already handed to MTP proof precheck
+
     CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, int nTypeIn, int nVersionIn) : hdrbuf(nTypeIn, nVersionIn), hdr(pchMessageStartIn), vRecv(nTypeIn, nVersionIn) {
         hdrbuf.resize(24);
         in_data = false;
         nHdrPos = 0;
         nDataPos = 0;
         nTime = 0;
+        fPrechecked = false;
     }
 
     bool complete() const
@@ -14,6 +14,7 @@
 #include "init.h"
 #include "validation.h"
 #include "merkleblock.h"
+#include "mtp_precheck.h"
 #include "net.h"
 #include "netmessagemaker.h"
 #include "netbase.h"
@@ -22,6 +23,7 @@
 #include "primitives/block.h"
 #include "primitives/transaction.h"
 #include "random.h"
+#include "rawblockcache.h"
 #include "tinyformat.h"
 #include "txmempool.h"
 #include "ui_interface.h"
@@ -804,6 +806,13 @@ void PeerLogicValidation::SyncTransaction(const CTransaction& tx, const CBlockIn
     }
 }
 
+// Blocks recently sent to peers the way they are stored on disk, see ProcessGetData
+static CRawBlockCache& RawBlockCache()
+{
+    static CRawBlockCache cache((size_t)std::max((int64_t)0, GetArg("-rawblockcache", DEFAULT_RAW_BLOCK_CACHE_SIZE)) << 20);
+    return cache;
+}
+
 static CCriticalSection cs_most_recent_block;
 static std::shared_ptr<const CBlock> most_recent_block;
 static std::shared_ptr<const CBlockHeaderAndShortTxIDs> most_recent_compact_block;
@@ -823,11 +832,23 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
     bool fWitnessEnabled = IsWitnessEnabled(pindex->pprev, Params().GetConsensus());
     uint256 hashBlock(pblock->GetHash());
 
+    // Firo - MTP
+    // The MTP proof was verified by now, only the announcement below needs its data. The copies kept
+    // for later requests don't hold it, compact blocks of MTP blocks are read from disk for those.
+    std::shared_ptr<const CBlock> pblockRecent = pblock;
+    std::shared_ptr<const CBlockHeaderAndShortTxIDs> pcmpctblockRecent = pcmpctblock;
+    if (pblock->mtpHashData) {
+        std::shared_ptr<CBlock> pblockCopy = std::make_shared<CBlock>(*pblock);
+        pblockCopy->mtpHashData.reset();
+        pblockRecent = pblockCopy;
+        pcmpctblockRecent.reset();
+    }
+
     {
         LOCK(cs_most_recent_block);
         most_recent_block_hash = hashBlock;
-        most_recent_block = pblock;
-        most_recent_compact_block = pcmpctblock;
+        most_recent_block = pblockRecent;
+        most_recent_compact_block = pcmpctblockRecent;
     }
 
     connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, &hashBlock](CNode* pnode) {
@@ -1088,11 +1109,35 @@ void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParam
                 // it's available before trying to send.
                 if (send && (mi->second->nStatus & BLOCK_HAVE_DATA))
                 {
-                    // Send block from disk
+                    // Already validated blocks are sent the way they are stored on disk, without deserializing
+                    // them (and their MTP proof data). The stored serialization has witness data, which is the
+                    // same as without as long as segwit isn't enabled.
+                    bool fRawBlock = (inv.type == MSG_WITNESS_BLOCK ||
+                                (inv.type == MSG_BLOCK && !IsWitnessEnabled(mi->second->pprev, consensusParams))) &&
+                            !fParanoidBlockReads && mi->second->IsValid(BLOCK_VALID_SCRIPTS);
+
+                    // Send block from disk, or from the blocks recently sent to other peers. A copy of
+                    // the bytes is cheap compared to reading and hashing them again.
                     CBlock block;
-                    if (!ReadBlockFromDisk(block, (*mi).second, consensusParams))
-                        assert(!"cannot load block from disk");
-                    if (inv.type == MSG_BLOCK)
+                    RawBlockPtr rawBlock;
+                    if (fRawBlock && !(rawBlock = RawBlockCache().Get(inv.hash))) {
+                        std::shared_ptr<std::vector<unsigned char>> pblockData = std::make_shared<std::vector<unsigned char>>();
+                        if (ReadRawBlockFromDisk(*pblockData, (*mi).second, Params().MessageStart())) {
+                            rawBlock = pblockData;
+                            RawBlockCache().Insert(inv.hash, rawBlock);
+                        }
+                    }
+                    if (!rawBlock) {
+                        if (!ReadBlockFromDisk(block, (*mi).second, consensusParams))
+                            assert(!"cannot load block from disk");
+                    }
+                    if (rawBlock) {
+                        CSerializedNetMsg msg;
+                        msg.command = NetMsgType::BLOCK;
+                        msg.data = *rawBlock;
+                        connman.PushMessage(pfrom, std::move(msg));
+                    }
+                    else if (inv.type == MSG_BLOCK)
                         connman.PushMessage(pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, block));
                     else if (inv.type == MSG_WITNESS_BLOCK)
                         connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, block));
@@ -2988,6 +3033,43 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
     return true;
 }
 
+// Hands the MTP proof of a block waiting in the peer's queue to MTPPrecheck. Verifying a proof is
+// expensive, so only blocks we requested from this peer, building on a block we know and with a
+// valid header get verified ahead. Others are checked when they are processed, like before.
+static void PrecheckQueuedBlock(CNode* pfrom, const CDataStream& blockData, const Consensus::Params& consensusParams)
+{
+    if (!MTPPrecheck::get_instance()->hasWorkers())
+        return;
+
+    // Only the header is needed, it is at the start of the block
+    auto header = std::make_shared<CBlockHeader>();
+    try {
+        CDataStream ss(blockData);
+        ss >> *header;
+    }
+    catch (const std::exception&) {
+        // malformed blocks are dealt with when processing the message
+        return;
+    }
+
+    if (!header->IsMTP() || !header->mtpHashData)
+        return;
+
+    {
+        LOCK(cs_main);
+        auto itInFlight = mapBlocksInFlight.find(header->GetHash());
+        if (itInFlight == mapBlocksInFlight.end() || itInFlight->second.first != pfrom->GetId())
+            return;
+        if (!mapBlockIndex.count(header->hashPrevBlock))
+            return;
+        CValidationState state;
+        if (!CheckBlockHeader(*header, state, consensusParams))
+            return;
+    }
+
+    MTPPrecheck::get_instance()->submit(header);
+}
+
 static bool SendRejectsAndCheckIfBanned(CNode* pnode, CConnman& connman)
 {
     AssertLockHeld(cs_main);
@@ -3045,6 +3127,7 @@ bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& i
             return false;
 
         std::list<CNetMessage> msgs;
+        std::vector<const CNetMessage*> vPrecheck;
         {
             LOCK(pfrom->cs_vProcessMsg);
             if (pfrom->vProcessMsg.empty())
@@ -3054,7 +3137,20 @@ bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& i
             pfrom->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
             pfrom->fPauseRecv = pfrom->nProcessQueueSize > connman.GetReceiveFloodSize();
             fMoreWork = !pfrom->vProcessMsg.empty();
+
+            // Blocks waiting behind this message get their MTP proofs verified in the meantime
+            if (!fImporting && !fReindex) {
+                for (CNetMessage& queued : pfrom->vProcessMsg) {
+                    if (!queued.fPrechecked && queued.hdr.GetCommand() == NetMsgType::BLOCK) {
+                        queued.fPrechecked = true;
+                        vPrecheck.push_back(&queued);
+                    }
+                }
+            }
         }
+        // Queued messages are only ever removed by this thread, so they can be read without the lock
+        for (const CNetMessage* queued : vPrecheck)
+            PrecheckQueuedBlock(pfrom, queued->vRecv, chainparams.GetConsensus());
         CNetMessage& msg(msgs.front());
 
         msg.SetVersion(pfrom->GetRecvVersion());
@@ -3348,7 +3444,8 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
                     bool fGotBlockFromCache = false;
                     {
                         LOCK(cs_most_recent_block);
-                        if (most_recent_block_hash == pBestIndex->GetBlockHash()) {
+                        // there is no cached compact block for MTP blocks, see NewPoWValidBlock
+                        if (most_recent_block_hash == pBestIndex->GetBlockHash() && most_recent_compact_block) {
                             if (state.fWantsCmpctWitness)
                                 connman.PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *most_recent_compact_block));
                             else {
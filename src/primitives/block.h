@@ -76,6 +76,17 @@ public:
         }
     }
 
+    // Reads past serialized MTP data without allocating it
+    template <typename Stream>
+    static void Skip(Stream &s) {
+        s.ignore(sizeof(hashRootMTP) + sizeof(nBlockMTP));
+        for (int i = 0; i < mtp::MTP_L*3; i++) {
+            uint8_t numberOfProofBlocks;
+            ::Unserialize(s, numberOfProofBlocks);
+            s.ignore(numberOfProofBlocks * 16);
+        }
+    }
+
     // Function for reading
     template <typename Stream>
     inline void SerializationOp(Stream &s, CSerActionUnserialize ser_action) {
@@ -0,0 +1,142 @@
+#include "privacyproof_check.h"
+#include "batchproof_container.h"
+#include "sigma/coinspend.h"
+#include "liblelantus/joinsplit.h"
+#include "lelantus.h"
+#include "util.h"
+
+struct CPrivacyProofCheck::SigmaSpendProof {
+    SigmaSpendProof(
+            const std::shared_ptr<sigma::CoinSpend>& spend_,
+            std::vector<sigma::PublicCoin>&& anonymitySet_,
+            const sigma::SpendMetaData& metaData_,
+            bool fPadding_,
+            int coinGroupId_,
+            bool fStartSigmaBlacklist_,
+            bool fCollectProof_,
+            const uint256& txHash_,
+            int nHeight_)
+            : spend(spend_),
+            anonymitySet(std::move(anonymitySet_)),
+            metaData(metaData_),
+            fPadding(fPadding_),
+            coinGroupId(coinGroupId_),
+            fStartSigmaBlacklist(fStartSigmaBlacklist_),
+            fCollectProof(fCollectProof_),
+            txHash(txHash_),
+            nHeight(nHeight_) {}
+
+    std::shared_ptr<sigma::CoinSpend> spend;
+    std::vector<sigma::PublicCoin> anonymitySet;
+    sigma::SpendMetaData metaData;
+    bool fPadding;
+    int coinGroupId;
+    bool fStartSigmaBlacklist;
+    bool fCollectProof;
+    uint256 txHash;
+    int nHeight;
+};
+
+struct CPrivacyProofCheck::LelantusJoinSplitProof {
+    LelantusJoinSplitProof(
+            const std::shared_ptr<lelantus::JoinSplit>& joinsplit_,
+            std::map<uint32_t, lelantus::AnonymitySetPtr>&& anonymitySets_,
+            std::vector<std::vector<unsigned char>>&& anonymitySetHashes_,
+            std::vector<lelantus::PublicCoin>&& Cout_,
+            uint64_t Vout_,
+            const uint256& txHashForMetadata_,
+            bool fStartLelantusBlacklist_,
+            bool fCollectProof_,
+            const uint256& txHash_,
+            int nHeight_)
+            : joinsplit(joinsplit_),
+            anonymitySets(std::move(anonymitySets_)),
+            anonymitySetHashes(std::move(anonymitySetHashes_)),
+            Cout(std::move(Cout_)),
+            Vout(Vout_),
+            txHashForMetadata(txHashForMetadata_),
+            fStartLelantusBlacklist(fStartLelantusBlacklist_),
+            fCollectProof(fCollectProof_),
+            txHash(txHash_),
+            nHeight(nHeight_) {}
+
+    std::shared_ptr<lelantus::JoinSplit> joinsplit;
+    std::map<uint32_t, lelantus::AnonymitySetPtr> anonymitySets;
+    std::vector<std::vector<unsigned char>> anonymitySetHashes;
+    std::vector<lelantus::PublicCoin> Cout;
+    uint64_t Vout;
+    uint256 txHashForMetadata;
+    bool fStartLelantusBlacklist;
+    bool fCollectProof;
+    uint256 txHash;
+    int nHeight;
+};
+
+CPrivacyProofCheck::CPrivacyProofCheck(
+        const std::shared_ptr<sigma::CoinSpend>& spend,
+        std::vector<sigma::PublicCoin>&& anonymitySet,
+        const sigma::SpendMetaData& metaData,
+        bool fPadding,
+        int coinGroupId,
+        bool fStartSigmaBlacklist,
+        bool fCollectProof,
+        const uint256& txHash,
+        int nHeight)
+        : sigmaSpend(std::make_shared<SigmaSpendProof>(
+            spend, std::move(anonymitySet), metaData, fPadding, coinGroupId, fStartSigmaBlacklist, fCollectProof, txHash, nHeight)) {}
+
+CPrivacyProofCheck::CPrivacyProofCheck(
+        const std::shared_ptr<lelantus::JoinSplit>& joinsplit,
+        std::map<uint32_t, lelantus::AnonymitySetPtr>&& anonymitySets,
+        std::vector<std::vector<unsigned char>>&& anonymitySetHashes,
+        std::vector<lelantus::PublicCoin>&& Cout,
+        uint64_t Vout,
+        const uint256& txHashForMetadata,
+        bool fStartLelantusBlacklist,
+        bool fCollectProof,
+        const uint256& txHash,
+        int nHeight)
+        : lelantusJoinSplit(std::make_shared<LelantusJoinSplitProof>(
+            joinsplit, std::move(anonymitySets), std::move(anonymitySetHashes), std::move(Cout),
+            Vout, txHashForMetadata, fStartLelantusBlacklist, fCollectProof, txHash, nHeight)) {}
+
+bool CPrivacyProofCheck::operator()() {
+    BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
+
+    if (sigmaSpend) {
+        const SigmaSpendProof& p = *sigmaSpend;
+        // if we are collecting proofs, skip verification and collect proofs
+        bool passVerify = p.spend->Verify(p.anonymitySet, p.metaData, p.fPadding, p.fCollectProof);
+
+        if (p.fCollectProof)
+            batchProofContainer->add(p.spend.get(), p.fPadding, p.coinGroupId, p.anonymitySet.size(), p.fStartSigmaBlacklist, p.txHash);
+
+        if (!passVerify)
+            LogPrintf("CheckSigmaSpendTransaction: verification failed at block %d\n", p.nHeight);
+        return passVerify;
+    }
+
+    if (lelantusJoinSplit) {
+        const LelantusJoinSplitProof& p = *lelantusJoinSplit;
+        std::map<uint32_t, lelantus::PublicCoinRange> ranges;
+        for (const auto& set : p.anonymitySets)
+            ranges[set.first] = set.second->coins();
+
+        Scalar challenge;
+        bool passVerify = p.joinsplit->Verify(ranges, p.anonymitySetHashes, p.Cout, p.Vout, p.txHashForMetadata, challenge, p.fCollectProof);
+
+        if (p.fCollectProof) {
+            std::map<uint32_t, size_t> idAndSizes;
+            for (const auto& itr : ranges)
+                idAndSizes[itr.first] = itr.second.size();
+
+            batchProofContainer->add(p.joinsplit.get(), idAndSizes, challenge, p.Cout, p.fStartLelantusBlacklist, p.txHash);
+        }
+
+        if (!passVerify)
+            LogPrintf("CheckLelantusJoinSplitTransaction: verification failed at block %d\n", p.nHeight);
+        return passVerify;
+    }
+
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef FIRO_PRIVACYPROOF_CHECK_H
+#define FIRO_PRIVACYPROOF_CHECK_H
+
+#include "uint256.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace sigma {
+class CoinSpend;
+class PublicCoin;
+class SpendMetaData;
+}
+
+namespace lelantus {
+class JoinSplit;
+class PublicCoin;
+struct AnonymitySetSnapshot;
+}
+
+/**
+ * Closure representing one Sigma spend or Lelantus JoinSplit proof verification.
+ * All the chain state needed by the proof (anonymity sets, set hashes, metadata) is
+ * captured when the check is created, so it can be run by CCheckQueue worker threads
+ * without holding cs_main. Checks depending on the state (used serials, double mints)
+ * are still done by the caller before the check is queued.
+ */
+class CPrivacyProofCheck
+{
+private:
+    struct SigmaSpendProof;
+    struct LelantusJoinSplitProof;
+
+    std::shared_ptr<const SigmaSpendProof> sigmaSpend;
+    std::shared_ptr<const LelantusJoinSplitProof> lelantusJoinSplit;
+
+public:
+    CPrivacyProofCheck() {}
+
+    CPrivacyProofCheck(
+            const std::shared_ptr<sigma::CoinSpend>& spend,
+            std::vector<sigma::PublicCoin>&& anonymitySet,
+            const sigma::SpendMetaData& metaData,
+            bool fPadding,
+            int coinGroupId,
+            bool fStartSigmaBlacklist,
+            bool fCollectProof,
+            const uint256& txHash,
+            int nHeight);
+
+    CPrivacyProofCheck(
+            const std::shared_ptr<lelantus::JoinSplit>& joinsplit,
+            std::map<uint32_t, std::shared_ptr<const lelantus::AnonymitySetSnapshot>>&& anonymitySets,
+            std::vector<std::vector<unsigned char>>&& anonymitySetHashes,
+            std::vector<lelantus::PublicCoin>&& Cout,
+            uint64_t Vout,
+            const uint256& txHashForMetadata,
+            bool fStartLelantusBlacklist,
+            bool fCollectProof,
+            const uint256& txHash,
+            int nHeight);
+
+    bool operator()();
+
+    void swap(CPrivacyProofCheck &check) {
+        sigmaSpend.swap(check.sigmaSpend);
+        lelantusJoinSplit.swap(check.lelantusJoinSplit);
+    }
+};
+
+#endif // FIRO_PRIVACYPROOF_CHECK_H
@@ -0,0 +1,347 @@
+#include "privacystatedb.h"
+
+#include "chain.h"
+#include "lelantus.h"
+#include "sigma.h"
+#include "util.h"
+#include "utiltime.h"
+#include "validation.h"
+
+#include <tuple>
+
+CPrivacyStateDB *pprivacystatedb = NULL;
+
+namespace {
+
+const char DB_STATE_HEADER = 'H';
+const char DB_SIGMA_MINT = 'm';
+const char DB_SIGMA_SPEND = 's';
+const char DB_SIGMA_GROUP = 'g';
+const char DB_LELANTUS_MINT = 'M';
+const char DB_LELANTUS_SPEND = 'S';
+const char DB_LELANTUS_GROUP = 'G';
+
+// Bumped whenever the layout of the records changes, states of other versions are rebuilt
+const int PRIVACY_STATE_VERSION = 1;
+
+// Maximum number of records written in one batch
+const uint32_t RECORDS_PER_BATCH = 100000;
+
+// (denomination, group id, height)
+typedef std::tuple<sigma::PublicCoin, int64_t, int, int> SigmaMintRecord;
+typedef std::tuple<Scalar, sigma::CSpendCoinInfo> SigmaSpendRecord;
+// (denomination, group id, first block, last block, number of coins)
+typedef std::tuple<int64_t, int, uint256, uint256, int> SigmaGroupRecord;
+// (group id, height, whether the tag index maps the tag to this coin, tag)
+typedef std::tuple<lelantus::PublicCoin, int, int, bool, uint256> LelantusMintRecord;
+typedef std::tuple<Scalar, int> LelantusSpendRecord;
+// (group id, first block, last block, number of coins)
+typedef std::tuple<int, uint256, uint256, int> LelantusGroupRecord;
+
+// Records are keyed by prefix and position, big endian so they are iterated in order
+struct CRecordKey {
+    char prefix;
+    uint32_t index;
+
+    CRecordKey() : prefix(0), index(0) {}
+    CRecordKey(char prefix, uint32_t index) : prefix(prefix), index(index) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, prefix);
+        ser_writedata32be(s, index);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s) {
+        prefix = ser_readdata8(s);
+        index = ser_readdata32be(s);
+    }
+};
+
+struct CPrivacyStateHeader {
+    int nVersion;
+    uint256 hashBlock;
+    // number of records stored by prefix
+    std::map<char, uint32_t> records;
+
+    // latest group ids by denomination, and mint/spend counters by (group id, denomination)
+    std::map<int64_t, int> sigmaLatestCoinIds;
+    std::map<std::pair<int, int64_t>, uint64_t> sigmaMintMetaInfo, sigmaSpendMetaInfo;
+
+    int lelantusLatestCoinId;
+    std::map<int, uint64_t> lelantusExtendedMintMetaInfo, lelantusMintMetaInfo, lelantusSpendMetaInfo;
+
+    CPrivacyStateHeader() : nVersion(0), lelantusLatestCoinId(0) {}
+
+    uint32_t GetRecords(char prefix) const {
+        auto it = records.find(prefix);
+        return it == records.end() ? 0 : it->second;
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nVersion);
+        READWRITE(hashBlock);
+        READWRITE(records);
+        READWRITE(sigmaLatestCoinIds);
+        READWRITE(sigmaMintMetaInfo);
+        READWRITE(sigmaSpendMetaInfo);
+        READWRITE(lelantusLatestCoinId);
+        READWRITE(lelantusExtendedMintMetaInfo);
+        READWRITE(lelantusMintMetaInfo);
+        READWRITE(lelantusSpendMetaInfo);
+    }
+};
+
+class CRecordWriter {
+public:
+    CRecordWriter(CDBWrapper& db, std::map<char, uint32_t>& records) : db(db), batch(db), records(records), nInBatch(0), fOk(true) {}
+
+    template <typename V>
+    void Write(char prefix, const V& value) {
+        batch.Write(CRecordKey(prefix, records[prefix]++), value);
+        if (++nInBatch >= RECORDS_PER_BATCH)
+            Flush();
+    }
+
+    void Erase(char prefix, uint32_t index) {
+        batch.Erase(CRecordKey(prefix, index));
+        if (++nInBatch >= RECORDS_PER_BATCH)
+            Flush();
+    }
+
+    bool Flush() {
+        fOk = fOk && db.WriteBatch(batch);
+        batch.Clear();
+        nInBatch = 0;
+        return fOk;
+    }
+
+private:
+    CDBWrapper& db;
+    CDBBatch batch;
+    std::map<char, uint32_t>& records;
+    uint32_t nInBatch;
+    bool fOk;
+};
+
+template <typename V, typename F>
+void ReadRecords(CDBWrapper& db, const CPrivacyStateHeader& header, char prefix, F f)
+{
+    uint32_t n = header.GetRecords(prefix);
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(CRecordKey(prefix, 0));
+    for (uint32_t i = 0; i < n; ++i, pcursor->Next()) {
+        CRecordKey key;
+        V value;
+        if (!pcursor->Valid() || !pcursor->GetKey(key) || key.prefix != prefix || key.index != i || !pcursor->GetValue(value))
+            throw std::runtime_error(strprintf("record %c/%u is missing", prefix, i));
+        f(value);
+    }
+}
+
+uint256 GetBlockHash(const CBlockIndex *index)
+{
+    return index ? index->GetBlockHash() : uint256();
+}
+
+CBlockIndex* LookupActiveBlock(const uint256& hash)
+{
+    if (hash.IsNull())
+        return nullptr;
+
+    BlockMap::iterator it = mapBlockIndex.find(hash);
+    if (it == mapBlockIndex.end() || !chainActive.Contains(it->second))
+        throw std::runtime_error(strprintf("block %s is not in the active chain", hash.ToString()));
+    return it->second;
+}
+
+}
+
+CPrivacyStateDB::CPrivacyStateDB(size_t nCacheSize, bool fMemory, bool fWipe)
+    : CDBWrapper(GetDataDir() / "privacystate", nCacheSize, fMemory, fWipe)
+{
+}
+
+bool CPrivacyStateDB::WriteState(
+        const uint256& hashBlock,
+        const sigma::CSigmaState& sigmaState,
+        const lelantus::CLelantusState& lelantusState)
+{
+    if (hashBlock == hashStoredState)
+        return true;
+
+    int64_t nStart = GetTimeMillis();
+
+    // the previous state is invalidated before any of its records is overwritten
+    CPrivacyStateHeader oldHeader;
+    Read(DB_STATE_HEADER, oldHeader);
+    if (!Erase(DB_STATE_HEADER, true))
+        return false;
+    hashStoredState.SetNull();
+
+    CPrivacyStateHeader header;
+    header.nVersion = PRIVACY_STATE_VERSION;
+    header.hashBlock = hashBlock;
+
+    CRecordWriter writer(*this, header.records);
+
+    const sigma::CSigmaState::Containers& sigmaContainers = sigmaState.containers;
+    for (const auto& mint : sigmaContainers.mintedPubCoins)
+        writer.Write(DB_SIGMA_MINT, SigmaMintRecord(mint.first, int64_t(mint.second.denomination), mint.second.coinGroupId, mint.second.nHeight));
+
+    for (const Scalar& serial : sigmaContainers.orderedCoinSerials) {
+        auto it = sigmaContainers.usedCoinSerials.find(serial);
+        if (it == sigmaContainers.usedCoinSerials.end())
+            return error("%s: sigma serial %s is not in the used serials", __func__, serial.GetHex());
+        writer.Write(DB_SIGMA_SPEND, SigmaSpendRecord(serial, it->second));
+    }
+
+    for (const auto& group : sigmaState.coinGroups)
+        writer.Write(DB_SIGMA_GROUP, SigmaGroupRecord(int64_t(group.first.first), group.first.second,
+            GetBlockHash(group.second.firstBlock), GetBlockHash(group.second.lastBlock), group.second.nCoins));
+
+    for (const auto& id : sigmaState.latestCoinIds)
+        header.sigmaLatestCoinIds[int64_t(id.first)] = id.second;
+    for (const auto& group : sigmaContainers.mintMetaInfo)
+        for (const auto& denom : group.second)
+            header.sigmaMintMetaInfo[std::make_pair(group.first, int64_t(denom.first))] = denom.second;
+    for (const auto& group : sigmaContainers.spendMetaInfo)
+        for (const auto& denom : group.second)
+            header.sigmaSpendMetaInfo[std::make_pair(group.first, int64_t(denom.first))] = denom.second;
+
+    const lelantus::CLelantusState::Containers& lelantusContainers = lelantusState.containers;
+    for (const auto& mint : lelantusContainers.mintedPubCoins) {
+        auto tag = lelantusContainers.tagToPublicCoin.find(mint.second.tag);
+        bool fTag = tag != lelantusContainers.tagToPublicCoin.end() && tag->second == mint.first;
+        writer.Write(DB_LELANTUS_MINT, LelantusMintRecord(mint.first, mint.second.coinGroupId, mint.second.nHeight,
+            fTag, mint.second.tag));
+    }
+
+    for (const auto& spend : lelantusContainers.usedCoinSerials)
+        writer.Write(DB_LELANTUS_SPEND, LelantusSpendRecord(spend.first, spend.second));
+
+    for (const auto& group : lelantusState.coinGroups)
+        writer.Write(DB_LELANTUS_GROUP, LelantusGroupRecord(group.first,
+            GetBlockHash(group.second.firstBlock), GetBlockHash(group.second.lastBlock), group.second.nCoins));
+
+    header.lelantusLatestCoinId = lelantusState.latestCoinId;
+    header.lelantusExtendedMintMetaInfo.insert(lelantusContainers.extendedMintMetaInfo.begin(), lelantusContainers.extendedMintMetaInfo.end());
+    header.lelantusMintMetaInfo.insert(lelantusContainers.mintMetaInfo.begin(), lelantusContainers.mintMetaInfo.end());
+    header.lelantusSpendMetaInfo.insert(lelantusContainers.spendMetaInfo.begin(), lelantusContainers.spendMetaInfo.end());
+
+    // drop the records of the previous state beyond the new ones
+    for (const auto& records : oldHeader.records)
+        for (uint32_t i = header.GetRecords(records.first); i < records.second; ++i)
+            writer.Erase(records.first, i);
+
+    if (!writer.Flush() || !Write(DB_STATE_HEADER, header, true))
+        return error("%s: failed to write the privacy state", __func__);
+
+    hashStoredState = hashBlock;
+
+    LogPrintf("%s: privacy state at block %s written in %dms\n", __func__, hashBlock.ToString(), GetTimeMillis() - nStart);
+    return true;
+}
+
+bool CPrivacyStateDB::ReadState(
+        const uint256& hashBlock,
+        sigma::CSigmaState& sigmaState,
+        lelantus::CLelantusState& lelantusState)
+{
+    sigmaState.Reset();
+    lelantusState.Reset();
+
+    CPrivacyStateHeader header;
+    if (!Read(DB_STATE_HEADER, header) || header.nVersion != PRIVACY_STATE_VERSION) {
+        LogPrintf("%s: no privacy state stored\n", __func__);
+        return false;
+    }
+
+    if (header.hashBlock != hashBlock) {
+        LogPrintf("%s: privacy state stored at block %s, not at the tip\n", __func__, header.hashBlock.ToString());
+        return false;
+    }
+
+    int64_t nStart = GetTimeMillis();
+
+    try {
+        sigma::CSigmaState::Containers& sigmaContainers = sigmaState.containers;
+
+        sigmaContainers.mintedPubCoins.reserve(header.GetRecords(DB_SIGMA_MINT));
+        ReadRecords<SigmaMintRecord>(*this, header, DB_SIGMA_MINT, [&](const SigmaMintRecord& mint) {
+            sigmaContainers.mintedPubCoins.emplace(std::get<0>(mint),
+                sigma::CMintedCoinInfo::make(sigma::CoinDenomination(std::get<1>(mint)), std::get<2>(mint), std::get<3>(mint)));
+        });
+
+        sigmaContainers.usedCoinSerials.reserve(header.GetRecords(DB_SIGMA_SPEND));
+        sigmaContainers.orderedCoinSerials.reserve(header.GetRecords(DB_SIGMA_SPEND));
+        ReadRecords<SigmaSpendRecord>(*this, header, DB_SIGMA_SPEND, [&](const SigmaSpendRecord& spend) {
+            sigmaContainers.usedCoinSerials.emplace(std::get<0>(spend), std::get<1>(spend));
+            sigmaContainers.orderedCoinSerials.push_back(std::get<0>(spend));
+        });
+
+        ReadRecords<SigmaGroupRecord>(*this, header, DB_SIGMA_GROUP, [&](const SigmaGroupRecord& group) {
+            sigma::CSigmaState::SigmaCoinGroupInfo& info = sigmaState.coinGroups[std::make_pair(sigma::CoinDenomination(std::get<0>(group)), std::get<1>(group))];
+            info.firstBlock = LookupActiveBlock(std::get<2>(group));
+            info.lastBlock = LookupActiveBlock(std::get<3>(group));
+            info.nCoins = std::get<4>(group);
+        });
+
+        for (const auto& id : header.sigmaLatestCoinIds)
+            sigmaState.latestCoinIds[sigma::CoinDenomination(id.first)] = id.second;
+        for (const auto& meta : header.sigmaMintMetaInfo)
+            sigmaContainers.mintMetaInfo[meta.first.first][sigma::CoinDenomination(meta.first.second)] = meta.second;
+        for (const auto& meta : header.sigmaSpendMetaInfo)
+            sigmaContainers.spendMetaInfo[meta.first.first][sigma::CoinDenomination(meta.first.second)] = meta.second;
+
+        // the check goes through all the groups whichever one it's given
+        if (!header.sigmaSpendMetaInfo.empty())
+            sigmaContainers.CheckSurgeCondition(header.sigmaSpendMetaInfo.begin()->first.first,
+                sigma::CoinDenomination(header.sigmaSpendMetaInfo.begin()->first.second));
+
+        lelantus::CLelantusState::Containers& lelantusContainers = lelantusState.containers;
+
+        lelantusContainers.mintedPubCoins.reserve(header.GetRecords(DB_LELANTUS_MINT));
+        ReadRecords<LelantusMintRecord>(*this, header, DB_LELANTUS_MINT, [&](const LelantusMintRecord& mint) {
+            lelantusContainers.mintedPubCoins.emplace(std::get<0>(mint),
+                lelantus::CMintedCoinInfo::make(std::get<1>(mint), std::get<2>(mint), std::get<4>(mint)));
+            if (std::get<3>(mint))
+                lelantusContainers.tagToPublicCoin.emplace(std::get<4>(mint), std::get<0>(mint));
+        });
+
+        lelantusContainers.usedCoinSerials.reserve(header.GetRecords(DB_LELANTUS_SPEND));
+        ReadRecords<LelantusSpendRecord>(*this, header, DB_LELANTUS_SPEND, [&](const LelantusSpendRecord& spend) {
+            lelantusContainers.usedCoinSerials.emplace(std::get<0>(spend), std::get<1>(spend));
+        });
+
+        ReadRecords<LelantusGroupRecord>(*this, header, DB_LELANTUS_GROUP, [&](const LelantusGroupRecord& group) {
+            lelantus::CLelantusState::LelantusCoinGroupInfo& info = lelantusState.coinGroups[std::get<0>(group)];
+            info.firstBlock = LookupActiveBlock(std::get<1>(group));
+            info.lastBlock = LookupActiveBlock(std::get<2>(group));
+            info.nCoins = std::get<3>(group);
+        });
+
+        lelantusState.latestCoinId = header.lelantusLatestCoinId;
+        lelantusContainers.extendedMintMetaInfo.clear();
+        lelantusContainers.extendedMintMetaInfo.insert(header.lelantusExtendedMintMetaInfo.begin(), header.lelantusExtendedMintMetaInfo.end());
+        lelantusContainers.mintMetaInfo.insert(header.lelantusMintMetaInfo.begin(), header.lelantusMintMetaInfo.end());
+        lelantusContainers.spendMetaInfo.insert(header.lelantusSpendMetaInfo.begin(), header.lelantusSpendMetaInfo.end());
+        lelantusContainers.CheckSurgeCondition();
+    } catch (const std::exception& e) {
+        LogPrintf("%s: failed to load the privacy state: %s\n", __func__, e.what());
+        sigmaState.Reset();
+        lelantusState.Reset();
+        return false;
+    }
+
+    hashStoredState = hashBlock;
+
+    LogPrintf("%s: privacy state at block %s loaded in %dms, %u sigma mints, %u lelantus mints\n", __func__,
+        hashBlock.ToString(), GetTimeMillis() - nStart,
+        sigmaState.GetMints().size(), lelantusState.GetMints().size());
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef FIRO_PRIVACYSTATEDB_H
+#define FIRO_PRIVACYSTATEDB_H
+
+#include "dbwrapper.h"
+#include "uint256.h"
+
+namespace sigma {
+class CSigmaState;
+}
+
+namespace lelantus {
+class CLelantusState;
+}
+
+//! Max memory allocated to the privacy state database cache (MiB)
+static const int64_t nPrivacyStateDBCache = 8;
+
+/**
+ * Sigma and Lelantus state (minted coins, used serials, coin groups) stored along
+ * with the hash of the block it was written at. At startup the state is loaded from
+ * here when that block is still the tip, instead of replaying every block of the chain.
+ * On any mismatch the caller rebuilds the state from the block index as before.
+ *
+ * The state is written as a whole on shutdown. Records are keyed by their position so
+ * a new snapshot overwrites the previous one, and the best block marker is only written
+ * once all the records are: an interrupted write leaves no usable state behind.
+ */
+class CPrivacyStateDB : public CDBWrapper
+{
+public:
+    CPrivacyStateDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+
+    //! Replaces the stored state with the given one, which must correspond to the block hashBlock
+    bool WriteState(const uint256& hashBlock, const sigma::CSigmaState& sigmaState, const lelantus::CLelantusState& lelantusState);
+
+    //! Loads the stored state if it was written at the block hashBlock of the active chain.
+    //! Returns false if there's no such state, in which case both states are reset
+    bool ReadState(const uint256& hashBlock, sigma::CSigmaState& sigmaState, lelantus::CLelantusState& lelantusState);
+
+private:
+    // block the state on disk corresponds to, to skip rewriting an unchanged state
+    uint256 hashStoredState;
+};
+
+extern CPrivacyStateDB *pprivacystatedb;
+
+#endif // FIRO_PRIVACYSTATEDB_H
@@ -48,6 +48,7 @@ void RPCNestedTests::rpcNestedTests()
     ForceSetArg("-datadir", path);
     //mempool.setSanityCheck(1.0);
     pblocktree = new CBlockTreeDB(1 << 20, true);
+    pindexdb = new CIndexDB(1 << 20, true);
     pcoinsdbview = new CCoinsViewDB(1 << 23, true);
     pcoinsTip = new CCoinsViewCache(pcoinsdbview);
     InitBlockIndex(chainparams);
@@ -151,6 +152,7 @@ void RPCNestedTests::rpcNestedTests()
     delete pcoinsTip;
     delete pcoinsdbview;
     delete pblocktree;
+    delete pindexdb;
 
     boost::filesystem::remove_all(boost::filesystem::path(path));
 }
@@ -0,0 +1,60 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rawblockcache.h"
+
+RawBlockPtr CRawBlockCache::Get(const uint256& hash)
+{
+    LOCK(cs);
+    auto it = mapBlocks.find(hash);
+    if (it == mapBlocks.end())
+        return nullptr;
+
+    blocks.splice(blocks.begin(), blocks, it->second);
+    return it->second->second;
+}
+
+void CRawBlockCache::Insert(const uint256& hash, const RawBlockPtr& block)
+{
+    if (!block || block->size() > nMaxSize)
+        return;
+
+    LOCK(cs);
+    auto it = mapBlocks.find(hash);
+    if (it != mapBlocks.end()) {
+        // the bytes of a block never change, only its place in the list does
+        blocks.splice(blocks.begin(), blocks, it->second);
+        return;
+    }
+
+    while (!blocks.empty() && nSize + block->size() > nMaxSize) {
+        nSize -= blocks.back().second->size();
+        mapBlocks.erase(blocks.back().first);
+        blocks.pop_back();
+    }
+
+    blocks.emplace_front(hash, block);
+    mapBlocks.emplace(hash, blocks.begin());
+    nSize += block->size();
+}
+
+void CRawBlockCache::Clear()
+{
+    LOCK(cs);
+    blocks.clear();
+    mapBlocks.clear();
+    nSize = 0;
+}
+
+size_t CRawBlockCache::Size() const
+{
+    LOCK(cs);
+    return nSize;
+}
+
+size_t CRawBlockCache::Count() const
+{
+    LOCK(cs);
+    return blocks.size();
+}
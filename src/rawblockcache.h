@@ -0,0 +1,50 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FIRO_RAWBLOCKCACHE_H
+#define FIRO_RAWBLOCKCACHE_H
+
+#include "sync.h"
+#include "uint256.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+typedef std::shared_ptr<const std::vector<unsigned char>> RawBlockPtr;
+
+/**
+ * Least recently used blocks served to peers, as stored on disk. Peers syncing from us
+ * request the same blocks one after the other, those are sent from memory instead of
+ * being read again from the block files.
+ *
+ * The cache is bounded by the total size of the blocks it holds, a block larger than
+ * the bound is never kept.
+ */
+class CRawBlockCache
+{
+private:
+    typedef std::list<std::pair<uint256, RawBlockPtr>> ListType;
+
+    mutable CCriticalSection cs;
+    // most recently used first
+    ListType blocks;
+    std::map<uint256, ListType::iterator> mapBlocks;
+    size_t nMaxSize;
+    size_t nSize;
+
+public:
+    explicit CRawBlockCache(size_t nMaxSizeIn) : nMaxSize(nMaxSizeIn), nSize(0) {}
+
+    /** Returns the block, or null if it isn't cached */
+    RawBlockPtr Get(const uint256& hash);
+    void Insert(const uint256& hash, const RawBlockPtr& block);
+    void Clear();
+
+    size_t Size() const;
+    size_t Count() const;
+};
+
+#endif // FIRO_RAWBLOCKCACHE_H
@@ -5,11 +5,13 @@
 
 #include "chain.h"
 #include "chainparams.h"
+#include "hash.h"
 #include "primitives/block.h"
 #include "primitives/transaction.h"
 #include "validation.h"
 #include "httpserver.h"
 #include "rpc/server.h"
+#include "sigma.h"
 #include "streams.h"
 #include "sync.h"
 #include "txmempool.h"
@@ -21,6 +23,7 @@
 #include <univalue.h>
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const size_t MAX_ANONYMITYSET_CHUNK_COINS = 16384; //coins returned by one /rest/anonymityset request
 
 enum RetFormat {
     RF_UNDEF,
@@ -591,6 +594,170 @@ static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
     return true; // continue to process further HTTP reqs on this cxn
 }
 
+// Sigma anonymity set as seen at one chain tip, shared by all the requests for its chunks.
+// Coins are kept oldest first: the coins of new blocks are appended, so the index of a coin
+// doesn't change while a client pages through the set
+struct CAnonymitySetSnapshot {
+    uint256 tipHash;
+    uint256 blockHash;
+    uint256 setHash;
+    std::vector<sigma::PublicCoin> coins;
+};
+
+static CCriticalSection cs_anonymitySetSnapshots;
+static std::map<std::pair<sigma::CoinDenomination, int>, std::shared_ptr<const CAnonymitySetSnapshot>> mapAnonymitySetSnapshots;
+
+static std::shared_ptr<const CAnonymitySetSnapshot> GetAnonymitySetSnapshot(sigma::CoinDenomination denomination, int coinGroupId)
+{
+    const std::pair<sigma::CoinDenomination, int> key(denomination, coinGroupId);
+    std::shared_ptr<const CAnonymitySetSnapshot> previous;
+    {
+        LOCK(cs_anonymitySetSnapshots);
+        auto it = mapAnonymitySetSnapshots.find(key);
+        if (it != mapAnonymitySetSnapshots.end())
+            previous = it->second;
+    }
+
+    auto snapshot = std::make_shared<CAnonymitySetSnapshot>();
+    // coins of the blocks after the previous snapshot, newest first
+    std::vector<sigma::PublicCoin> newCoins;
+    bool fAppend = false;
+    {
+        LOCK(cs_main);
+        snapshot->tipHash = chainActive.Tip()->GetBlockHash();
+        if (previous && previous->tipHash == snapshot->tipHash)
+            return previous;
+
+        // only the coins minted after the previous snapshot are copied under the lock,
+        // unless its latest block was disconnected since
+        const CBlockIndex *since = nullptr;
+        if (previous && !previous->blockHash.IsNull()) {
+            BlockMap::const_iterator mi = mapBlockIndex.find(previous->blockHash);
+            if (mi != mapBlockIndex.end() && chainActive.Contains(mi->second))
+                since = mi->second;
+        }
+
+        sigma::CSigmaState::GetState()->GetCoinSetForSpend(
+                &chainActive,
+                chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1),
+                denomination,
+                coinGroupId,
+                snapshot->blockHash,
+                newCoins,
+                since);
+        fAppend = since != nullptr;
+    }
+
+    if (fAppend) {
+        if (newCoins.empty())
+            snapshot->blockHash = previous->blockHash;
+        snapshot->coins.reserve(previous->coins.size() + newCoins.size());
+        snapshot->coins.insert(snapshot->coins.end(), previous->coins.begin(), previous->coins.end());
+    }
+    snapshot->coins.insert(snapshot->coins.end(), newCoins.rbegin(), newCoins.rend());
+
+    CHashWriter hasher(SER_GETHASH, PROTOCOL_VERSION);
+    hasher << (uint32_t)snapshot->coins.size();
+    for (const sigma::PublicCoin& coin : snapshot->coins)
+        hasher << coin.getValue();
+    snapshot->setHash = hasher.GetHash();
+
+    LOCK(cs_anonymitySetSnapshots);
+    mapAnonymitySetSnapshots[key] = snapshot;
+    return snapshot;
+}
+
+static bool rest_anonymityset(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2 && path.size() != 3)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Use /rest/anonymityset/<denomination>/<coinGroupId>[/<start>].<ext>.");
+
+    int64_t intDenom;
+    int32_t coinGroupId;
+    sigma::CoinDenomination denomination;
+    if (!ParseInt64(path[0], &intDenom) || !sigma::IntegerToDenomination(intDenom, denomination))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid denomination: " + path[0]);
+    if (!ParseInt32(path[1], &coinGroupId) || coinGroupId < 1)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid coin group id: " + path[1]);
+
+    // index of the first coin to return counting from the oldest one, to resume an interrupted download
+    int32_t start = 0;
+    if (path.size() == 3 && (!ParseInt32(path[2], &start) || start < 0))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid start: " + path[2]);
+
+    std::shared_ptr<const CAnonymitySetSnapshot> snapshot = GetAnonymitySetSnapshot(denomination, coinGroupId);
+    if ((size_t)start > snapshot->coins.size())
+        return RESTERR(req, HTTP_BAD_REQUEST, "Start out of range: " + path[2]);
+
+    const std::string etag = "\"" + snapshot->setHash.GetHex() + "\"";
+    std::pair<bool, std::string> ifNoneMatch = req->GetHeader("If-None-Match");
+    if (ifNoneMatch.first && ifNoneMatch.second == etag) {
+        req->WriteHeader("ETag", etag);
+        req->WriteReply(HTTP_NOT_MODIFIED);
+        return true;
+    }
+
+    size_t end = std::min(snapshot->coins.size(), start + MAX_ANONYMITYSET_CHUNK_COINS);
+    std::vector<GroupElement> chunk;
+    chunk.reserve(end - start);
+    for (size_t i = start; i < end; i++)
+        chunk.push_back(snapshot->coins[i].getValue());
+
+    req->WriteHeader("ETag", etag);
+    switch (rf) {
+    case RF_BINARY:
+    case RF_HEX: {
+        // latest block of the set, total number of coins, index of the first coin and the coins
+        CDataStream ssChunk(SER_NETWORK, PROTOCOL_VERSION);
+        ssChunk << snapshot->blockHash << (uint32_t)snapshot->coins.size() << (uint32_t)start << chunk;
+
+        if (rf == RF_BINARY) {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssChunk.str());
+        } else {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssChunk.begin(), ssChunk.end()) + "\n");
+        }
+        return true;
+    }
+
+    case RF_JSON: {
+        UniValue serializedCoins(UniValue::VARR);
+        for (const GroupElement& coin : chunk) {
+            std::vector<unsigned char> vch = coin.getvch();
+            serializedCoins.push_back(HexStr(vch.begin(), vch.end()));
+        }
+
+        UniValue objChunk(UniValue::VOBJ);
+        objChunk.push_back(Pair("blockHash", snapshot->blockHash.GetHex()));
+        objChunk.push_back(Pair("setHash", snapshot->setHash.GetHex()));
+        objChunk.push_back(Pair("total", (uint64_t)snapshot->coins.size()));
+        objChunk.push_back(Pair("start", start));
+        if (end < snapshot->coins.size())
+            objChunk.push_back(Pair("nextStart", (uint64_t)end));
+        objChunk.push_back(Pair("serializedCoins", serializedCoins));
+
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, objChunk.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+
+    // not reached
+    return true; // continue to process further HTTP reqs on this cxn
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(HTTPRequest* req, const std::string& strReq);
@@ -603,6 +770,7 @@ static const struct {
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
+      {"/rest/anonymityset/", rest_anonymityset},
 };
 
 bool StartREST()
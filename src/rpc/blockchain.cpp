@@ -1206,6 +1206,12 @@ UniValue getblockchaininfo(const JSONRPCRequest& request)
             "        \"timeout\": xx,         (numeric) the median time past of a block at which the deployment is considered failed if not yet locked in\n"
             "        \"since\": xx            (numeric) height of the first block to which the status applies\n"
             "     }\n"
+            "  },\n"
+            "  \"blockreads\": {            (object) proof of work checks of blocks read from disk\n"
+            "     \"verified\": xx,          (numeric) number of reads which checked proof of work\n"
+            "     \"trusted\": xx,           (numeric) number of reads of already validated blocks which skipped it\n"
+            "     \"verifytime\": xx,        (numeric) time spent checking, in microseconds\n"
+            "     \"skippedtime\": xx        (numeric) estimated time saved by the skipped checks, in microseconds\n"
             "  }\n"
             "}\n"
             "\nExamples:\n"
@@ -1246,6 +1252,14 @@ UniValue getblockchaininfo(const JSONRPCRequest& request)
 
         obj.push_back(Pair("pruneheight",        block->nHeight));
     }
+
+    CBlockReadStats readStats = GetBlockReadStats();
+    UniValue blockreads(UniValue::VOBJ);
+    blockreads.push_back(Pair("verified", readStats.nVerified));
+    blockreads.push_back(Pair("trusted", readStats.nTrusted));
+    blockreads.push_back(Pair("verifytime", readStats.nVerifyTime));
+    blockreads.push_back(Pair("skippedtime", readStats.nSkippedTimeEstimate));
+    obj.push_back(Pair("blockreads", blockreads));
     return obj;
 }
 
@@ -26,6 +26,7 @@
 #include <stdint.h>
 
 #include <boost/assign/list_of.hpp>
+#include <boost/optional.hpp>
 
 #include <univalue.h>
 
@@ -630,6 +631,88 @@ bool getZerocoinAddressesFromParams(const UniValue& params, std::vector<std::pai
     return true;
 }
 
+namespace {
+/* Paging of the address index RPCs: when "limit" is given, at most that many results are
+ * returned along with a "cursor", to pass to the next call to get the following ones.
+ * Pages go through the addresses in the order of their keys in the index. */
+template <typename Key>
+bool getPagingFromParams(const UniValue& params, size_t& limit, boost::optional<Key>& cursor)
+{
+    if (!params[0].isObject())
+        return false;
+
+    UniValue limitValue = find_value(params[0].get_obj(), "limit");
+    if (limitValue.isNull())
+        return false;
+    if (limitValue.get_int() <= 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "limit is expected to be positive");
+    limit = limitValue.get_int();
+
+    UniValue cursorValue = find_value(params[0].get_obj(), "cursor");
+    if (!cursorValue.isNull()) {
+        CDataStream ssKey(ParseHexV(cursorValue, "cursor"), SER_DISK, CLIENT_VERSION);
+        Key key;
+        try {
+            ssKey >> key;
+        } catch (const std::exception&) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        cursor = key;
+    }
+    return true;
+}
+
+template <typename Key>
+std::string encodeCursor(const Key& key)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << key;
+    return HexStr(ssKey.begin(), ssKey.end());
+}
+
+std::vector<std::pair<AddressType, uint160> > sortAddressesByKey(std::vector<std::pair<uint160, AddressType> > const & addresses)
+{
+    std::vector<std::pair<AddressType, uint160> > result;
+    for (auto const & address : addresses)
+        result.push_back(std::make_pair(address.second, address.first));
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+// Returns the cursor to resume the given address from, or null if the address is to be skipped
+// (before the cursor) or read from its beginning
+template <typename Key>
+const Key* getAddressCursor(std::pair<AddressType, uint160> const & address, boost::optional<Key> const & cursor, bool& fSkip)
+{
+    fSkip = false;
+    if (!cursor)
+        return nullptr;
+    std::pair<AddressType, uint160> cursorAddress(cursor->type, cursor->hashBytes);
+    fSkip = address < cursorAddress;
+    return address == cursorAddress ? &*cursor : nullptr;
+}
+
+// Reads up to limit address index entries of the addresses following the cursor, returns whether there may be more
+bool getAddressIndexPage(std::vector<std::pair<uint160, AddressType> > const & addresses, int start, int end, size_t limit,
+                         boost::optional<CAddressIndexKey> const & cursor,
+                         std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex)
+{
+    for (auto const & address : sortAddressesByKey(addresses)) {
+        bool fSkip;
+        const CAddressIndexKey* pCursor = getAddressCursor(address, cursor, fSkip);
+        if (fSkip)
+            continue;
+        if (!GetAddressIndex(address.second, address.first, addressIndex, start, end, pCursor, limit - addressIndex.size())) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+        if (addressIndex.size() == limit)
+            return true;
+    }
+    return false;
+}
+}
+
 bool heightSort(std::pair<CAddressUnspentKey, CAddressUnspentValue> a,
                 std::pair<CAddressUnspentKey, CAddressUnspentValue> b) {
     return a.second.blockHeight < b.second.blockHeight;
@@ -723,6 +806,8 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
                         "      \"address\"  (string) The base58check encoded address\n"
                         "      ,...\n"
                         "    ]\n"
+                        "  \"limit\" (number, optional) Return at most this many outputs, sorted by address and txid\n"
+                        "  \"cursor\" (string, optional) The cursor returned by the previous call, to get the next outputs\n"
                         "}\n"
                         "\nResult\n"
                         "[\n"
@@ -735,8 +820,14 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
                         "    \"height\"  (number) The block height\n"
                         "  }\n"
                         "]\n"
+                        "\nResult (with limit):\n"
+                        "{\n"
+                        "  \"utxos\"  (array) The outputs, as above\n"
+                        "  \"cursor\"  (string) Cursor of the next outputs, absent if there are no more\n"
+                        "}\n"
                         "\nExamples:\n"
                 + HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
+                + HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"], \"limit\": 1000}'")
                 + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
         );
 
@@ -748,13 +839,31 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
 
-    for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    size_t limit = 0;
+    boost::optional<CAddressUnspentKey> cursor;
+    bool fPaging = getPagingFromParams(request.params, limit, cursor);
+
+    if (fPaging) {
+        for (auto const & address : sortAddressesByKey(addresses)) {
+            bool fSkip;
+            const CAddressUnspentKey* pCursor = getAddressCursor(address, cursor, fSkip);
+            if (fSkip)
+                continue;
+            if (!GetAddressUnspent(address.second, address.first, unspentOutputs, pCursor, limit - unspentOutputs.size())) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
+            if (unspentOutputs.size() == limit)
+                break;
+        }
+    } else {
+        for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
         }
-    }
 
-    std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+        std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+    }
 
     UniValue result(UniValue::VARR);
 
@@ -774,6 +883,14 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
         result.push_back(output);
     }
 
+    if (fPaging) {
+        UniValue page(UniValue::VOBJ);
+        page.push_back(Pair("utxos", result));
+        if (unspentOutputs.size() == limit)
+            page.push_back(Pair("cursor", encodeCursor(unspentOutputs.back().first)));
+        return page;
+    }
+
     return result;
 }
 
@@ -792,6 +909,8 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
                         "    ]\n"
                         "  \"start\" (number) The start block height\n"
                         "  \"end\" (number) The end block height\n"
+                        "  \"limit\" (number, optional) Return at most this many deltas, sorted by address and height\n"
+                        "  \"cursor\" (string, optional) The cursor returned by the previous call, to get the next deltas\n"
                         "}\n"
                         "\nResult:\n"
                         "[\n"
@@ -804,7 +923,13 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
                         "    \"address\"  (string) The base58check encoded address\n"
                         "  }\n"
                         "]\n"
+                        "\nResult (with limit):\n"
+                        "{\n"
+                        "  \"deltas\"  (array) The deltas, as above\n"
+                        "  \"cursor\"  (string) Cursor of the next deltas, absent if there are no more\n"
+                        "}\n"
                         "\nExamples:\n"
+                + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"], \"limit\": 1000}'")
                 + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
                 + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
         );
@@ -832,14 +957,23 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
-    for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    size_t limit = 0;
+    boost::optional<CAddressIndexKey> cursor;
+    bool fPaging = getPagingFromParams(request.params, limit, cursor);
+    bool fMore = false;
+
+    if (fPaging) {
+        fMore = getAddressIndexPage(addresses, start, end, limit, cursor, addressIndex);
+    } else {
+        for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (start > 0 && end > 0) {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
+            } else {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
             }
         }
     }
@@ -862,6 +996,14 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
         result.push_back(delta);
     }
 
+    if (fPaging) {
+        UniValue page(UniValue::VOBJ);
+        page.push_back(Pair("deltas", result));
+        if (fMore)
+            page.push_back(Pair("cursor", encodeCursor(addressIndex.back().first)));
+        return page;
+    }
+
     return result;
 }
 
@@ -895,22 +1037,16 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
-    }
-
     CAmount balance = 0;
     CAmount received = 0;
 
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        if (it->second > 0) {
-            received += it->second;
+    for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+        CAddressBalanceValue addressBalance;
+        if (!GetAddressBalance((*it).first, (*it).second, addressBalance)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
-        balance += it->second;
+        balance += addressBalance.balance;
+        received += addressBalance.received;
     }
 
     UniValue result(UniValue::VOBJ);
@@ -923,7 +1059,7 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
 
 UniValue getanonymityset(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 2)
+    if (request.fHelp || request.params.size() < 2 || request.params.size() > 3)
         throw std::runtime_error(
                 "getanonymityset\n"
                         "\nReturns the anonymity set and latest block hash.\n"
@@ -931,13 +1067,15 @@ UniValue getanonymityset(const JSONRPCRequest& request)
                         "{\n"
                         "      \"denomination\"  (int64_t) int denomination\n"
                         "      \"coinGroupId\"  (int)\n"
+                        "      \"startBlockHash\"  (string, optional) blockHash of a previous call, only coins added after it are returned\n"
                         "}\n"
                         "\nResult:\n"
                         "{\n"
                         "  \"blockHash\"   (string) Latest block hash for anonymity set\n"
-                        "  \"anonymityset\"(std::string[]) array of Serialized GroupElements\n"
+                        "  \"anonymityset\"(std::string[]) array of Serialized GroupElements, latest first\n"
                         "}\n"
                 + HelpExampleCli("getanonymityset", "100000000 1")
+                + HelpExampleCli("getanonymityset", "100000000 1 \"ca0b1fa0b2fad4bcfec52f2c5bc6d5cf2f0a6bd4bbb9d3b2d3e4c2cc8f9e5d5a\"")
                 + HelpExampleRpc("getanonymityset", "\"100000000\", \"1\"")
         );
 
@@ -954,11 +1092,26 @@ UniValue getanonymityset(const JSONRPCRequest& request)
     sigma::CoinDenomination denomination;
     sigma::IntegerToDenomination(intDenom, denomination);
 
+    uint256 startBlockHash;
+    if (request.params.size() > 2) {
+        startBlockHash = uint256S(request.params[2].get_str());
+    }
+
     uint256 blockHash;
     std::vector<sigma::PublicCoin> coins;
 
     {
         LOCK(cs_main);
+        const CBlockIndex *startBlock = nullptr;
+        if (!startBlockHash.IsNull()) {
+            BlockMap::const_iterator it = mapBlockIndex.find(startBlockHash);
+            if (it == mapBlockIndex.end() || !chainActive.Contains(it->second))
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "startBlockHash is not in the active chain, get the full set");
+            startBlock = it->second;
+            // the set didn't change if no coins were added after it
+            blockHash = startBlockHash;
+        }
+
         sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
         sigmaState->GetCoinSetForSpend(
                 &chainActive,
@@ -966,7 +1119,8 @@ UniValue getanonymityset(const JSONRPCRequest& request)
                 denomination,
                 coinGroupId,
                 blockHash,
-                coins);
+                coins,
+                startBlock);
     }
 
     UniValue serializedCoins(UniValue::VARR);
@@ -1035,29 +1189,76 @@ UniValue getmintmetadata(const JSONRPCRequest& request)
 
 UniValue getusedcoinserials(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 0)
+    if (request.fHelp || request.params.size() > 2)
         throw std::runtime_error(
                 "getusedcoinserials\n"
                 "\nReturns the set of used coin serial.\n"
+                "\nArguments:\n"
+                "1. \"startNumber\" (int, optional) number of serials the client already has, only serials used after them are returned\n"
+                "2. \"tipHash\"     (string, required if startNumber is set) tipHash of the call startNumber was returned by\n"
                 "\nResult:\n"
                 "{\n"
-                "  \"serials\" (std::string[]) array of Serialized Scalars\n"
+                "  \"serials\"   (std::string[]) array of Serialized Scalars, in the order they were used\n"
+                "  \"total\"     (int) total number of used serials, startNumber of the next call\n"
+                "  \"tipHeight\" (int) height of the chain tip the serials were read at\n"
+                "  \"tipHash\"   (string) hash of the chain tip the serials were read at, tipHash of the next call\n"
                 "}\n"
+                + HelpExampleCli("getusedcoinserials", "")
+                + HelpExampleCli("getusedcoinserials", "1000 \"ca0b1fa0b2fad4bcfec52f2c5bc6d5cf2f0a6bd4bbb9d3b2d3e4c2cc8f9e5d5a\"")
         );
 
+    size_t startNumber = 0;
+    if (request.params.size() > 0) {
+        int64_t start;
+        try {
+            start = request.params[0].isNum() ? request.params[0].get_int64() : std::stoll(request.params[0].get_str());
+        } catch (std::logic_error const & e) {
+            throw std::runtime_error(std::string("An exception occurred while parsing parameters: ") + e.what());
+        }
+        if (start < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "startNumber must be non-negative");
+        startNumber = start;
+    }
+
+    uint256 startTipHash;
+    if (request.params.size() > 1)
+        startTipHash = uint256S(request.params[1].get_str());
+    if (startNumber > 0 && startTipHash.IsNull())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "tipHash is required with startNumber");
+
     sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
-    sigma::spend_info_container serials;
+    std::vector<Scalar> serials;
+    size_t total;
+    int tipHeight;
+    uint256 tipHash;
     {
         LOCK(cs_main);
-        serials = sigmaState->GetSpends();
+        // serials of disconnected blocks are removed from the end of the list, the first
+        // startNumber ones are unchanged as long as the tip they were read at is still in the chain
+        if (startNumber > 0) {
+            BlockMap::const_iterator it = mapBlockIndex.find(startTipHash);
+            if (it == mapBlockIndex.end() || !chainActive.Contains(it->second))
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "tipHash is not in the active chain, get the full set");
+        }
+
+        const std::vector<Scalar>& orderedSerials = sigmaState->GetOrderedSpends();
+        total = orderedSerials.size();
+        if (startNumber > total)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "startNumber is larger than the number of used serials");
+        serials.assign(orderedSerials.begin() + startNumber, orderedSerials.end());
+        tipHeight = chainActive.Height();
+        tipHash = chainActive.Tip()->GetBlockHash();
     }
 
     UniValue serializedSerials(UniValue::VARR);
     for ( auto it = serials.begin(); it != serials.end(); ++it )
-        serializedSerials.push_back(it->first.GetHex());
+        serializedSerials.push_back(it->GetHex());
 
     UniValue ret(UniValue::VOBJ);
     ret.push_back(Pair("serials", serializedSerials));
+    ret.push_back(Pair("total", (uint64_t)total));
+    ret.push_back(Pair("tipHeight", tipHeight));
+    ret.push_back(Pair("tipHash", tipHash.GetHex()));
 
     return ret;
 }
@@ -1117,14 +1318,22 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
                         "    ]\n"
                         "  \"start\" (number) The start block height\n"
                         "  \"end\" (number) The end block height\n"
+                        "  \"limit\" (number, optional) Read at most this many index entries, sorted by address and height\n"
+                        "  \"cursor\" (string, optional) The cursor returned by the previous call, to get the next txids\n"
                         "}\n"
                         "\nResult:\n"
                         "[\n"
                         "  \"transactionid\"  (string) The transaction id\n"
                         "  ,...\n"
                         "]\n"
+                        "\nResult (with limit):\n"
+                        "{\n"
+                        "  \"txids\"  (array) The transaction ids, as above\n"
+                        "  \"cursor\"  (string) Cursor of the next txids, absent if there are no more\n"
+                        "}\n"
                         "\nExamples:\n"
                 + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
+                + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"], \"limit\": 1000}'")
                 + HelpExampleRpc("getaddresstxids", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
         );
 
@@ -1147,14 +1356,34 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
-    for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    size_t limit = 0;
+    boost::optional<CAddressIndexKey> cursor;
+    bool fPaging = getPagingFromParams(request.params, limit, cursor);
+    bool fMore = false;
+
+    if (fPaging) {
+        fMore = getAddressIndexPage(addresses, start, end, limit, cursor, addressIndex);
+        if (fMore) {
+            // the entries of a transaction are contiguous in the index: leave those of the
+            // last one to the next page, unless it fills the whole page
+            CAddressIndexKey const & last = addressIndex.back().first;
+            auto it = addressIndex.end();
+            while (it != addressIndex.begin() && (it - 1)->first.txhash == last.txhash
+                   && (it - 1)->first.hashBytes == last.hashBytes && (it - 1)->first.type == last.type)
+                --it;
+            if (it != addressIndex.begin())
+                addressIndex.erase(it, addressIndex.end());
+        }
+    } else {
+        for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (start > 0 && end > 0) {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
+            } else {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
             }
         }
     }
@@ -1166,7 +1395,7 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
         int height = it->first.blockHeight;
         std::string txid = it->first.txhash.GetHex();
 
-        if (addresses.size() > 1) {
+        if (addresses.size() > 1 && !fPaging) {
             txids.insert(std::make_pair(height, txid));
         } else {
             if (txids.insert(std::make_pair(height, txid)).second) {
@@ -1175,12 +1404,20 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
         }
     }
 
-    if (addresses.size() > 1) {
+    if (addresses.size() > 1 && !fPaging) {
         for (std::set<std::pair<int, std::string> >::const_iterator it=txids.begin(); it!=txids.end(); it++) {
             result.push_back(it->second);
         }
     }
 
+    if (fPaging) {
+        UniValue page(UniValue::VOBJ);
+        page.push_back(Pair("txids", result));
+        if (fMore)
+            page.push_back(Pair("cursor", encodeCursor(addressIndex.back().first)));
+        return page;
+    }
+
     return result;
 
 }
@@ -1252,7 +1489,7 @@ UniValue gettotalsupply(const JSONRPCRequest& request)
     CAmount total = 0;
 
     if(!pblocktree->ReadTotalSupply(total))
-        throw JSONRPCError(RPC_DATABASE_ERROR, "Cannot read the total supply from the database. This functionality requires -addressindex to be enabled. Enabling -addressindex requires reindexing.");
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Cannot read the total supply from the database. This functionality requires -addressindex to be enabled and built.");
 
     UniValue result(UniValue::VOBJ);
     result.push_back(Pair("total", total));
@@ -1317,6 +1554,25 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCBlockIndexMemoryInfo()
+{
+    LOCK(cs_main);
+    uint64_t withPrivacyData = 0;
+    uint64_t privacyUsage = 0;
+    for (const auto& entry : mapBlockIndex) {
+        size_t usage = entry.second->PrivacyIndexDynamicUsage();
+        if (usage > 0)
+            withPrivacyData++;
+        privacyUsage += usage;
+    }
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("count", uint64_t(mapBlockIndex.size())));
+    obj.push_back(Pair("size", uint64_t(mapBlockIndex.size() * sizeof(CBlockIndex))));
+    obj.push_back(Pair("privacy_entries", withPrivacyData));
+    obj.push_back(Pair("privacy_usage", privacyUsage));
+    return obj;
+}
+
 UniValue getmemoryinfo(const JSONRPCRequest& request)
 {
     /* Please, avoid using the word "pool" here in the RPC interface or help,
@@ -1335,6 +1591,12 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
             "    \"locked\": xxxxxx,       (numeric) Amount of bytes that succeeded locking. If this number is smaller than total, locking pages failed at some point and key data could be swapped to disk.\n"
             "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
             "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
+            "  },\n"
+            "  \"blockindex\": {           (json object) Information about the in-memory block index\n"
+            "    \"count\": xxxxx,         (numeric) Number of block index entries\n"
+            "    \"size\": xxxxx,          (numeric) Bytes used by the entries themselves\n"
+            "    \"privacy_entries\": xxx, (numeric) Number of entries holding Sigma/Lelantus/Zerocoin/spork data\n"
+            "    \"privacy_usage\": xxxxx, (numeric) Heap bytes used by that data\n"
             "  }\n"
             "}\n"
             "\nExamples:\n"
@@ -1343,6 +1605,7 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
         );
     UniValue obj(UniValue::VOBJ);
     obj.push_back(Pair("locked", RPCLockedMemoryInfo()));
+    obj.push_back(Pair("blockindex", RPCBlockIndexMemoryInfo()));
     return obj;
 }
 
@@ -0,0 +1,53 @@
+#ifndef SECP_FIXEDBASEMULTIEXPONENT_H
+#define SECP_FIXEDBASEMULTIEXPONENT_H
+
+#include <vector>
+#include "../include/GroupElement.h"
+#include "../include/Scalar.h"
+
+namespace secp_primitives {
+
+/**
+ * Multi-exponentiation over a set of generators which never change (e.g. the
+ * Sigma/Bulletproofs generators in lelantus::Params).
+ *
+ * Generators are normalized to affine coordinates once, when the object is
+ * built, so every get_multiple() call skips the per-point field inversion
+ * MultiExponent has to do, and feeds the points straight to the Pippenger
+ * buckets. For the first generators of the set tables of odd multiples are
+ * precomputed as well, so small sums run Strauss' algorithm without building
+ * any table. Large sums are split over the threads set with
+ * MultiExponent::set_parallelism(), like MultiExponent splits them. The object
+ * is immutable after construction and may be shared between threads.
+ */
+class FixedBaseMultiExponent {
+public:
+    explicit FixedBaseMultiExponent(const std::vector<GroupElement>& generators);
+    ~FixedBaseMultiExponent();
+
+    FixedBaseMultiExponent(const FixedBaseMultiExponent&) = delete;
+    FixedBaseMultiExponent& operator=(const FixedBaseMultiExponent&) = delete;
+
+    std::size_t size() const { return n_points; }
+
+    // Returns sum(powers[i] * generators[i]). powers may be shorter than the generator
+    // set, missing and zero powers are skipped.
+    GroupElement get_multiple(const std::vector<Scalar>& powers) const;
+
+    // Same as above, additionally adding sum(extra_powers[j] * extra_points[j]) for
+    // points which are not known in advance, all in a single multi-exponentiation.
+    GroupElement get_multiple(
+            const std::vector<Scalar>& powers,
+            const std::vector<GroupElement>& extra_points,
+            const std::vector<Scalar>& extra_powers) const;
+
+private:
+    void  *pt_; // secp256k1_ge[]
+    void  *pre_; // secp256k1_ge[], odd multiples of the first n_tables generators
+    std::size_t n_points;
+    std::size_t n_tables;
+};
+
+}// namespace secp_primitives
+
+#endif //SECP_FIXEDBASEMULTIEXPONENT_H
@@ -108,6 +108,7 @@ public:
   GroupElement& set_base_g();
 
   friend class MultiExponent;
+  friend class FixedBaseMultiExponent;
 private:
     // Returns the secp object inside it.
     const void * get_value() const;
@@ -15,6 +15,12 @@ public:
 
     GroupElement get_multiple();
 
+    static const std::size_t DEFAULT_PARALLEL_THRESHOLD = 16384;
+
+    // Sums of at least `threshold` points are split into contiguous parts computed on up to
+    // `threads` threads and added together. Applies to all instances, off (1 thread) by default.
+    static void set_parallelism(unsigned int threads, std::size_t threshold = DEFAULT_PARALLEL_THRESHOLD);
+
 private:
     void  *sc_; // secp256k1_scalar[]
     void  *pt_; // secp256k1_gej[]
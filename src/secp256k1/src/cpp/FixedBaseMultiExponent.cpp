@@ -0,0 +1,264 @@
+#include "../include/FixedBaseMultiExponent.h"
+#include "parallel.h"
+
+#include "../include/secp256k1.h"
+#include "../field.h"
+#include "../field_impl.h"
+#include "../group.h"
+#include "../group_impl.h"
+#include "../scalar.h"
+#include "../scalar_impl.h"
+#include "../ecmult.h"
+#include "../ecmult_impl.h"
+#include "../src/scratch_impl.h"
+#include "../src/ecmult_impl.h"
+
+#include <algorithm>
+
+/* wNAF window of the precomputed odd multiples tables. As the tables are built
+ * once, it can be one bit wider than WINDOW_A used by the generic Strauss path. */
+#define FIXED_BASE_WINDOW 6
+
+/* Odd multiples tables are kept for at most this many generators, which is
+ * 88KiB per 64 generators. */
+#define FIXED_BASE_MAX_TABLES 256
+
+/* Sums of up to this many points are computed with Strauss' algorithm over the
+ * precomputed tables, larger ones with Pippenger's. */
+#define FIXED_BASE_STRAUSS_THRESHOLD 128
+
+#ifdef USE_ENDOMORPHISM
+#define FIXED_BASE_WNAF_BITS 130
+#else
+#define FIXED_BASE_WNAF_BITS 256
+#endif
+
+namespace {
+
+/* Fills pre[0..n) with a, 3a, 5a, ... in jacobian coordinates. */
+void fixed_base_odd_multiples(secp256k1_gej *pre, int n, const secp256k1_gej *a) {
+    secp256k1_gej d;
+    secp256k1_gej_double_var(&d, a, NULL);
+    pre[0] = *a;
+    for (int i = 1; i < n; ++i)
+        secp256k1_gej_add_var(&pre[i], &pre[i - 1], &d, NULL);
+}
+
+struct fixed_base_point {
+    const secp256k1_ge *pre; // ECMULT_TABLE_SIZE(FIXED_BASE_WINDOW) odd multiples
+#ifdef USE_ENDOMORPHISM
+    int wnaf_1[FIXED_BASE_WNAF_BITS];
+    int wnaf_lam[FIXED_BASE_WNAF_BITS];
+    int bits_1;
+    int bits_lam;
+#else
+    int wnaf[FIXED_BASE_WNAF_BITS];
+    int bits;
+#endif
+};
+
+}
+
+namespace secp_primitives {
+
+FixedBaseMultiExponent::FixedBaseMultiExponent(const std::vector<GroupElement>& generators)
+        : pt_(new secp256k1_ge[generators.size()])
+        , pre_(NULL)
+        , n_points(generators.size())
+        , n_tables(std::min(generators.size(), (std::size_t)FIXED_BASE_MAX_TABLES))
+{
+    const std::size_t table_size = ECMULT_TABLE_SIZE(FIXED_BASE_WINDOW);
+
+    // Normalize all the generators and their tables with a single (batched) field inversion.
+    std::vector<secp256k1_gej> gej(n_points + n_tables * table_size);
+    for (std::size_t i = 0; i < n_points; ++i)
+        gej[i] = *reinterpret_cast<const secp256k1_gej *>(generators[i].get_value());
+    for (std::size_t i = 0; i < n_tables; ++i)
+        fixed_base_odd_multiples(&gej[n_points + i * table_size], table_size, &gej[i]);
+
+    if (gej.empty())
+        return;
+
+    std::vector<secp256k1_ge> ge(gej.size());
+    secp256k1_ge_set_all_gej_var(ge.data(), gej.data(), gej.size(), NULL);
+
+    std::copy(ge.begin(), ge.begin() + n_points, reinterpret_cast<secp256k1_ge *>(pt_));
+    pre_ = new secp256k1_ge[n_tables * table_size];
+    std::copy(ge.begin() + n_points, ge.end(), reinterpret_cast<secp256k1_ge *>(pre_));
+}
+
+FixedBaseMultiExponent::~FixedBaseMultiExponent(){
+    delete []reinterpret_cast<secp256k1_ge *>(pt_);
+    delete []reinterpret_cast<secp256k1_ge *>(pre_);
+}
+
+GroupElement FixedBaseMultiExponent::get_multiple(const std::vector<Scalar>& powers) const {
+    return get_multiple(powers, std::vector<GroupElement>(), std::vector<Scalar>());
+}
+
+GroupElement FixedBaseMultiExponent::get_multiple(
+        const std::vector<Scalar>& powers,
+        const std::vector<GroupElement>& extra_points,
+        const std::vector<Scalar>& extra_powers) const {
+    const std::size_t table_size = ECMULT_TABLE_SIZE(FIXED_BASE_WINDOW);
+    const secp256k1_ge *pt = reinterpret_cast<const secp256k1_ge *>(pt_);
+    const secp256k1_ge *pre = reinterpret_cast<const secp256k1_ge *>(pre_);
+
+    std::size_t n_fixed = std::min(powers.size(), n_points);
+    std::size_t n_extra = std::min(extra_points.size(), extra_powers.size());
+
+    // Skip zero powers and infinity points, as both algorithms below do.
+    std::vector<std::size_t> fixed_idx, extra_idx;
+    fixed_idx.reserve(n_fixed);
+    extra_idx.reserve(n_extra);
+    for (std::size_t i = 0; i < n_fixed; ++i) {
+        if (!powers[i].isZero() && !secp256k1_ge_is_infinity(&pt[i]))
+            fixed_idx.push_back(i);
+    }
+    for (std::size_t i = 0; i < n_extra; ++i) {
+        if (!extra_powers[i].isZero() && !extra_points[i].isInfinity())
+            extra_idx.push_back(i);
+    }
+
+    std::size_t no = fixed_idx.size() + extra_idx.size();
+    if (no == 0)
+        return GroupElement();
+
+    secp256k1_gej r;
+
+    if (no <= FIXED_BASE_STRAUSS_THRESHOLD && (fixed_idx.empty() || fixed_idx.back() < n_tables)) {
+        // Strauss: one shared doubling chain, adding table entries for all points.
+        std::vector<secp256k1_ge> extra_pre(extra_idx.size() * table_size);
+        if (!extra_idx.empty()) {
+            std::vector<secp256k1_gej> extra_prej(extra_pre.size());
+            for (std::size_t i = 0; i < extra_idx.size(); ++i)
+                fixed_base_odd_multiples(&extra_prej[i * table_size], table_size,
+                    reinterpret_cast<const secp256k1_gej *>(extra_points[extra_idx[i]].get_value()));
+            secp256k1_ge_set_all_gej_var(extra_pre.data(), extra_prej.data(), extra_prej.size(), NULL);
+        }
+
+        std::vector<fixed_base_point> ps(no);
+        for (std::size_t np = 0; np < no; ++np) {
+            const secp256k1_scalar *s;
+            if (np < fixed_idx.size()) {
+                ps[np].pre = pre + fixed_idx[np] * table_size;
+                s = reinterpret_cast<const secp256k1_scalar *>(powers[fixed_idx[np]].get_value());
+            } else {
+                std::size_t i = np - fixed_idx.size();
+                ps[np].pre = extra_pre.data() + i * table_size;
+                s = reinterpret_cast<const secp256k1_scalar *>(extra_powers[extra_idx[i]].get_value());
+            }
+#ifdef USE_ENDOMORPHISM
+            secp256k1_scalar s_1, s_lam;
+            secp256k1_scalar_split_lambda(&s_1, &s_lam, s);
+            ps[np].bits_1 = secp256k1_ecmult_wnaf(ps[np].wnaf_1, FIXED_BASE_WNAF_BITS, &s_1, FIXED_BASE_WINDOW);
+            ps[np].bits_lam = secp256k1_ecmult_wnaf(ps[np].wnaf_lam, FIXED_BASE_WNAF_BITS, &s_lam, FIXED_BASE_WINDOW);
+#else
+            ps[np].bits = secp256k1_ecmult_wnaf(ps[np].wnaf, FIXED_BASE_WNAF_BITS, s, FIXED_BASE_WINDOW);
+#endif
+        }
+
+        int bits = 0;
+        for (std::size_t np = 0; np < no; ++np) {
+#ifdef USE_ENDOMORPHISM
+            bits = std::max(bits, std::max(ps[np].bits_1, ps[np].bits_lam));
+#else
+            bits = std::max(bits, ps[np].bits);
+#endif
+        }
+
+        secp256k1_gej_set_infinity(&r);
+        for (int i = bits - 1; i >= 0; --i) {
+            int n;
+            secp256k1_ge tmpa;
+            secp256k1_gej_double_var(&r, &r, NULL);
+            for (std::size_t np = 0; np < no; ++np) {
+#ifdef USE_ENDOMORPHISM
+                if (i < ps[np].bits_1 && (n = ps[np].wnaf_1[i])) {
+                    ECMULT_TABLE_GET_GE(&tmpa, ps[np].pre, n, FIXED_BASE_WINDOW);
+                    secp256k1_gej_add_ge_var(&r, &r, &tmpa, NULL);
+                }
+                if (i < ps[np].bits_lam && (n = ps[np].wnaf_lam[i])) {
+                    ECMULT_TABLE_GET_GE(&tmpa, ps[np].pre, n, FIXED_BASE_WINDOW);
+                    secp256k1_ge_mul_lambda(&tmpa, &tmpa);
+                    secp256k1_gej_add_ge_var(&r, &r, &tmpa, NULL);
+                }
+#else
+                if (i < ps[np].bits && (n = ps[np].wnaf[i])) {
+                    ECMULT_TABLE_GET_GE(&tmpa, ps[np].pre, n, FIXED_BASE_WINDOW);
+                    secp256k1_gej_add_ge_var(&r, &r, &tmpa, NULL);
+                }
+#endif
+            }
+        }
+
+        return GroupElement(&r);
+    }
+
+    // Pippenger over the already affine generators.
+#ifdef USE_ENDOMORPHISM
+    const std::size_t entries_per_point = 2;
+#else
+    const std::size_t entries_per_point = 1;
+#endif
+
+    std::vector<secp256k1_ge> extra(extra_idx.size());
+    if (!extra_idx.empty()) {
+        std::vector<secp256k1_gej> gej(extra_idx.size());
+        for (std::size_t i = 0; i < extra_idx.size(); ++i)
+            gej[i] = *reinterpret_cast<const secp256k1_gej *>(extra_points[extra_idx[i]].get_value());
+        secp256k1_ge_set_all_gej_var(extra.data(), gej.data(), gej.size(), NULL);
+    }
+
+    std::vector<secp256k1_ge> points(no * entries_per_point);
+    std::vector<secp256k1_scalar> scalars(no * entries_per_point);
+    for (std::size_t np = 0; np < no; ++np) {
+        std::size_t idx = np * entries_per_point;
+        if (np < fixed_idx.size()) {
+            points[idx] = pt[fixed_idx[np]];
+            scalars[idx] = *reinterpret_cast<const secp256k1_scalar *>(powers[fixed_idx[np]].get_value());
+        } else {
+            std::size_t i = np - fixed_idx.size();
+            points[idx] = extra[i];
+            scalars[idx] = *reinterpret_cast<const secp256k1_scalar *>(extra_powers[extra_idx[i]].get_value());
+        }
+#ifdef USE_ENDOMORPHISM
+        secp256k1_ecmult_endo_split(&scalars[idx], &scalars[idx + 1], &points[idx], &points[idx + 1]);
+#endif
+    }
+
+    // r = sum(scalars[i] * points[i]) for i in [begin, end)
+    auto pippenger = [&points, &scalars, entries_per_point](std::size_t begin, std::size_t end, secp256k1_gej *r) {
+        int bucket_window = secp256k1_pippenger_bucket_window((end - begin) / entries_per_point);
+        std::vector<secp256k1_gej> buckets(1 << bucket_window);
+        std::vector<int> wnaf((end - begin) * WNAF_SIZE(bucket_window + 1));
+        std::vector<secp256k1_pippenger_point_state> ps(end - begin);
+
+        secp256k1_pippenger_state state;
+        state.wnaf_na = wnaf.data();
+        state.ps = ps.data();
+
+        secp256k1_ecmult_pippenger_wnaf(buckets.data(), bucket_window, &state, r, scalars.data() + begin, points.data() + begin, end - begin);
+    };
+
+    // Large sums are split into contiguous parts on the workers MultiExponent uses.
+    std::size_t n_parts = parallel_parts(no);
+    if (n_parts <= 1) {
+        pippenger(0, points.size(), &r);
+        return GroupElement(&r);
+    }
+
+    std::vector<secp256k1_gej> partial(n_parts);
+    std::size_t n = points.size();
+    run_parallel(n_parts, [&pippenger, n, n_parts, &partial](std::size_t t) {
+        pippenger(n * t / n_parts, n * (t + 1) / n_parts, &partial[t]);
+    });
+
+    r = partial[0];
+    for (std::size_t t = 1; t < n_parts; ++t)
+        secp256k1_gej_add_var(&r, &r, &partial[t], NULL);
+
+    return GroupElement(&r);
+}
+
+}// namespace secp_primitives
@@ -1,4 +1,5 @@
 #include "../include/MultiExponent.h"
+#include "parallel.h"
 
 #include "../include/secp256k1.h"
 #include "../field.h"
@@ -12,6 +13,15 @@
 #include "../src/scratch_impl.h"
 #include "../src/ecmult_impl.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
 
 typedef struct {
     secp256k1_scalar *sc;
@@ -25,8 +35,191 @@ int ecmult_multi_callback(secp256k1_scalar *sc, secp256k1_gej *pt, size_t idx, v
     return 1;
 }
 
+namespace {
+
+/* Threads never get fewer points than this, below it splitting costs more than it saves. */
+#define MULTIEXP_PARALLEL_MIN_POINTS 4096
+
+std::atomic<unsigned int> parallel_threads(1);
+std::atomic<std::size_t> parallel_threshold(secp_primitives::MultiExponent::DEFAULT_PARALLEL_THRESHOLD);
+
+struct ParallelBatch {
+    std::mutex m;
+    std::condition_variable cv;
+};
+
+/* A part of a sum, run by whichever of a worker or the calling thread claims it first. */
+struct ParallelPart {
+    enum { QUEUED, RUNNING, DONE };
+
+    std::atomic<int> state;
+    std::function<void()> run;
+    std::shared_ptr<ParallelBatch> batch;
+
+    ParallelPart() : state(QUEUED) {}
+
+    bool run_if_queued() {
+        int expected = QUEUED;
+        if (!state.compare_exchange_strong(expected, RUNNING))
+            return false;
+        run();
+        {
+            std::lock_guard<std::mutex> lock(batch->m);
+            state = DONE;
+        }
+        batch->cv.notify_all();
+        return true;
+    }
+};
+
+/* Returns once none of the parts can run anymore: the queued ones are dropped, the running ones waited for.
+ * The parts reference the caller's frame, so this runs on every way out of it. */
+class ParallelPartsGuard {
+public:
+    explicit ParallelPartsGuard(const std::shared_ptr<ParallelBatch>& batch) : batch_(batch) {}
+
+    ~ParallelPartsGuard() {
+        for (auto& part : parts) {
+            int expected = ParallelPart::QUEUED;
+            part->state.compare_exchange_strong(expected, ParallelPart::DONE);
+        }
+        std::unique_lock<std::mutex> lock(batch_->m);
+        batch_->cv.wait(lock, [this] {
+            return std::all_of(parts.begin(), parts.end(), [](const std::shared_ptr<ParallelPart>& part) {
+                return part->state == ParallelPart::DONE;
+            });
+        });
+    }
+
+    std::vector<std::shared_ptr<ParallelPart>> parts;
+
+private:
+    std::shared_ptr<ParallelBatch> batch_;
+};
+
+/* Workers shared by all the sums, however many threads compute sums at the same time. */
+class ParallelWorkers {
+public:
+    ~ParallelWorkers() {
+        resize(0);
+    }
+
+    /* Replaces the workers by n new ones, returns how many could be started. */
+    std::size_t resize(std::size_t n) {
+        std::lock_guard<std::mutex> resize_lock(resize_m);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+        threads.clear();
+        {
+            // parts left in the queue are run by their callers
+            std::lock_guard<std::mutex> lock(m);
+            queue.clear();
+            stopping = false;
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            try {
+                threads.emplace_back(&ParallelWorkers::loop, this);
+            } catch (const std::system_error&) {
+                break;
+            }
+        }
+        return threads.size();
+    }
+
+    void push(const std::vector<std::shared_ptr<ParallelPart>>& parts) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            queue.insert(queue.end(), parts.begin(), parts.end());
+        }
+        cv.notify_all();
+    }
+
+private:
+    void loop() {
+        while (true) {
+            std::shared_ptr<ParallelPart> part;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping)
+                    return;
+                part = queue.front();
+                queue.pop_front();
+            }
+            part->run_if_queued();
+        }
+    }
+
+    std::mutex resize_m;
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<ParallelPart>> queue;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+};
+
+ParallelWorkers& parallel_workers() {
+    static ParallelWorkers workers;
+    return workers;
+}
+
+/* r = sum(sc[i] * pt[i]) for i in [0, n) */
+void ecmult_multi_range(const secp256k1_scalar *sc, const secp256k1_gej *pt, std::size_t n, secp256k1_gej *r) {
+    ecmult_multi_data data;
+    data.sc = const_cast<secp256k1_scalar *>(sc);
+    data.pt = const_cast<secp256k1_gej *>(pt);
+
+    secp256k1_scratch *scratch;
+    if (n > ECMULT_PIPPENGER_THRESHOLD) {
+        int bucket_window = secp256k1_pippenger_bucket_window(n);
+        size_t scratch_size = secp256k1_pippenger_scratch_size(n, bucket_window);
+        scratch = secp256k1_scratch_create(NULL, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
+    } else {
+        size_t scratch_size = secp256k1_strauss_scratch_size(n);
+        scratch = secp256k1_scratch_create(NULL, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
+    }
+
+    secp256k1_ecmult_context ctx;
+
+    secp256k1_ecmult_multi_var(&ctx, scratch, r, NULL, ecmult_multi_callback, &data, n);
+
+    secp256k1_scratch_destroy(scratch);
+}
+
+}
+
 namespace secp_primitives {
 
+std::size_t parallel_parts(std::size_t n_points) {
+    std::size_t n_threads = parallel_threads;
+    if (n_points < parallel_threshold)
+        return 1;
+    return std::min(n_threads, std::max<std::size_t>(n_points / MULTIEXP_PARALLEL_MIN_POINTS, 1));
+}
+
+/* The parts no worker took yet are run by the calling thread too, so it never waits behind
+ * the parts of other sums. */
+void run_parallel(std::size_t n_parts, const std::function<void(std::size_t)>& part) {
+    auto batch = std::make_shared<ParallelBatch>();
+    ParallelPartsGuard guard(batch);
+    for (std::size_t t = 1; t < n_parts; ++t) {
+        guard.parts.push_back(std::make_shared<ParallelPart>());
+        guard.parts.back()->run = [&part, t] { part(t); };
+        guard.parts.back()->batch = batch;
+    }
+    parallel_workers().push(guard.parts);
+
+    part(0);
+    for (auto& queued : guard.parts)
+        queued->run_if_queued();
+}
+
 MultiExponent::MultiExponent(const MultiExponent& other)
         : sc_(new secp256k1_scalar[other.n_points])
         , pt_(new secp256k1_gej[other.n_points])
@@ -55,28 +248,36 @@ MultiExponent::~MultiExponent(){
     delete []reinterpret_cast<secp256k1_gej *>(pt_);
 }
 
-GroupElement MultiExponent::get_multiple() {
-    secp256k1_gej r;
+void MultiExponent::set_parallelism(unsigned int threads, std::size_t threshold) {
+    // the calling thread computes a part itself
+    std::size_t workers = parallel_workers().resize(std::max(threads, 1u) - 1);
+    parallel_threads = workers + 1;
+    parallel_threshold = threshold;
+}
 
-    ecmult_multi_data data;
-    data.sc = reinterpret_cast<secp256k1_scalar *>(sc_);
-    data.pt = reinterpret_cast<secp256k1_gej *>(pt_);
+GroupElement MultiExponent::get_multiple() {
+    const secp256k1_scalar *sc = reinterpret_cast<secp256k1_scalar *>(sc_);
+    const secp256k1_gej *pt = reinterpret_cast<secp256k1_gej *>(pt_);
 
-    secp256k1_scratch *scratch;
-    if (n_points > ECMULT_PIPPENGER_THRESHOLD) {
-        int bucket_window = secp256k1_pippenger_bucket_window(n_points);
-        size_t scratch_size = secp256k1_pippenger_scratch_size(n_points, bucket_window);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
-    } else {
-        size_t scratch_size = secp256k1_strauss_scratch_size(n_points);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
+    std::size_t n_threads = parallel_parts(n_points);
+    if (n_threads <= 1) {
+        secp256k1_gej r;
+        ecmult_multi_range(sc, pt, n_points, &r);
+        return reinterpret_cast<secp256k1_scalar *>(&r);
     }
 
-    secp256k1_ecmult_context ctx;
-
-    secp256k1_ecmult_multi_var(&ctx, scratch, &r, NULL, ecmult_multi_callback, &data, n_points);
+    // Each thread sums a contiguous part of the points.
+    std::vector<secp256k1_gej> partial(n_threads);
+    std::size_t n = n_points;
+    run_parallel(n_threads, [sc, pt, n, n_threads, &partial](std::size_t t) {
+        std::size_t begin = n * t / n_threads;
+        std::size_t end = n * (t + 1) / n_threads;
+        ecmult_multi_range(sc + begin, pt + begin, end - begin, &partial[t]);
+    });
 
-    secp256k1_scratch_destroy(scratch);
+    secp256k1_gej r = partial[0];
+    for (std::size_t t = 1; t < n_threads; ++t)
+        secp256k1_gej_add_var(&r, &r, &partial[t], NULL);
 
     return  reinterpret_cast<secp256k1_scalar *>(&r);
 }
@@ -0,0 +1,19 @@
+#ifndef SECP_PARALLEL_H
+#define SECP_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace secp_primitives {
+
+/* Number of parts a sum of n_points points is split into with the parallelism set by
+ * MultiExponent::set_parallelism(), 1 if the calling thread computes it alone. */
+std::size_t parallel_parts(std::size_t n_points);
+
+/* Runs part(t) for t in [0, n_parts) on the workers shared by all the sums, part 0 on the
+ * calling thread. Returns once all the parts are done. */
+void run_parallel(std::size_t n_parts, const std::function<void(std::size_t)>& part);
+
+}// namespace secp_primitives
+
+#endif //SECP_PARALLEL_H
@@ -13,6 +13,7 @@
 #include "sigma/coin.h"
 #include "primitives/mint_spend.h"
 #include "batchproof_container.h"
+#include "privacyproof_check.h"
 
 #include <atomic>
 #include <sstream>
@@ -185,7 +186,8 @@ bool CheckSigmaSpendTransaction(
         int nRealHeight,
         bool isCheckWallet,
         bool fStatefulSigmaCheck,
-        CSigmaTxInfo *sigmaTxInfo) {
+        CSigmaTxInfo *sigmaTxInfo,
+        std::vector<CPrivacyProofCheck> *pvProofChecks) {
     bool hasSigmaSpendInputs = false, hasNonSigmaInputs = false;
     int vinIndex = -1;
     std::unordered_set<Scalar, sigma::CScalarHash> txSerials;
@@ -199,7 +201,7 @@ bool CheckSigmaSpendTransaction(
 
     for (const CTxIn &txin : tx.vin)
     {
-        std::unique_ptr<sigma::CoinSpend> spend;
+        std::shared_ptr<sigma::CoinSpend> spend;
         uint32_t coinGroupId;
 
         vinIndex++;
@@ -295,12 +297,21 @@ bool CheckSigmaSpendTransaction(
         }
 
         BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
-        // if we are collecting proofs, skip verification and collect proofs
-        passVerify = spend->Verify(anonymity_set, newMetaData, fPadding, batchProofContainer->fCollectProofs);
-
-        // add proofs into container
-        if(batchProofContainer->fCollectProofs) {
-            batchProofContainer->add(spend.get(), fPadding, coinGroupId, anonymity_set.size(), nHeight >= params.nStartSigmaBlacklist);
+        // proofs are collected only while connecting a block, never for mempool transactions
+        bool useBatching = batchProofContainer->fCollectProofs && !isVerifyDB && !isCheckWallet && sigmaTxInfo && !sigmaTxInfo->fInfoIsComplete;
+        if (pvProofChecks) {
+            // proof is verified later by the check queue, the state checks below don't depend on it
+            pvProofChecks->emplace_back(spend, std::move(anonymity_set), newMetaData, fPadding, coinGroupId,
+                                        nHeight >= params.nStartSigmaBlacklist, useBatching, hashTx, nHeight);
+            passVerify = true;
+        } else {
+            // if we are collecting proofs, skip verification and collect proofs
+            passVerify = spend->Verify(anonymity_set, newMetaData, fPadding, useBatching);
+
+            // add proofs into container
+            if(useBatching) {
+                batchProofContainer->add(spend.get(), fPadding, coinGroupId, anonymity_set.size(), nHeight >= params.nStartSigmaBlacklist, hashTx);
+            }
         }
 
         if (passVerify) {
@@ -424,7 +435,8 @@ bool CheckSigmaTransaction(
         int nHeight,
         bool isCheckWallet,
         bool fStatefulSigmaCheck,
-        CSigmaTxInfo *sigmaTxInfo)
+        CSigmaTxInfo *sigmaTxInfo,
+        std::vector<CPrivacyProofCheck> *pvProofChecks)
 {
     Consensus::Params const & consensus = ::Params().GetConsensus();
 
@@ -508,7 +520,7 @@ bool CheckSigmaTransaction(
         if (!isVerifyDB) {
             if (!CheckSigmaSpendTransaction(
                 tx, denominations, state, hashTx, isVerifyDB, nHeight, realHeight,
-                isCheckWallet, fStatefulSigmaCheck, sigmaTxInfo)) {
+                isCheckWallet, fStatefulSigmaCheck, sigmaTxInfo, pvProofChecks)) {
                     return false;
             }
         }
@@ -789,6 +801,8 @@ void CSigmaState::Containers::RemoveMint(sigma::PublicCoin const & pubCoin) {
 }
 
 void CSigmaState::Containers::AddSpend(Scalar const & serial, CSpendCoinInfo const & coinInfo) {
+    if (usedCoinSerials.count(serial) == 0)
+        orderedCoinSerials.push_back(serial);
     usedCoinSerials[serial] = coinInfo;
     spendMetaInfo[coinInfo.coinGroupId][coinInfo.denomination] += 1;
     CheckSurgeCondition(coinInfo.coinGroupId, coinInfo.denomination);
@@ -800,6 +814,10 @@ void CSigmaState::Containers::RemoveSpend(Scalar const & serial) {
         spendMetaInfo[iter->second.coinGroupId][iter->second.denomination] -= 1;
         CSpendCoinInfo tmpSpendInfo(iter->second);
         usedCoinSerials.erase(iter);
+        // serials are removed when their block is disconnected, so they are near the end
+        auto orderIter = std::find(orderedCoinSerials.rbegin(), orderedCoinSerials.rend(), serial);
+        if (orderIter != orderedCoinSerials.rend())
+            orderedCoinSerials.erase(std::next(orderIter).base());
         CheckSurgeCondition(tmpSpendInfo.coinGroupId, tmpSpendInfo.denomination);
     }
 }
@@ -812,6 +830,10 @@ spend_info_container const & CSigmaState::Containers::GetSpends() const {
     return usedCoinSerials;
 }
 
+std::vector<Scalar> const & CSigmaState::Containers::GetOrderedSpends() const {
+    return orderedCoinSerials;
+}
+
 bool CSigmaState::Containers::IsSurgeCondition() const {
     return surgeCondition;
 }
@@ -819,6 +841,7 @@ bool CSigmaState::Containers::IsSurgeCondition() const {
 void CSigmaState::Containers::Reset() {
     mintedPubCoins.clear();
     usedCoinSerials.clear();
+    orderedCoinSerials.clear();
     mintMetaInfo.clear();
     spendMetaInfo.clear();
     surgeCondition = false;
@@ -1040,7 +1063,8 @@ int CSigmaState::GetCoinSetForSpend(
         sigma::CoinDenomination denomination,
         int coinGroupID,
         uint256& blockHash_out,
-        std::vector<sigma::PublicCoin>& coins_out) {
+        std::vector<sigma::PublicCoin>& coins_out,
+        const CBlockIndex *since) {
 
     coins_out.clear();
 
@@ -1051,10 +1075,17 @@ int CSigmaState::GetCoinSetForSpend(
 
     SigmaCoinGroupInfo coinGroup = coinGroups[denomAndId];
 
+    // no coins were added to the group after since
+    if (since && since->nHeight >= coinGroup.lastBlock->nHeight
+            && since->GetAncestor(coinGroup.lastBlock->nHeight) == coinGroup.lastBlock)
+        return 0;
+
     int numberOfCoins = 0;
     for (CBlockIndex *block = coinGroup.lastBlock;
             ;
             block = block->pprev) {
+        if (block == since)
+            break;
         if (block->sigmaMintedPubCoins.count(denomAndId) > 0 &&
                 block->sigmaMintedPubCoins[denomAndId].size() > 0) {
             if (block->nHeight <= maxHeight) {
@@ -1086,7 +1117,8 @@ void CSigmaState::GetAnonymitySet(
         sigma::CoinDenomination denomination,
         int coinGroupID,
         bool fStartSigmaBlacklist,
-        std::vector<GroupElement>& coins_out) {
+        std::vector<GroupElement>& coins_out,
+        bool fUpToLastBlock) {
 
     coins_out.clear();
 
@@ -1098,6 +1130,8 @@ void CSigmaState::GetAnonymitySet(
     SigmaCoinGroupInfo coinGroup = coinGroups[denomAndId];
     auto params = ::Params().GetConsensus();
     int maxHeight = fStartSigmaBlacklist ? (chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1)) : (params.nStartSigmaBlacklist - 1);
+    if (fUpToLastBlock)
+        maxHeight = coinGroup.lastBlock->nHeight;
 
     for (CBlockIndex *block = coinGroup.lastBlock;
             ;
@@ -1213,6 +1247,10 @@ spend_info_container const & CSigmaState::GetSpends() const {
     return containers.GetSpends();
 }
 
+std::vector<Scalar> const & CSigmaState::GetOrderedSpends() const {
+    return containers.GetOrderedSpends();
+}
+
 std::unordered_map<std::pair<CoinDenomination, int>, CSigmaState::SigmaCoinGroupInfo, CSigmaState::pairhash> const & CSigmaState::GetCoinGroups() const {
     return coinGroups;
 }
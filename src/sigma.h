@@ -14,6 +14,9 @@
 #include <functional>
 #include "coin_containers.h"
 
+class CPrivacyProofCheck;
+class CPrivacyStateDB;
+
 //tests
 namespace sigma_mintspend_many { class sigma_mintspend_many; }
 namespace sigma_mintspend { class sigma_mintspend_test; }
@@ -70,7 +73,8 @@ bool CheckSigmaTransaction(
 	int nHeight,
   bool isCheckWallet,
   bool fStatefulSigmaCheck,
-  CSigmaTxInfo *sigmaTxInfo);
+  CSigmaTxInfo *sigmaTxInfo,
+  std::vector<CPrivacyProofCheck> *pvProofChecks = NULL);
 
 void DisconnectTipSigma(CBlock &block, CBlockIndex *pindexDelete);
 
@@ -149,7 +153,8 @@ public:
     bool HasCoinHash(GroupElement &pubCoinValue, const uint256 &pubCoinValueHash);
 
     // Given denomination and id returns latest accumulator value and corresponding block hash
-    // Do not take into account coins with height more than maxHeight
+    // Do not take into account coins with height more than maxHeight, nor coins minted up to the block
+    // `since` if given, so a client which has the set up to that block only gets the new coins
     // Returns number of coins satisfying conditions
     int GetCoinSetForSpend(
         CChain *chain,
@@ -157,13 +162,17 @@ public:
         sigma::CoinDenomination denomination,
         int id,
         uint256& blockHash_out,
-        std::vector<sigma::PublicCoin>& coins_out);
+        std::vector<sigma::PublicCoin>& coins_out,
+        const CBlockIndex *since = nullptr);
 
+    // Coins minted in the last ZC_MINT_CONFIRMATIONS-1 blocks are left out, unless fUpToLastBlock is set:
+    // then all the coins of the group are returned, like the spends of the block being connected may use
     void GetAnonymitySet(
             sigma::CoinDenomination denomination,
             int coinGroupID,
             bool fStartSigmaBlacklist,
-            std::vector<GroupElement>& coins_out);
+            std::vector<GroupElement>& coins_out,
+            bool fUpToLastBlock = false);
 
     // Return height of mint transaction and id of minted coin
     std::pair<int, int> GetMintedCoinHeightAndId(const sigma::PublicCoin& pubCoin);
@@ -202,6 +211,8 @@ public:
 
     mint_info_container const & GetMints() const;
     spend_info_container const & GetSpends() const;
+    // Used serials in the order they were added to the state, a disconnected block removes its serials
+    std::vector<Scalar> const & GetOrderedSpends() const;
     std::unordered_map<std::pair<CoinDenomination, int>, SigmaCoinGroupInfo, pairhash> const & GetCoinGroups() const ;
     std::unordered_map<CoinDenomination, int> const & GetLatestCoinIds() const;
     std::unordered_map<Scalar, uint256, sigma::CScalarHash> const & GetMempoolCoinSerials() const;
@@ -237,6 +248,7 @@ private:
 
         mint_info_container const & GetMints() const;
         spend_info_container const & GetSpends() const;
+        std::vector<Scalar> const & GetOrderedSpends() const;
         bool IsSurgeCondition() const;
     private:
         // Set of all minted pubCoin values, keyed by the public coin.
@@ -244,6 +256,8 @@ private:
         mint_info_container mintedPubCoins;
         // Set of all used coin serials.
         spend_info_container usedCoinSerials;
+        // Same serials in the order they were used, for clients syncing them incrementally
+        std::vector<Scalar> orderedCoinSerials;
 
         std::atomic<bool> & surgeCondition;
 
@@ -256,6 +270,7 @@ private:
         friend class zerocoin_tests3_v3::zerocoin_mintspend_v3;
         friend class sigma_mintspend::sigma_mintspend_test;
         friend class sigma_partialspend_mempool_tests::partialspend;
+        friend class ::CPrivacyStateDB;
     };
 
     Containers containers;
@@ -264,6 +279,7 @@ private:
     friend class zerocoin_tests3_v3::zerocoin_mintspend_v3;
     friend class sigma_mintspend::sigma_mintspend_test;
     friend class sigma_partialspend_mempool_tests::partialspend;
+    friend class ::CPrivacyStateDB;
 };
 
 } // end of namespace sigma.
@@ -96,7 +96,7 @@ bool CoinSpend::Verify(
         const SpendMetaData& m,
         bool fPadding,
         bool fSkipVerification) const {
-    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m());
+    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m(), &params->get_h_multiexp());
     //compute inverse of g^s
     GroupElement gs = (params->get_g() * coinSerialNumber).inverse();
     std::vector<GroupElement> C_;
@@ -47,6 +47,7 @@ Params::Params(const GroupElement& g, int n, int m) :
         h_[i - 1].sha256(buff);
         h_[i].generate(buff);
     }
+    h_multiexp_.reset(new FixedBaseMultiExponent(h_));
 }
 
 Params::~Params(){
@@ -64,6 +65,10 @@ const std::vector<GroupElement>& Params::get_h() const{
     return h_;
 }
 
+const FixedBaseMultiExponent& Params::get_h_multiexp() const{
+    return *h_multiexp_;
+}
+
 uint64_t Params::get_n() const{
     return n_;
 }
@@ -9,7 +9,8 @@ class R1ProofVerifier {
 public:
     R1ProofVerifier(const GroupElement& g,
             const std::vector<GroupElement>& h_gens,
-            const GroupElement& B, int n , int m);
+            const GroupElement& B, int n , int m,
+            const secp_primitives::FixedBaseMultiExponent* h_multiexp = nullptr);
 
     bool verify(const R1Proof<Exponent, GroupElement>& proof,
                 bool skip_final_response_verification = false) const;
@@ -29,6 +30,7 @@ private:
     GroupElement B_Commit;
     int n_;
     int m_;
+    const secp_primitives::FixedBaseMultiExponent* h_multiexp_;
 };
 
 } // namespace sigma
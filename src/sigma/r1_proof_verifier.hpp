@@ -6,12 +6,14 @@ R1ProofVerifier<Exponent,GroupElement>::R1ProofVerifier(
         const std::vector<GroupElement>& h_gens,
         const GroupElement& B,
         int n ,
-        int m)
+        int m,
+        const secp_primitives::FixedBaseMultiExponent* h_multiexp)
     : g_(g)
     , h_(h_gens)
     , B_Commit(B)
     , n_(n)
-    , m_(m){
+    , m_(m)
+    , h_multiexp_(h_multiexp){
 }
 
 template<class Exponent, class GroupElement>
@@ -84,7 +86,10 @@ bool R1ProofVerifier<Exponent,GroupElement>::verify_final_response(
     }
 
     GroupElement one;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_out, proof.ZA_, one);
+    if (h_multiexp_)
+        one = h_multiexp_->get_multiple(f_out, {g_}, {proof.ZA_});
+    else
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_out, proof.ZA_, one);
     if((B_Commit * challenge_x + proof.A_) != one)
         return false;
 
@@ -95,7 +100,10 @@ bool R1ProofVerifier<Exponent,GroupElement>::verify_final_response(
     }
 
     GroupElement two;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_outprime, proof.ZC_, two);
+    if (h_multiexp_)
+        two = h_multiexp_->get_multiple(f_outprime, {g_}, {proof.ZC_});
+    else
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_outprime, proof.ZC_, two);
     if ((proof.C_ * challenge_x + proof.D_) != two)
         return false;
 
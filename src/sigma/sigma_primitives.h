@@ -2,6 +2,7 @@
 #define FIRO_SIGMA_SIGMA_PRIMITIVES_H
 
 #include "../secp256k1/include/MultiExponent.h"
+#include "../secp256k1/include/FixedBaseMultiExponent.h"
 #include "../secp256k1/include/GroupElement.h"
 #include "../secp256k1/include/Scalar.h"
 
@@ -9,9 +9,12 @@ template<class Exponent, class GroupElement>
 class SigmaPlusVerifier{
 
 public:
+    // h_multiexp, if given, is a precomputed multi-exponentiation over h_gens,
+    // it is kept by pointer and should outlive the verifier
     SigmaPlusVerifier(const GroupElement& g,
                       const std::vector<GroupElement>& h_gens,
-                      int n, int m_);
+                      int n, int m_,
+                      const secp_primitives::FixedBaseMultiExponent* h_multiexp = nullptr);
 
     bool verify(const std::vector<GroupElement>& commits,
                 const SigmaPlusProof<Exponent, GroupElement>& proof,
@@ -45,6 +48,7 @@ private:
     std::vector<GroupElement> h_;
     int n;
     int m;
+    const secp_primitives::FixedBaseMultiExponent* h_multiexp_;
 };
 
 } // namespace sigma
@@ -7,11 +7,13 @@ SigmaPlusVerifier<Exponent, GroupElement>::SigmaPlusVerifier(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         int n,
-        int m)
+        int m,
+        const secp_primitives::FixedBaseMultiExponent* h_multiexp)
     : g_(g)
     , h_(h_gens)
     , n(n)
-    , m(m){
+    , m(m)
+    , h_multiexp_(h_multiexp){
 }
 
 template<class Exponent, class GroupElement>
@@ -20,7 +22,7 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
         const SigmaPlusProof<Exponent, GroupElement>& proof,
         bool fPadding) const {
 
-    R1ProofVerifier<Exponent, GroupElement> r1ProofVerifier(g_, h_, proof.B_, n, m);
+    R1ProofVerifier<Exponent, GroupElement> r1ProofVerifier(g_, h_, proof.B_, n, m, h_multiexp_);
     std::vector<Exponent> f;
     const R1Proof<Exponent, GroupElement>& r1Proof = proof.r1Proof_;
     if (!r1ProofVerifier.verify(r1Proof, f, true /* Skip verification of final response */)) {
@@ -346,6 +348,16 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::abcd_checks(
     for(std::size_t i = 0; i < f_.size(); i++)
         f_plus_f_prime.emplace_back(f_[i] * c + f_[i] * (x - f_[i]));
 
+    if (h_multiexp_) {
+        // Comm(..) - (B^x * A)^c - C^x * D computed as a single multi-exponentiation, it should be infinity
+        Exponent one(uint64_t(1));
+        GroupElement check = h_multiexp_->get_multiple(
+                f_plus_f_prime,
+                {g_, proof.B_, proof.r1Proof_.A_, proof.r1Proof_.C_, proof.r1Proof_.D_},
+                {proof.r1Proof_.ZA_ * c + proof.r1Proof_.ZC_, (x * c).negate(), c.negate(), x.negate(), one.negate()});
+        return check.isInfinity();
+    }
+
     GroupElement right;
     SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_plus_f_prime, proof.r1Proof_.ZA_ * c + proof.r1Proof_.ZC_, right);
     if(((proof.B_ * x + proof.r1Proof_.A_) * c + proof.r1Proof_.C_ * x + proof.r1Proof_.D_) != right)
@@ -357,4 +357,62 @@ struct CAddressIndexIteratorHeightKey {
     }
 };
 
+/** Aggregate of all the address index deltas of an address, so its balance doesn't require
+ *  reading its whole history. Kept up to date along with the address index */
+struct CAddressBalanceValue {
+    CAmount balance;
+    CAmount received;
+    int64_t txCount;
+    int firstHeight;
+    int lastHeight;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(balance);
+        READWRITE(received);
+        READWRITE(txCount);
+        READWRITE(firstHeight);
+        READWRITE(lastHeight);
+    }
+
+    CAddressBalanceValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        balance = 0;
+        received = 0;
+        txCount = 0;
+        firstHeight = 0;
+        lastHeight = 0;
+    }
+
+    bool IsNull() const {
+        return txCount == 0;
+    }
+};
+
+/** Change of the CAddressBalanceValue of an address brought by the transactions of one block */
+struct CAddressBalanceDelta {
+    CAmount balance;
+    CAmount received;
+    int64_t txCount;
+    // last transaction counted, the deltas of a transaction are added one after another
+    uint256 lastTxHash;
+
+    CAddressBalanceDelta() : balance(0), received(0), txCount(0) {}
+
+    void Add(const CAddressIndexKey& key, CAmount amount) {
+        balance += amount;
+        if (amount > 0)
+            received += amount;
+        if (txCount == 0 || key.txhash != lastTxHash) {
+            txCount++;
+            lastTxHash = key.txhash;
+        }
+    }
+};
+
 #endif // BITCOIN_SPENTINDEX_H
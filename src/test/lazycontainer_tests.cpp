@@ -0,0 +1,82 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "clientversion.h"
+#include "lazycontainer.h"
+#include "memusage.h"
+#include "streams.h"
+
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <set>
+
+BOOST_FIXTURE_TEST_SUITE(lazycontainer_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(lazycontainer_allocation)
+{
+    lazycontainer<std::map<int, std::vector<int>>> m;
+    BOOST_CHECK(!m.allocated());
+    BOOST_CHECK(m.empty());
+    BOOST_CHECK_EQUAL(m.count(1), 0);
+    BOOST_CHECK(m.find(1) == m.end());
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(m), 0);
+
+    // iterating and erasing don't allocate
+    for (auto& entry : m)
+        BOOST_FAIL("unexpected entry " << entry.first);
+    BOOST_CHECK_EQUAL(m.erase(1), 0);
+    BOOST_CHECK(!m.allocated());
+
+    m[1].push_back(2);
+    m[{3}].push_back(4);
+    BOOST_CHECK(m.allocated());
+    BOOST_CHECK_EQUAL(m.size(), 2);
+    BOOST_CHECK_EQUAL(m.at(3)[0], 4);
+    BOOST_CHECK(memusage::DynamicUsage(m) > 0);
+
+    BOOST_CHECK_EQUAL(m.erase(1), 1);
+    BOOST_CHECK_EQUAL(m.erase(3), 1);
+    BOOST_CHECK(!m.allocated());
+
+    m[5];
+    m.clear();
+    BOOST_CHECK(!m.allocated());
+
+    // assigning an empty container doesn't allocate either
+    m = std::map<int, std::vector<int>>();
+    BOOST_CHECK(!m.allocated());
+}
+
+BOOST_AUTO_TEST_CASE(lazycontainer_copy_serialize)
+{
+    lazycontainer<std::set<int>> s;
+    s.insert(1);
+    s.insert(2);
+
+    lazycontainer<std::set<int>> copy(s);
+    BOOST_CHECK(copy == s);
+    copy.insert(3);
+    BOOST_CHECK_EQUAL(s.size(), 2);
+    BOOST_CHECK_EQUAL(copy.size(), 3);
+
+    // serialized the same way as the wrapped container
+    CDataStream ss(SER_DISK, CLIENT_VERSION), ssPlain(SER_DISK, CLIENT_VERSION);
+    ss << s;
+    ssPlain << std::set<int>{1, 2};
+    BOOST_CHECK(ss.str() == ssPlain.str());
+
+    lazycontainer<std::set<int>> read;
+    ss >> read;
+    BOOST_CHECK(read == s);
+
+    lazycontainer<std::set<int>> empty, readEmpty;
+    ss << empty;
+    ss >> readEmpty;
+    BOOST_CHECK(!readEmpty.allocated());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
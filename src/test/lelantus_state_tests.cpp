@@ -1,4 +1,6 @@
 #include "../lelantus.h"
+#include "../privacystatedb.h"
+#include "../sigma.h"
 #include "../validation.h"
 
 #include "fixtures.h"
@@ -330,6 +332,40 @@ BOOST_AUTO_TEST_CASE(add_remove_block)
     lelantusState->Reset();
 }
 
+BOOST_AUTO_TEST_CASE(remove_block_drops_tags)
+{
+    GroupElement mint1, mint2, mint3;
+    mint1.randomize();
+    mint2.randomize();
+    mint3.randomize();
+    auto tag1 = GetRandHash(), tag2 = GetRandHash();
+
+    auto index1 = GenerateBlock({});
+    auto block1 = GetCBlock(index1);
+    PopulateLelantusTxInfo(block1, {{mint1, {1, tag1}}}, {});
+    lelantusState->AddMintsToStateAndBlockIndex(index1, &block1);
+
+    // a coin minted without a tag and one with a tag in the same block
+    auto index2 = GenerateBlock({});
+    auto block2 = GetCBlock(index2);
+    PopulateLelantusTxInfo(block2, {{mint2, {1, tag2}}, {mint3, {1, uint256()}}}, {});
+    lelantusState->AddMintsToStateAndBlockIndex(index2, &block2);
+
+    GroupElement tagged;
+    BOOST_CHECK(lelantusState->HasCoinTag(tagged, tag2));
+    BOOST_CHECK(tagged == mint2);
+    BOOST_CHECK(lelantusState->HasCoinTag(tagged, uint256()));
+
+    lelantusState->RemoveBlock(index2);
+
+    BOOST_CHECK(!lelantusState->HasCoinTag(tagged, tag2));
+    BOOST_CHECK(!lelantusState->HasCoinTag(tagged, uint256()));
+    BOOST_CHECK(lelantusState->HasCoinTag(tagged, tag1));
+    BOOST_CHECK(tagged == mint1);
+
+    lelantusState->Reset();
+}
+
 BOOST_AUTO_TEST_CASE(get_coin_group)
 {
     GenerateBlocks(120);
@@ -505,6 +541,102 @@ BOOST_AUTO_TEST_CASE(get_coin_group)
     lelantusState->Reset();
 }
 
+BOOST_AUTO_TEST_CASE(anonymity_set_cache)
+{
+    CLelantusState state;
+    auto indexes = GenerateMintsInBlocks(state, {2, 3});
+
+    auto set1 = state.GetAnonymitySetSnapshot(1, indexes[0], false, false);
+    BOOST_CHECK_EQUAL(2, set1->coins().size());
+    BOOST_CHECK_EQUAL(2, set1->nMintedCoins);
+
+    // latest block goes first, the rest is taken from the snapshot of the older block
+    auto set2 = state.GetAnonymitySetSnapshot(1, indexes[1], false, false);
+    BOOST_CHECK_EQUAL(5, set2->coins().size());
+    BOOST_CHECK_EQUAL(5, set2->nMintedCoins);
+    BOOST_CHECK(indexes[1]->lelantusMintedPubCoins[1][0].first == set2->coins()[0]);
+    BOOST_CHECK(std::equal(set1->coins().begin(), set1->coins().end(), set2->coins().begin() + 3));
+
+    // the older coins are not copied, the new ones are put in front of them
+    BOOST_CHECK_EQUAL(set1->buffer, set2->buffer);
+    BOOST_CHECK_EQUAL(set1->coins().begin(), set2->coins().begin() + 3);
+
+    // snapshots are shared
+    BOOST_CHECK_EQUAL(set2, state.GetAnonymitySetSnapshot(1, indexes[1], false, false));
+    BOOST_CHECK(set2 != state.GetAnonymitySetSnapshot(1, indexes[1], true, false));
+
+    // disconnecting block forgets only the sets ending at it
+    state.RemoveBlock(indexes[1]);
+    indexes[1]->lelantusMintedPubCoins.clear();
+
+    BOOST_CHECK_EQUAL(set1, state.GetAnonymitySetSnapshot(1, indexes[0], false, false));
+    auto set3 = state.GetAnonymitySetSnapshot(1, indexes[1], false, false);
+    BOOST_CHECK(set2 != set3);
+    BOOST_CHECK(std::equal(set1->coins().begin(), set1->coins().end(), set3->coins().begin(), set3->coins().end()));
+
+    // the slots in front of set1 are taken by set2, which is still alive, so set3 doesn't reuse them
+    BOOST_CHECK(std::equal(set1->coins().begin(), set1->coins().end(), set2->coins().begin() + 3));
+
+    state.Reset();
+}
+
+BOOST_AUTO_TEST_CASE(persist_state)
+{
+    auto indexes = GenerateMintsInBlocks(*lelantusState, {2, 3});
+    auto spendIndex = GenerateSpendGroups(*lelantusState, {{1, 2}});
+
+    auto sigmaState = sigma::CSigmaState::GetState();
+    CPrivacyStateDB db(1 << 20, true);
+
+    auto tip = chainActive.Tip()->GetBlockHash();
+    BOOST_CHECK(db.WriteState(tip, *sigmaState, *lelantusState));
+
+    auto mints = lelantusState->GetMints();
+    auto spends = lelantusState->GetSpends();
+    auto groups = lelantusState->GetCoinGroups();
+    auto latestCoinId = lelantusState->GetLatestCoinID();
+    GroupElement tagged;
+    BOOST_CHECK(lelantusState->HasCoinTag(tagged, uint256()));
+
+    // state stored at another block is not loaded
+    BOOST_CHECK(!db.ReadState(indexes[1]->GetBlockHash(), *sigmaState, *lelantusState));
+    BOOST_CHECK_EQUAL(0, lelantusState->GetMints().size());
+
+    BOOST_CHECK(db.ReadState(tip, *sigmaState, *lelantusState));
+
+    BOOST_CHECK_EQUAL(mints.size(), lelantusState->GetMints().size());
+    for (auto const &mint : mints) {
+        auto it = lelantusState->GetMints().find(mint.first);
+        BOOST_CHECK(it != lelantusState->GetMints().end());
+        BOOST_CHECK_EQUAL(mint.second.coinGroupId, it->second.coinGroupId);
+        BOOST_CHECK_EQUAL(mint.second.nHeight, it->second.nHeight);
+    }
+
+    BOOST_CHECK(spends == lelantusState->GetSpends());
+    BOOST_CHECK_EQUAL(latestCoinId, lelantusState->GetLatestCoinID());
+
+    BOOST_CHECK_EQUAL(groups.size(), lelantusState->GetCoinGroups().size());
+    for (auto const &group : groups) {
+        auto const &loaded = lelantusState->GetCoinGroups().at(group.first);
+        BOOST_CHECK_EQUAL(group.second.firstBlock, loaded.firstBlock);
+        BOOST_CHECK_EQUAL(group.second.lastBlock, loaded.lastBlock);
+        BOOST_CHECK_EQUAL(group.second.nCoins, loaded.nCoins);
+    }
+
+    GroupElement loadedTagged;
+    BOOST_CHECK(lelantusState->HasCoinTag(loadedTagged, uint256()));
+    BOOST_CHECK(tagged == loadedTagged);
+
+    // a smaller state replaces the stored one altogether
+    lelantusState->RemoveBlock(spendIndex);
+    BOOST_CHECK(db.WriteState(indexes[1]->GetBlockHash(), *sigmaState, *lelantusState));
+    BOOST_CHECK(db.ReadState(indexes[1]->GetBlockHash(), *sigmaState, *lelantusState));
+    BOOST_CHECK_EQUAL(mints.size(), lelantusState->GetMints().size());
+    BOOST_CHECK_EQUAL(0, lelantusState->GetSpends().size());
+
+    lelantusState->Reset();
+}
+
 // Surge condition testing
 #define Undetected BOOST_CHECK(!state.IsSurgeConditionDetected())
 #define Detected BOOST_CHECK(state.IsSurgeConditionDetected())
@@ -1,5 +1,7 @@
+#include "../batchproof_container.h"
 #include "../chainparams.h"
 #include "../lelantus.h"
+#include "../privacyproof_check.h"
 #include "../script/standard.h"
 #include "../validation.h"
 #include "../wallet/coincontrol.h"
@@ -599,6 +601,46 @@ BOOST_AUTO_TEST_CASE(checktransaction)
         }
     }
 
+    // proof verification can be deferred to the check queue
+    info = CLelantusTxInfo();
+    std::vector<CPrivacyProofCheck> vProofChecks;
+    BOOST_CHECK(CheckLelantusTransaction(
+        joinsplitTx, state, joinsplitTx.GetHash(), false, chainActive.Height(), false, true, NULL, &info, &vProofChecks));
+    BOOST_CHECK_EQUAL(1, vProofChecks.size());
+    BOOST_CHECK_EQUAL(serials.size(), info.spentSerials.size());
+    BOOST_CHECK(vProofChecks[0]());
+
+    // proofs of a block can be collected and batch verified before the block is accepted
+    BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
+    uint256 blockHash = chainActive.Tip()->GetBlockHash();
+    std::set<uint256> failedTxs;
+
+    info = CLelantusTxInfo();
+    batchProofContainer->fCollectProofs = true;
+    batchProofContainer->init(blockHash);
+    BOOST_CHECK(CheckLelantusTransaction(
+        joinsplitTx, state, joinsplitTx.GetHash(), false, chainActive.Height(), false, true, NULL, &info));
+    BOOST_CHECK(batchProofContainer->verify_block(failedTxs));
+    BOOST_CHECK(failedTxs.empty());
+    BOOST_CHECK(!batchProofContainer->fCollectProofs);
+
+    // an invalid proof among valid ones is singled out
+    info = CLelantusTxInfo();
+    batchProofContainer->fCollectProofs = true;
+    batchProofContainer->init(blockHash);
+    BOOST_CHECK(CheckLelantusTransaction(
+        joinsplitTx, state, joinsplitTx.GetHash(), false, chainActive.Height(), false, true, NULL, &info));
+    bool fLelantusFixes = chainActive.Height() >= consensus.nLelantusFixesStartBlock;
+    std::map<uint32_t, size_t> setSizes;
+    for (auto id : ids) {
+        setSizes[id] = lelantusState->GetAnonymitySet(id, fLelantusFixes)->nCoins;
+    }
+    // same proofs with a wrong challenge
+    uint256 invalidTxHash = ArithToUint256(1);
+    batchProofContainer->add(joinsplit.get(), setSizes, Scalar(uint64_t(1)), {}, fLelantusFixes, invalidTxHash);
+    BOOST_CHECK(!batchProofContainer->verify_block(failedTxs));
+    BOOST_CHECK(failedTxs == std::set<uint256>({invalidTxHash}));
+
     info = CLelantusTxInfo();
     BOOST_CHECK(CheckLelantusTransaction(
         joinsplitTx, state, joinsplitTx.GetHash(), false, INT_MAX, false, true, NULL, &info));
@@ -615,6 +657,32 @@ BOOST_AUTO_TEST_CASE(checktransaction)
         joinsplitTx, state, joinsplitTx.GetHash(), false, INT_MAX, false, true, NULL, &info));
 }
 
+BOOST_AUTO_TEST_CASE(batch_verify_newest_set)
+{
+    GenerateBlocks(1000);
+
+    std::vector<CMutableTransaction> mintTxs;
+    GenerateMints({3 * COIN, 3 * COIN}, mintTxs);
+    auto mintBlockIdx = GenerateBlock(mintTxs);
+    BOOST_CHECK(mintBlockIdx);
+
+    // the wallet only spends coins with a confirmation on top of the block minting them
+    GenerateBlock();
+    auto jsTx = GenerateJoinSplit({1 * COIN}, {});
+    DisconnectBlocks(1);
+    BOOST_CHECK_EQUAL(mintBlockIdx, chainActive.Tip());
+
+    // right on top of the minting block the spend uses the newest set it can, the proofs of this
+    // recent block are batch verified before it is accepted
+    auto spendBlockIdx = GenerateBlock({jsTx});
+    BOOST_CHECK(spendBlockIdx);
+    BOOST_CHECK_EQUAL(spendBlockIdx, chainActive.Tip());
+    BOOST_CHECK_EQUAL(mintBlockIdx, spendBlockIdx->pprev);
+
+    mempool.clear();
+    lelantusState->Reset();
+}
+
 BOOST_AUTO_TEST_CASE(spend_limitation_per_tx)
 {
     PrivateCoin coinOut(params, 0);
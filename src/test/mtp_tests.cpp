@@ -1,6 +1,13 @@
 #include "crypto/MerkleTreeProof/mtp.h"
+#include "mtp_precheck.h"
 #include "test/test_bitcoin.h"
 #include "random.h"
+#include "chainparams.h"
+#include "clientversion.h"
+#include "pow.h"
+#include "primitives/block.h"
+#include "streams.h"
+#include "sync.h"
 #include <iostream>
 #include <boost/test/unit_test.hpp>
 
@@ -94,5 +101,161 @@ BOOST_AUTO_TEST_CASE(mtp_block_integrity_test)
     BOOST_CHECK(false == mtp::verify(block3.nNonce+1, block3, pow_limit));
 }
 
+BOOST_AUTO_TEST_CASE(mtp_hash_data_skip_test)
+{
+    CBlock block;
+    block.nVersion = CBlock::CURRENT_VERSION;
+    block.hashPrevBlock = GetRandHash();
+    block.hashMerkleRoot = GetRandHash();
+    block.nTime = std::max<uint32_t>(Params().GetConsensus().nMTPSwitchTime, ZC_GENESIS_BLOCK_TIME + 1);
+    block.nBits = 0x2000ffffUL;
+    block.mtpHashValue = GetRandHash();
+    block.mtpHashData = std::make_shared<CMTPHashData>();
+    block.mtpHashData->nBlockMTP[3][5] = 42;
+    for (int i = 0; i < mtp::MTP_L*3; i += 7)
+        block.mtpHashData->nProofMTP[i].resize(i % 5 + 1, std::vector<uint8_t>(16, (uint8_t)i));
+    BOOST_REQUIRE(block.IsMTP());
+
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 1;
+    block.vtx.push_back(MakeTransactionRef(tx));
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << block;
+
+    // header, skipped MTP data and transactions read back as ReadBlockFromDisk does without fKeepMTPHashData
+    CBlock read;
+    read.SerializationOp(ss, CBlockHeader::CReadBlockHeader());
+    CMTPHashData::Skip(ss);
+    ss >> read.vtx;
+
+    BOOST_CHECK(ss.empty());
+    BOOST_CHECK(!read.mtpHashData);
+    BOOST_CHECK(read.GetHash() == block.GetHash());
+    BOOST_REQUIRE_EQUAL(read.vtx.size(), 1);
+    BOOST_CHECK(read.vtx[0]->GetHash() == block.vtx[0]->GetHash());
+}
+
+
+class TestMTPPrecheck
+{
+public:
+    static uint64_t Prechecked() { return MTPPrecheck::get_instance()->nPrechecked; }
+    static uint64_t CheckedInline() { return MTPPrecheck::get_instance()->nCheckedInline; }
+
+    static bool HasVerdict(const CBlockHeader& block)
+    {
+        MTPPrecheck* precheck = MTPPrecheck::get_instance();
+        LOCK(precheck->cs);
+        return precheck->verdicts.count(MTPPrecheck::GetProofKey(block)) > 0;
+    }
+
+    static size_t VerdictCount()
+    {
+        MTPPrecheck* precheck = MTPPrecheck::get_instance();
+        LOCK(precheck->cs);
+        BOOST_CHECK_EQUAL(precheck->verdicts.size(), precheck->verdictsOrder.size());
+        return precheck->verdicts.size();
+    }
+
+    static void Clear()
+    {
+        MTPPrecheck* precheck = MTPPrecheck::get_instance();
+        LOCK(precheck->cs);
+        precheck->verdicts.clear();
+        precheck->verdictsOrder.clear();
+    }
+};
+
+static std::shared_ptr<CBlockHeader> MakeMTPHeader(uint32_t nNonce)
+{
+    std::shared_ptr<CBlockHeader> header = std::make_shared<CBlockHeader>();
+    header->nVersion = CBlock::CURRENT_VERSION;
+    header->hashPrevBlock = GetRandHash();
+    header->hashMerkleRoot = GetRandHash();
+    header->nTime = std::max<uint32_t>(Params().GetConsensus().nMTPSwitchTime, ZC_GENESIS_BLOCK_TIME + 1);
+    header->nBits = 0x2000ffffUL;
+    header->nNonce = nNonce;
+    header->mtpHashValue = GetRandHash();
+    header->mtpHashData = std::make_shared<CMTPHashData>();
+    return header;
+}
+
+BOOST_AUTO_TEST_CASE(mtp_precheck_test)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    MTPPrecheck* precheck = MTPPrecheck::get_instance();
+    TestMTPPrecheck::Clear();
+    precheck->startWorkers(2);
+    BOOST_REQUIRE(precheck->hasWorkers());
+
+    // valid proof: the verdict of the workers is reused by check()
+    std::shared_ptr<CBlockHeader> valid = MakeMTPHeader(0);
+    valid->mtpHashValue = mtp::hash(*valid, params.powLimit);
+    BOOST_REQUIRE(valid->IsMTP());
+    BOOST_REQUIRE(CheckMerkleTreeProof(*valid, params));
+
+    uint64_t nPrechecked = TestMTPPrecheck::Prechecked();
+    uint64_t nCheckedInline = TestMTPPrecheck::CheckedInline();
+    precheck->submit(valid);
+    BOOST_CHECK(TestMTPPrecheck::HasVerdict(*valid));
+    BOOST_CHECK(precheck->check(*valid, params));
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::Prechecked(), nPrechecked + 1);
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::CheckedInline(), nCheckedInline);
+
+    // same header with different proof data misses the verdict and is verified inline
+    CBlockHeader tampered(*valid);
+    tampered.mtpHashData = std::make_shared<CMTPHashData>(*valid->mtpHashData);
+    tampered.mtpHashData->nBlockMTP[3][5] ^= 1;
+    BOOST_CHECK(tampered.GetHash() == valid->GetHash());
+    BOOST_CHECK(!TestMTPPrecheck::HasVerdict(tampered));
+    BOOST_CHECK(!precheck->check(tampered, params));
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::Prechecked(), nPrechecked + 1);
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::CheckedInline(), nCheckedInline + 1);
+
+    // failed proof is reported as failed from the verdict of the workers
+    std::shared_ptr<CBlockHeader> invalid = MakeMTPHeader(1);
+    precheck->submit(invalid);
+    BOOST_CHECK(!precheck->check(*invalid, params));
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::Prechecked(), nPrechecked + 2);
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::CheckedInline(), nCheckedInline + 1);
+
+    // resubmitting doesn't queue the block again
+    precheck->submit(invalid);
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::VerdictCount(), 2u);
+
+    // verdicts are capped, dropping the oldest ones first
+    std::vector<std::shared_ptr<CBlockHeader>> headers;
+    for (uint32_t i = 0; i < MTP_PRECHECK_MAX_VERDICTS - 2; i++) {
+        headers.push_back(MakeMTPHeader(i + 2));
+        precheck->submit(headers.back());
+    }
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::VerdictCount(), MTP_PRECHECK_MAX_VERDICTS);
+    BOOST_CHECK(TestMTPPrecheck::HasVerdict(*valid));
+
+    headers.push_back(MakeMTPHeader(MTP_PRECHECK_MAX_VERDICTS));
+    precheck->submit(headers.back());
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::VerdictCount(), MTP_PRECHECK_MAX_VERDICTS);
+    BOOST_CHECK(!TestMTPPrecheck::HasVerdict(*valid));
+    BOOST_CHECK(TestMTPPrecheck::HasVerdict(*invalid));
+    BOOST_CHECK(TestMTPPrecheck::HasVerdict(*headers.front()));
+    BOOST_CHECK(TestMTPPrecheck::HasVerdict(*headers.back()));
+
+    // evicted verdict falls back to the inline check
+    BOOST_CHECK(precheck->check(*valid, params));
+    BOOST_CHECK_EQUAL(TestMTPPrecheck::CheckedInline(), nCheckedInline + 2);
+
+    precheck->stopWorkers();
+    BOOST_CHECK(!precheck->hasWorkers());
+
+    // without workers nothing is queued
+    std::shared_ptr<CBlockHeader> unqueued = MakeMTPHeader(MTP_PRECHECK_MAX_VERDICTS + 1);
+    precheck->submit(unqueued);
+    BOOST_CHECK(!TestMTPPrecheck::HasVerdict(*unqueued));
+
+    TestMTPPrecheck::Clear();
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,4 +1,5 @@
 #include "../secp256k1/include/MultiExponent.h"
+#include "../secp256k1/include/FixedBaseMultiExponent.h"
 
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
@@ -30,3 +31,90 @@ BOOST_AUTO_TEST_CASE(multiexponentation_test)
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(fixed_base_multiexponentation_test)
+{
+    // sizes around the Strauss/Pippenger and the precomputed tables thresholds
+    std::vector<int> sizes = {1, 4, 20, 57, 128, 129, 256, 257, 1000, 5000};
+
+    for(unsigned int j = 0; j < sizes.size(); ++j){
+        int size = sizes[j];
+        std::vector<secp_primitives::GroupElement> gens;
+        std::vector<secp_primitives::Scalar> scalars;
+
+        gens.resize(size);
+        scalars.resize(size);
+        for (int i = 0; i < size; ++i) {
+            gens[i].randomize();
+            scalars[i].randomize();
+        }
+        scalars[size / 2] = secp_primitives::Scalar(uint64_t(0));
+
+        secp_primitives::FixedBaseMultiExponent multiexponent(gens);
+        BOOST_CHECK_EQUAL(multiexponent.size(), (size_t)size);
+
+        secp_primitives::GroupElement r = secp_primitives::MultiExponent(gens, scalars).get_multiple();
+        BOOST_CHECK_EQUAL(r, multiexponent.get_multiple(scalars));
+
+        // only a prefix of the generators
+        std::vector<secp_primitives::Scalar> prefix(scalars.begin(), scalars.begin() + (size + 1) / 2);
+        std::vector<secp_primitives::GroupElement> prefixGens(gens.begin(), gens.begin() + (size + 1) / 2);
+        BOOST_CHECK_EQUAL(secp_primitives::MultiExponent(prefixGens, prefix).get_multiple(), multiexponent.get_multiple(prefix));
+
+        // points which are not precomputed
+        std::vector<secp_primitives::GroupElement> extraGens(3);
+        std::vector<secp_primitives::Scalar> extraScalars(3);
+        for (int i = 0; i < 3; ++i) {
+            extraGens[i].randomize();
+            extraScalars[i].randomize();
+            r += extraGens[i] * extraScalars[i];
+        }
+        BOOST_CHECK_EQUAL(r, multiexponent.get_multiple(scalars, extraGens, extraScalars));
+    }
+
+    secp_primitives::FixedBaseMultiExponent empty((std::vector<secp_primitives::GroupElement>()));
+    BOOST_CHECK(empty.get_multiple(std::vector<secp_primitives::Scalar>()).isInfinity());
+}
+
+BOOST_AUTO_TEST_CASE(parallel_multiexponentation_test)
+{
+    std::vector<int> sizes = {100, 4096, 8191, 20000};
+
+    for(unsigned int j = 0; j < sizes.size(); ++j){
+        int size = sizes[j];
+        std::vector<secp_primitives::GroupElement> gens;
+        std::vector<secp_primitives::Scalar> scalars;
+
+        gens.resize(size);
+        scalars.resize(size);
+        for (int i = 0; i < size; ++i) {
+            gens[i].randomize();
+            scalars[i].randomize();
+        }
+
+        secp_primitives::MultiExponent::set_parallelism(1);
+        secp_primitives::GroupElement r = secp_primitives::MultiExponent(gens, scalars).get_multiple();
+
+        // no size threshold, split whenever there are enough points for more than one thread
+        secp_primitives::MultiExponent::set_parallelism(4, 0);
+        BOOST_CHECK_EQUAL(r, secp_primitives::MultiExponent(gens, scalars).get_multiple());
+
+        // sums over fixed generators are split the same way
+        secp_primitives::FixedBaseMultiExponent fixed(gens);
+        BOOST_CHECK_EQUAL(r, fixed.get_multiple(scalars));
+        BOOST_CHECK_EQUAL(r + gens[0] * scalars[0], fixed.get_multiple(scalars, {gens[0]}, {scalars[0]}));
+
+        // sums computed at the same time share the workers
+        std::vector<secp_primitives::GroupElement> results(3);
+        boost::thread_group callers;
+        for (auto& result : results)
+            callers.create_thread([&gens, &scalars, &result] {
+                result = secp_primitives::MultiExponent(gens, scalars).get_multiple();
+            });
+        callers.join_all();
+        for (auto& result : results)
+            BOOST_CHECK_EQUAL(r, result);
+    }
+
+    secp_primitives::MultiExponent::set_parallelism(1);
+}
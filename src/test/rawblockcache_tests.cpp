@@ -0,0 +1,71 @@
+// Copyright (c) 2021 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rawblockcache.h"
+
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(rawblockcache_tests, BasicTestingSetup)
+
+static RawBlockPtr MakeBlock(size_t nSize, unsigned char c)
+{
+    return std::make_shared<const std::vector<unsigned char>>(nSize, c);
+}
+
+BOOST_AUTO_TEST_CASE(rawblockcache_lru)
+{
+    CRawBlockCache cache(300);
+    uint256 hash1 = uint256S("01"), hash2 = uint256S("02"), hash3 = uint256S("03");
+
+    BOOST_CHECK(!cache.Get(hash1));
+
+    cache.Insert(hash1, MakeBlock(100, 1));
+    cache.Insert(hash2, MakeBlock(100, 2));
+    BOOST_CHECK_EQUAL(cache.Count(), 2U);
+    BOOST_CHECK_EQUAL(cache.Size(), 200U);
+
+    // hash1 becomes the most recently used, hash2 is evicted for hash3
+    RawBlockPtr block = cache.Get(hash1);
+    BOOST_CHECK(block && block->size() == 100 && (*block)[0] == 1);
+    cache.Insert(hash3, MakeBlock(150, 3));
+    BOOST_CHECK(!cache.Get(hash2));
+    BOOST_CHECK(cache.Get(hash1));
+    BOOST_CHECK(cache.Get(hash3));
+    BOOST_CHECK_EQUAL(cache.Size(), 250U);
+
+    // inserting a cached block again doesn't change it
+    cache.Insert(hash1, MakeBlock(10, 4));
+    block = cache.Get(hash1);
+    BOOST_CHECK(block && block->size() == 100 && (*block)[0] == 1);
+    BOOST_CHECK_EQUAL(cache.Size(), 250U);
+
+    // a block larger than the cache isn't kept, nor evicts anything
+    cache.Insert(hash2, MakeBlock(301, 2));
+    BOOST_CHECK(!cache.Get(hash2));
+    BOOST_CHECK_EQUAL(cache.Count(), 2U);
+
+    // a block filling the whole cache evicts all the others
+    cache.Insert(hash2, MakeBlock(300, 2));
+    BOOST_CHECK(cache.Get(hash2));
+    BOOST_CHECK(!cache.Get(hash1));
+    BOOST_CHECK(!cache.Get(hash3));
+    BOOST_CHECK_EQUAL(cache.Size(), 300U);
+
+    cache.Clear();
+    BOOST_CHECK(!cache.Get(hash2));
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+    BOOST_CHECK_EQUAL(cache.Count(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(rawblockcache_disabled)
+{
+    CRawBlockCache cache(0);
+    cache.Insert(uint256S("01"), MakeBlock(1, 1));
+    BOOST_CHECK(!cache.Get(uint256S("01")));
+    BOOST_CHECK_EQUAL(cache.Count(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,8 @@
 #include "../validation.h"
 #include "../secp256k1/include/Scalar.h"
 #include "../sigma.h"
+#include "../batchproof_container.h"
+#include "../arith_uint256.h"
 #include "./test_bitcoin.h"
 #include "../wallet/wallet.h"
 
@@ -1217,5 +1219,114 @@ BOOST_AUTO_TEST_CASE(sigma_surge_detection_failure_anywhere)
     sigmaState->Reset();
 }
 
+// Checking used serials are kept in the order they were added
+BOOST_AUTO_TEST_CASE(sigma_ordered_spends)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+
+    std::vector<Scalar> serials(4);
+    for (auto& serial : serials) {
+        serial.randomize();
+        sigmaState->AddSpend(serial, sigma::CoinDenomination::SIGMA_DENOM_1, 1);
+    }
+    // adding a serial twice doesn't change the order
+    sigmaState->AddSpend(serials[1], sigma::CoinDenomination::SIGMA_DENOM_1, 1);
+    BOOST_CHECK(sigmaState->GetOrderedSpends() == serials);
+
+    // disconnecting a block removes its serials
+    CBlockIndex index = CreateBlockIndex(1);
+    index.sigmaSpentSerials[serials[2]] = sigma::CSpendCoinInfo::make(sigma::CoinDenomination::SIGMA_DENOM_1, 1);
+    sigmaState->RemoveBlock(&index);
+    BOOST_CHECK(sigmaState->GetOrderedSpends() == std::vector<Scalar>({serials[0], serials[1], serials[3]}));
+
+    sigmaState->Reset();
+    BOOST_CHECK(sigmaState->GetOrderedSpends().empty());
+}
+
+// Checking GetCoinSetForSpend only returns coins added after the given block
+BOOST_AUTO_TEST_CASE(sigma_getcoinsetforspend_since)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    auto params = sigma::Params::get_default();
+    const sigma::CoinDenomination denomination = sigma::CoinDenomination::SIGMA_DENOM_1;
+
+    auto pubCoins = getPubcoins(generateCoins(params, 3, denomination));
+    std::vector<uint256> hashes = {uint256S("1"), uint256S("2"), uint256S("3")};
+    std::vector<CBlockIndex> indexes(3);
+    for (int i = 0; i < 3; i++) {
+        indexes[i].nHeight = chainActive.Height() + 1 + i;
+        indexes[i].pprev = i == 0 ? chainActive.Tip() : &indexes[i - 1];
+        indexes[i].phashBlock = &hashes[i];
+        auto mintsBlock = CreateBlockWithMints({pubCoins[i]});
+        sigmaState->AddMintsToStateAndBlockIndex(&indexes[i], &mintsBlock);
+    }
+
+    uint256 blockHash;
+    std::vector<sigma::PublicCoin> coins;
+    BOOST_CHECK_EQUAL(3, sigmaState->GetCoinSetForSpend(&chainActive, INT_MAX, denomination, 1, blockHash, coins));
+
+    // latest coins first
+    BOOST_CHECK_EQUAL(2, sigmaState->GetCoinSetForSpend(&chainActive, INT_MAX, denomination, 1, blockHash, coins, &indexes[0]));
+    BOOST_CHECK(coins == std::vector<sigma::PublicCoin>({pubCoins[2], pubCoins[1]}));
+    BOOST_CHECK(blockHash == hashes[2]);
+
+    BOOST_CHECK_EQUAL(0, sigmaState->GetCoinSetForSpend(&chainActive, INT_MAX, denomination, 1, blockHash, coins, &indexes[2]));
+    BOOST_CHECK(coins.empty());
+
+    // blocks before the group give the full set
+    BOOST_CHECK_EQUAL(3, sigmaState->GetCoinSetForSpend(&chainActive, INT_MAX, denomination, 1, blockHash, coins, chainActive.Tip()));
+
+    sigmaState->Reset();
+}
+
+// Checking a batch split into chunks on the worker threads singles out the one invalid proof
+BOOST_AUTO_TEST_CASE(sigma_batch_verify_workers)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    auto params = sigma::Params::get_default();
+    const sigma::CoinDenomination denomination = sigma::CoinDenomination::SIGMA_DENOM_1;
+
+    auto privCoins = generateCoins(params, 16, denomination);
+    auto pubCoins = getPubcoins(privCoins);
+    CBlockIndex index = CreateBlockIndex(chainActive.Height() + 1);
+    auto mintsBlock = CreateBlockWithMints(pubCoins);
+    sigmaState->AddMintsToStateAndBlockIndex(&index, &mintsBlock);
+
+    sigma::SpendMetaData metaData(0, uint256S("120"), uint256S("120"));
+    sigma::CoinSpend validSpend(params, privCoins[0], pubCoins, metaData, true);
+
+    // spend of a coin out of the set, proven against a set differing in that coin
+    sigma::PrivateCoin outsider(params, denomination);
+    auto otherSet = pubCoins;
+    otherSet[0] = outsider.getPublicCoin();
+    sigma::CoinSpend invalidSpend(params, outsider, otherSet, metaData, true);
+
+    BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
+    batchProofContainer->startWorkers(4);
+
+    // more proofs than BATCH_CHUNK_MIN_PROOFS, so the group is verified in chunks
+    const size_t nProofs = 3 * BATCH_CHUNK_MIN_PROOFS - 10;
+    const size_t nInvalid = 2 * BATCH_CHUNK_MIN_PROOFS + 5;
+    batchProofContainer->init(*index.phashBlock);
+    for (size_t i = 0; i < nProofs; i++) {
+        sigma::CoinSpend* spend = i == nInvalid ? &invalidSpend : &validSpend;
+        batchProofContainer->add(spend, true, 1, pubCoins.size(), false, ArithToUint256(i));
+    }
+
+    std::set<uint256> failedTxs;
+    BOOST_CHECK(!batchProofContainer->verify_block(failedTxs));
+    BOOST_CHECK(failedTxs == std::set<uint256>({ArithToUint256(nInvalid)}));
+
+    // without the invalid one every chunk passes
+    failedTxs.clear();
+    batchProofContainer->init(*index.phashBlock);
+    for (size_t i = 0; i < nProofs; i++)
+        batchProofContainer->add(&validSpend, true, 1, pubCoins.size(), false, ArithToUint256(i));
+    BOOST_CHECK(batchProofContainer->verify_block(failedTxs));
+    BOOST_CHECK(failedTxs.empty());
+
+    batchProofContainer->stopWorkers();
+    sigmaState->Reset();
+}
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
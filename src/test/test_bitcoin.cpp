@@ -92,6 +92,7 @@ TestingSetup::TestingSetup(const std::string& chainName, std::string suf) : Basi
         ForceSetArg("-datadir", pathTemp.string());
         mempool.setSanityCheck(1.0);
         pblocktree = new CBlockTreeDB(1 << 20, true);
+        pindexdb = new CIndexDB(1 << 20, true);
         pcoinsdbview = new CCoinsViewDB(1 << 23, true);
         llmq::InitLLMQSystem(*evoDb, nullptr, true);
         pcoinsTip = new CCoinsViewCache(pcoinsdbview);
@@ -148,6 +149,7 @@ TestingSetup::~TestingSetup()
     delete pcoinsTip;
     delete pcoinsdbview;
     delete pblocktree;
+    delete pindexdb;
 	try {
 		boost::filesystem::remove_all(pathTemp);
 	}
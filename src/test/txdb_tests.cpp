@@ -3,9 +3,19 @@
 #include "random.h"
 #include "test/test_bitcoin.h"
 #include "base58.h"
+#include "chainparams.h"
+#include "clientversion.h"
+#include "hash.h"
+#include "indexbuilder.h"
+#include "script/interpreter.h"
+#include "script/standard.h"
+#include "streams.h"
+#include "util.h"
+#include "validation.h"
 
 #include <boost/assert.hpp>
 #include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
 
 
 struct TxdbTestingSetup : public TestingSetup
@@ -35,6 +45,72 @@ void AddTxToView(CTransaction const & tx, int height, CCoinsViewCache & viewCach
     for (size_t i=0; i<tx.vout.size(); i++)
         viewCache.AddCoin(COutPoint(tx.GetHash(), i), Coin(tx.vout[i], height, tx.IsCoinBase()), false);
 }
+
+// Address index records of the address, serialized to compare indexes written in different ways. If fAll,
+// the spent index records of the outpoints follow, and the blocks of the active chain from nHeight on are
+// checked to be in the timestamp index.
+std::string ReadIndexRecords(uint160 const & addressHash, AddressType type, std::vector<COutPoint> const & outpoints,
+                             int nHeight, bool fAll)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentIndex;
+    CAddressBalanceValue balance;
+    BOOST_CHECK(pindexdb->ReadAddressIndex(addressHash, type, addressIndex));
+    BOOST_CHECK(pindexdb->ReadAddressUnspentIndex(addressHash, type, unspentIndex));
+    BOOST_CHECK(pindexdb->ReadAddressBalanceIndex(addressHash, type, balance));
+    ss << addressIndex << unspentIndex << balance;
+    if (!fAll)
+        return ss.str();
+
+    for (COutPoint const & outpoint : outpoints) {
+        CSpentIndexKey key(outpoint.hash, outpoint.n);
+        CSpentIndexValue value;
+        bool fSpent = pindexdb->ReadSpentIndex(key, value);
+        ss << fSpent;
+        if (fSpent)
+            ss << value;
+    }
+
+    LOCK(cs_main);
+    for (CBlockIndex const * pindex = chainActive[nHeight]; pindex; pindex = chainActive.Next(pindex)) {
+        std::vector<uint256> hashes;
+        BOOST_CHECK(pindexdb->ReadTimestampIndex(pindex->nTime, pindex->nTime, hashes));
+        BOOST_CHECK(std::find(hashes.begin(), hashes.end(), pindex->GetBlockHash()) != hashes.end());
+    }
+    return ss.str();
+}
+
+// Invalidates the branch of pindexInvalid, the branch of pindexValid becomes the active chain
+void SwitchBranch(CBlockIndex * pindexInvalid, CBlockIndex * pindexValid)
+{
+    CValidationState state;
+    {
+        LOCK(cs_main);
+        BOOST_REQUIRE(InvalidateBlock(state, Params(), pindexInvalid));
+        BOOST_REQUIRE(ResetBlockFailureFlags(pindexValid));
+    }
+    BOOST_REQUIRE(ActivateBestChain(state, Params()));
+    LOCK(cs_main);
+    BOOST_REQUIRE(chainActive.Contains(pindexValid));
+}
+
+void SetIndexFlags(bool fEnabled)
+{
+    fAddressIndex = fEnabled;
+    fSpentIndex = fEnabled;
+    fTimestampIndex = fEnabled;
+}
+
+// Builds the indexes requested by the arguments, as a node started with them does
+void BuildIndexes()
+{
+    boost::thread_group threadGroup;
+    std::string strError;
+    BOOST_REQUIRE(StartIndexBuilder(threadGroup, strError));
+    threadGroup.join_all();
+}
 }
 
 BOOST_AUTO_TEST_CASE(dbindexhelper_coinbase)
@@ -338,4 +414,377 @@ BOOST_AUTO_TEST_CASE(dbindexhelper_zerospend)
     }
 }
 
+BOOST_AUTO_TEST_CASE(address_balance_index)
+{
+    //MTP Testnet: height: 7980, txid: 02fdd0c09e5e84c4fb2207f9a5b9bbdb181c71436660865ee0ce36e37fff3492
+    CTransaction tx = TxFromStr("01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff05022c1f0104ffffffff062059925300000000232102a9ba61c5b6d3b6bbff24f8f972745bb9922448251ded2fddc5fdbc21d15b0ae0ac80f0fa02000000001976a914296134d2415bf1f2b518b3f673816d7e603b160088ac80f0fa02000000001976a914e1e1dc06a889c1b6d3eb00eef7a96f6a7cfb884888ac80f0fa02000000001976a914ab03ecfddee6330497be894d16c29ae341c123aa88ac80d1f008000000001976a9144281a58a1d5b2d3285e00cb45a8492debbdad4c588ac80f0fa02000000001976a9141fd264c0bb53bd9fef18e2248ddf1383d6e811ae88ac00000000");
+
+    uint160 key;
+    AddressType type;
+    CBitcoinAddress("TDk19wPKYq91i18qmY6U9FeTdTxwPeSveo").GetIndexKey(key, type);
+    CAmount const amount = 500 * 100000;
+
+    CIndexDB indexDB(1 << 20, true);
+
+    auto connect = [&](int height) {
+        CDbIndexHelper dbIndexHelper(true, false);
+        dbIndexHelper.ConnectTransaction(tx, height, 1, viewCache);
+        BOOST_CHECK(dbIndexHelper.getAddressBalanceIndex().size() == 6);
+        BOOST_CHECK(indexDB.WriteAddressIndex(dbIndexHelper.getAddressIndex()));
+        BOOST_CHECK(indexDB.UpdateAddressBalanceIndex(dbIndexHelper.getAddressBalanceIndex(), height, false));
+    };
+    auto disconnect = [&](int height) {
+        CDbIndexHelper dbIndexHelper(true, false);
+        dbIndexHelper.DisconnectTransactionOutputs(tx, height, 1, viewCache);
+        dbIndexHelper.DisconnectTransactionInputs(tx, height, 1, viewCache);
+        BOOST_CHECK(indexDB.EraseAddressIndex(dbIndexHelper.getAddressIndex()));
+        BOOST_CHECK(indexDB.UpdateAddressBalanceIndex(dbIndexHelper.getAddressBalanceIndex(), height, true));
+    };
+
+    connect(7980);
+    connect(8000);
+
+    CAddressBalanceValue value;
+    BOOST_CHECK(indexDB.ReadAddressBalanceIndex(key, type, value));
+    BOOST_CHECK_EQUAL(value.balance, 2 * amount);
+    BOOST_CHECK_EQUAL(value.received, 2 * amount);
+    BOOST_CHECK_EQUAL(value.txCount, 2);
+    BOOST_CHECK_EQUAL(value.firstHeight, 7980);
+    BOOST_CHECK_EQUAL(value.lastHeight, 8000);
+
+    // the records rebuilt from the address index are the same
+    BOOST_CHECK(indexDB.BuildAddressBalanceIndex());
+    CAddressBalanceValue rebuilt;
+    BOOST_CHECK(indexDB.ReadAddressBalanceIndex(key, type, rebuilt));
+    BOOST_CHECK(::SerializeHash(rebuilt) == ::SerializeHash(value));
+
+    // the last height goes back to the previous activity of the address
+    disconnect(8000);
+    BOOST_CHECK(indexDB.ReadAddressBalanceIndex(key, type, value));
+    BOOST_CHECK_EQUAL(value.balance, amount);
+    BOOST_CHECK_EQUAL(value.txCount, 1);
+    BOOST_CHECK_EQUAL(value.firstHeight, 7980);
+    BOOST_CHECK_EQUAL(value.lastHeight, 7980);
+
+    disconnect(7980);
+    BOOST_CHECK(indexDB.ReadAddressBalanceIndex(key, type, value));
+    BOOST_CHECK(value.IsNull());
+    BOOST_CHECK_EQUAL(value.balance, 0);
+}
+
+BOOST_AUTO_TEST_CASE(address_index_best_block)
+{
+    //MTP Testnet: height: 7980, txid: 02fdd0c09e5e84c4fb2207f9a5b9bbdb181c71436660865ee0ce36e37fff3492
+    CTransaction tx = TxFromStr("01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff05022c1f0104ffffffff062059925300000000232102a9ba61c5b6d3b6bbff24f8f972745bb9922448251ded2fddc5fdbc21d15b0ae0ac80f0fa02000000001976a914296134d2415bf1f2b518b3f673816d7e603b160088ac80f0fa02000000001976a914e1e1dc06a889c1b6d3eb00eef7a96f6a7cfb884888ac80f0fa02000000001976a914ab03ecfddee6330497be894d16c29ae341c123aa88ac80d1f008000000001976a9144281a58a1d5b2d3285e00cb45a8492debbdad4c588ac80f0fa02000000001976a9141fd264c0bb53bd9fef18e2248ddf1383d6e811ae88ac00000000");
+
+    uint160 key;
+    AddressType type;
+    CBitcoinAddress("TDk19wPKYq91i18qmY6U9FeTdTxwPeSveo").GetIndexKey(key, type);
+
+    CIndexDB indexDB(1 << 20, true);
+    uint256 hashBest;
+    BOOST_CHECK(!indexDB.ReadAddressIndexBestBlock(hashBest));
+
+    // the records of a block are written along with it
+    CDbIndexHelper dbIndexHelper(true, false);
+    dbIndexHelper.ConnectTransaction(tx, 7980, 1, viewCache);
+    uint256 hashBlock = GetRandHash();
+    CDBBatch batch(indexDB);
+    indexDB.UpdateAddressIndex(batch, dbIndexHelper, 7980, false, hashBlock);
+    BOOST_CHECK(indexDB.WriteBatch(batch));
+
+    BOOST_CHECK(indexDB.ReadAddressIndexBestBlock(hashBest));
+    BOOST_CHECK(hashBest == hashBlock);
+    CAddressBalanceValue value;
+    BOOST_CHECK(indexDB.ReadAddressBalanceIndex(key, type, value));
+    BOOST_CHECK_EQUAL(value.balance, 500 * 100000);
+
+    // the balance records go along with the block they were written up to
+    BOOST_CHECK(indexDB.EraseAddressBalanceIndex());
+    BOOST_CHECK(!indexDB.ReadAddressIndexBestBlock(hashBest));
+    BOOST_CHECK(indexDB.ReadAddressBalanceIndex(key, type, value));
+    BOOST_CHECK(value.IsNull());
+}
+
+BOOST_FIXTURE_TEST_CASE(address_balance_index_verifydb, TestChain100Setup)
+{
+    CScript scriptPubKey = GetScriptForDestination(coinbaseKey.GetPubKey().GetID());
+    uint160 key;
+    AddressType type;
+    CBitcoinAddress(coinbaseKey.GetPubKey().GetID()).GetIndexKey(key, type);
+
+    fAddressIndex = true;
+    CAmount expected = 0;
+    auto mine = [&]() {
+        CBlock block = CreateAndProcessBlock(std::vector<CMutableTransaction>(), scriptPubKey);
+        for (const CTxOut &out : block.vtx[0]->vout) {
+            if (out.scriptPubKey == scriptPubKey)
+                expected += out.nValue;
+        }
+    };
+    for (int i = 0; i < 6; i++)
+        mine();
+
+    CAddressBalanceValue value;
+    BOOST_CHECK(pindexdb->ReadAddressBalanceIndex(key, type, value));
+    BOOST_CHECK_EQUAL(value.balance, expected);
+    BOOST_CHECK_EQUAL(value.txCount, 6);
+
+    // as on a restart: the blocks VerifyDB disconnects and connects again are counted once
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(CVerifyDB().VerifyDB(Params(), pcoinsTip, 4, 6));
+        BOOST_CHECK(SyncAddressIndex(Params()));
+    }
+    BOOST_CHECK(pindexdb->ReadAddressBalanceIndex(key, type, value));
+    BOOST_CHECK_EQUAL(value.balance, expected);
+    BOOST_CHECK_EQUAL(value.txCount, 6);
+
+    mine();
+    BOOST_CHECK(pindexdb->ReadAddressBalanceIndex(key, type, value));
+    BOOST_CHECK_EQUAL(value.balance, expected);
+    BOOST_CHECK_EQUAL(value.txCount, 7);
+
+    fAddressIndex = false;
+}
+
+BOOST_AUTO_TEST_CASE(address_index_paging)
+{
+    uint160 key;
+    AddressType type;
+    CBitcoinAddress("TDk19wPKYq91i18qmY6U9FeTdTxwPeSveo").GetIndexKey(key, type);
+
+    CIndexDB indexDB(1 << 20, true);
+
+    std::vector<std::pair<CAddressIndexKey, CAmount> > entries;
+    for (int height = 1; height <= 10; ++height)
+        entries.push_back(std::make_pair(CAddressIndexKey(type, key, height, 0, GetRandHash(), 0, false), height));
+    BOOST_CHECK(indexDB.WriteAddressIndex(entries));
+
+    // the pages read after each other are the same as a whole read
+    std::vector<std::pair<CAddressIndexKey, CAmount> > all, paged;
+    BOOST_CHECK(indexDB.ReadAddressIndex(key, type, all));
+    BOOST_CHECK_EQUAL(all.size(), 10);
+
+    CAddressIndexKey cursor;
+    for (size_t page = 0; page < 4; ++page) {
+        size_t size = paged.size();
+        BOOST_CHECK(indexDB.ReadAddressIndex(key, type, paged, 0, 0, page ? &cursor : nullptr, 3));
+        BOOST_CHECK_EQUAL(paged.size() - size, page < 3 ? 3 : 1);
+        cursor = paged.back().first;
+    }
+
+    BOOST_CHECK_EQUAL(paged.size(), all.size());
+    for (size_t i = 0; i < all.size(); ++i) {
+        BOOST_CHECK(paged[i].first.txhash == all[i].first.txhash);
+        BOOST_CHECK_EQUAL(paged[i].second, all[i].second);
+    }
+
+    // no entry follows the last one
+    std::vector<std::pair<CAddressIndexKey, CAmount> > rest;
+    BOOST_CHECK(indexDB.ReadAddressIndex(key, type, rest, 0, 0, &all.back().first, 3));
+    BOOST_CHECK(rest.empty());
+}
+
+BOOST_AUTO_TEST_CASE(index_db_move)
+{
+    uint160 key;
+    AddressType type;
+    CBitcoinAddress("TDk19wPKYq91i18qmY6U9FeTdTxwPeSveo").GetIndexKey(key, type);
+
+    // records as written to the block index database by earlier versions
+    CBlockTreeDB blockTree(1 << 20, true);
+    CAddressIndexKey indexKey(type, key, 10, 0, GetRandHash(), 0, false);
+    CSpentIndexKey spentKey(GetRandHash(), 1);
+    CSpentIndexValue spentValue(GetRandHash(), 0, 10, 100, type, key);
+    BOOST_CHECK(blockTree.Write(std::make_pair('a', indexKey), CAmount(100)));
+    BOOST_CHECK(blockTree.Write(std::make_pair('p', spentKey), spentValue));
+    BOOST_CHECK(blockTree.WriteFlag("addressindex", true));
+
+    CIndexDB indexDB(1 << 20, true);
+    BOOST_CHECK(indexDB.MoveIndexesFrom(blockTree));
+
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    BOOST_CHECK(indexDB.ReadAddressIndex(key, type, addressIndex));
+    BOOST_CHECK_EQUAL(addressIndex.size(), 1);
+    BOOST_CHECK_EQUAL(addressIndex[0].second, 100);
+    CSpentIndexValue value;
+    BOOST_CHECK(indexDB.ReadSpentIndex(spentKey, value));
+    BOOST_CHECK(value.txid == spentValue.txid);
+
+    // the index records are gone from the block index database, the other records stay
+    BOOST_CHECK(!blockTree.Exists(std::make_pair('a', indexKey)));
+    BOOST_CHECK(!blockTree.Exists(std::make_pair('p', spentKey)));
+    bool fAddressIndex = false;
+    BOOST_CHECK(blockTree.ReadFlag("addressindex", fAddressIndex) && fAddressIndex);
+
+    // nothing left to move
+    BOOST_CHECK(indexDB.MoveIndexesFrom(blockTree));
+    addressIndex.clear();
+    BOOST_CHECK(indexDB.ReadAddressIndex(key, type, addressIndex));
+    BOOST_CHECK_EQUAL(addressIndex.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(index_build_state)
+{
+    uint160 key;
+    AddressType type;
+    CBitcoinAddress("TDk19wPKYq91i18qmY6U9FeTdTxwPeSveo").GetIndexKey(key, type);
+
+    CIndexDB indexDB(1 << 20, true);
+    CIndexBuildState state;
+    BOOST_CHECK(!indexDB.ReadBuildState(state));
+
+    // progress of a build is written along with the records of a block
+    std::vector<std::pair<CAddressIndexKey, CAmount> > entries;
+    entries.push_back(std::make_pair(CAddressIndexKey(type, key, 1, 0, GetRandHash(), 0, false), 100));
+    state.fAddressIndex = true;
+    state.hashBlock = GetRandHash();
+    state.nTotalSupply = 100;
+    CDBBatch batch(indexDB);
+    indexDB.WriteAddressIndex(batch, entries);
+    indexDB.WriteBuildState(batch, state);
+    BOOST_CHECK(indexDB.WriteBatch(batch));
+
+    CIndexBuildState read;
+    BOOST_CHECK(indexDB.ReadBuildState(read));
+    BOOST_CHECK(read.fAddressIndex && !read.fSpentIndex && !read.fTimestampIndex);
+    BOOST_CHECK(read.hashBlock == state.hashBlock);
+    BOOST_CHECK_EQUAL(read.nTotalSupply, 100);
+
+    // a build starting over drops the records of the previous one
+    BOOST_CHECK(indexDB.EraseIndexes(true, false, false));
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    BOOST_CHECK(indexDB.ReadAddressIndex(key, type, addressIndex));
+    BOOST_CHECK(addressIndex.empty());
+
+    BOOST_CHECK(indexDB.EraseBuildState());
+    BOOST_CHECK(!indexDB.ReadBuildState(read));
+}
+
+BOOST_AUTO_TEST_CASE(failed_batch_blocks)
+{
+    CBlockTreeDB blockTree(1 << 20, true);
+    std::set<uint256> blocks;
+    BOOST_CHECK(blockTree.ReadFailedBatchBlocks(blocks));
+    BOOST_CHECK(blocks.empty());
+
+    // stored at shutdown, read back on the next start
+    std::set<uint256> failed = {GetRandHash(), GetRandHash()};
+    BOOST_CHECK(blockTree.WriteFailedBatchBlocks(failed));
+    BOOST_CHECK(blockTree.ReadFailedBatchBlocks(blocks));
+    BOOST_CHECK(blocks == failed);
+
+    // and forgotten once invalidated
+    BOOST_CHECK(blockTree.WriteFailedBatchBlocks(std::set<uint256>()));
+    BOOST_CHECK(blockTree.ReadFailedBatchBlocks(blocks));
+    BOOST_CHECK(blocks.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(index_build_matches_connectblock, TestChain100Setup)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CScript scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+    uint160 addressHash;
+    AddressType type;
+    CBitcoinAddress(key.GetPubKey().GetID()).GetIndexKey(addressHash, type);
+
+    CScript scriptCoinbase = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    auto spend = [&](CTransaction const & coinbase, CAmount nValue) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(coinbase.GetHash(), 0);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = nValue;
+        tx.vout[0].scriptPubKey = scriptPubKey;
+
+        std::vector<unsigned char> vchSig;
+        uint256 hash = SignatureHash(scriptCoinbase, tx, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        tx.vin[0].scriptSig << vchSig;
+        return tx;
+    };
+    auto mine = [&](std::vector<CMutableTransaction> const & txns) {
+        CBlock block = CreateAndProcessBlock(txns, scriptPubKey);
+        LOCK(cs_main);
+        BOOST_REQUIRE(chainActive.Tip()->GetBlockHash() == block.GetHash());
+        return chainActive.Tip();
+    };
+
+    std::vector<COutPoint> outpoints;
+    for (size_t i = 0; i < 3; i++)
+        outpoints.push_back(COutPoint(coinbaseTxns[i].GetHash(), 0));
+    int nHeight = chainActive.Height() + 1;
+
+    // indexes written by ConnectBlock and DisconnectBlock, for a branch replaced by a longer one
+    SetIndexFlags(true);
+    CBlockIndex *pindexA = mine({spend(coinbaseTxns[0], 11 * CENT)});
+    mine({});
+    std::string addressRecordsA = ReadIndexRecords(addressHash, type, outpoints, nHeight, false);
+    std::string recordsA = ReadIndexRecords(addressHash, type, outpoints, nHeight, true);
+
+    {
+        CValidationState state;
+        LOCK(cs_main);
+        BOOST_REQUIRE(InvalidateBlock(state, Params(), pindexA));
+    }
+    CBlockIndex *pindexB = mine({spend(coinbaseTxns[1], 11 * CENT)});
+    mine({spend(coinbaseTxns[0], 12 * CENT)});
+    mine({});
+    std::string addressRecordsB = ReadIndexRecords(addressHash, type, outpoints, nHeight, false);
+    std::string recordsB = ReadIndexRecords(addressHash, type, outpoints, nHeight, true);
+    BOOST_CHECK(addressRecordsA != addressRecordsB);
+
+    // address index left on the other branch, as after a crash
+    SetIndexFlags(false);
+    SwitchBranch(pindexB, pindexA);
+    fAddressIndex = true;
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(SyncAddressIndex(Params()));
+    }
+    BOOST_CHECK(ReadIndexRecords(addressHash, type, outpoints, nHeight, false) == addressRecordsA);
+
+    SetIndexFlags(false);
+    SwitchBranch(pindexA, pindexB);
+    fAddressIndex = true;
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(SyncAddressIndex(Params()));
+    }
+    BOOST_CHECK(ReadIndexRecords(addressHash, type, outpoints, nHeight, false) == addressRecordsB);
+
+    // indexes built over the whole chain
+    SetIndexFlags(false);
+    ForceSetArg("-addressindex", "1");
+    ForceSetArg("-spentindex", "1");
+    ForceSetArg("-timestampindex", "1");
+    BuildIndexes();
+    BOOST_CHECK(fAddressIndex && fSpentIndex && fTimestampIndex);
+    BOOST_CHECK(ReadIndexRecords(addressHash, type, outpoints, nHeight, true) == recordsB);
+
+    // build interrupted on the branch the chain then left: its blocks are removed from the indexes
+    SetIndexFlags(false);
+    CIndexBuildState state;
+    state.fAddressIndex = state.fSpentIndex = state.fTimestampIndex = true;
+    state.hashBlock = chainActive.Tip()->GetBlockHash();
+    BOOST_CHECK(pblocktree->ReadTotalSupply(state.nTotalSupply));
+    CDBBatch batch(*pindexdb);
+    pindexdb->WriteBuildState(batch, state);
+    BOOST_CHECK(pindexdb->WriteBatch(batch));
+
+    SwitchBranch(pindexB, pindexA);
+    BuildIndexes();
+    BOOST_CHECK(fAddressIndex && fSpentIndex && fTimestampIndex);
+    BOOST_CHECK(ReadIndexRecords(addressHash, type, outpoints, nHeight, true) == recordsA);
+    BOOST_CHECK(!pindexdb->ReadBuildState(state));
+
+    SetIndexFlags(false);
+    ForceSetArg("-addressindex", "0");
+    ForceSetArg("-spentindex", "0");
+    ForceSetArg("-timestampindex", "0");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
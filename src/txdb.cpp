@@ -25,6 +25,9 @@ static const char DB_ADDRESSINDEX = 'a';
 static const char DB_ADDRESSUNSPENTINDEX = 'u';
 static const char DB_TIMESTAMPINDEX = 's';
 static const char DB_SPENTINDEX = 'p';
+static const char DB_ADDRESSBALANCEINDEX = 'A';
+static const char DB_INDEX_BUILD_STATE = 'I';
+static const char DB_ADDRESSINDEX_BEST_BLOCK = 'h';
 static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
@@ -32,6 +35,7 @@ static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 static const char DB_TOTAL_SUPPLY = 'S';
+static const char DB_FAILED_BATCH_BLOCKS = 'V';
 
 namespace {
 
@@ -125,6 +129,18 @@ bool CBlockTreeDB::ReadReindexing(bool &fReindexing) {
     return true;
 }
 
+bool CBlockTreeDB::WriteFailedBatchBlocks(const std::set<uint256> &blocks) {
+    if (!blocks.empty())
+        return Write(DB_FAILED_BATCH_BLOCKS, blocks);
+    else
+        return Erase(DB_FAILED_BATCH_BLOCKS);
+}
+
+bool CBlockTreeDB::ReadFailedBatchBlocks(std::set<uint256> &blocks) {
+    blocks.clear();
+    return !Exists(DB_FAILED_BATCH_BLOCKS) || Read(DB_FAILED_BATCH_BLOCKS, blocks);
+}
+
 bool CBlockTreeDB::ReadLastBlockFile(int &nFile) {
     return Read(DB_LAST_BLOCK, nFile);
 }
@@ -206,12 +222,21 @@ bool CBlockTreeDB::WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos>
     return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) {
+CIndexDB::CIndexDB(size_t nCacheSize, bool fMemory, bool fWipe)
+    : CDBWrapper(GetDataDir() / "indexes", nCacheSize, fMemory, fWipe, false, nCacheSize * 3 / 8) {
+}
+
+bool CIndexDB::ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) {
     return Read(std::make_pair(DB_SPENTINDEX, key), value);
 }
 
-bool CBlockTreeDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
+bool CIndexDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
     CDBBatch batch(*this);
+    UpdateSpentIndex(batch, vect);
+    return WriteBatch(batch);
+}
+
+void CIndexDB::UpdateSpentIndex(CDBBatch &batch, const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
     for (std::vector<std::pair<CSpentIndexKey,CSpentIndexValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
         if (it->second.IsNull()) {
             batch.Erase(std::make_pair(DB_SPENTINDEX, it->first));
@@ -219,11 +244,31 @@ bool CBlockTreeDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey,
             batch.Write(std::make_pair(DB_SPENTINDEX, it->first), it->second);
         }
     }
-    return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
+// Positions the iterator on the first key following the given one, which is the last key of the previous page
+template <typename K>
+static void SeekPastCursor(CDBIterator& cursor, const K& key)
+{
+    cursor.Seek(key);
+
+    if (!cursor.Valid())
+        return;
+
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << key;
+    CDataStream ssCurrent = cursor.GetKey();
+    if (ssCurrent.size() == ssKey.size() && std::equal(ssKey.begin(), ssKey.end(), ssCurrent.begin()))
+        cursor.Next();
+}
+
+bool CIndexDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
     CDBBatch batch(*this);
+    UpdateAddressUnspentIndex(batch, vect);
+    return WriteBatch(batch);
+}
+
+void CIndexDB::UpdateAddressUnspentIndex(CDBBatch &batch, const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
     for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
         if (it->second.IsNull()) {
             batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first));
@@ -231,17 +276,23 @@ bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddres
             batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first), it->second);
         }
     }
-    return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, AddressType type,
-                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
+bool CIndexDB::ReadAddressUnspentIndex(uint160 addressHash, AddressType type,
+                                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                                       const CAddressUnspentKey *pCursor, size_t nLimit) {
 
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    if (pCursor) {
+        SeekPastCursor(*pcursor, std::make_pair(DB_ADDRESSUNSPENTINDEX, *pCursor));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
 
-    while (pcursor->Valid()) {
+    // no limit if nLimit is 0
+    size_t nLimitSize = unspentOutputs.size() + nLimit;
+    while (pcursor->Valid() && (nLimit == 0 || unspentOutputs.size() < nLimitSize)) {
         boost::this_thread::interruption_point();
         std::pair<char,CAddressUnspentKey> key;
         if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.hashBytes == addressHash) {
@@ -260,34 +311,47 @@ bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, AddressType type
     return true;
 }
 
-bool CBlockTreeDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+bool CIndexDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
     CDBBatch batch(*this);
+    WriteAddressIndex(batch, vect);
+    return WriteBatch(batch);
+}
+
+void CIndexDB::WriteAddressIndex(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
         batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
     }
-    return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+bool CIndexDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
     CDBBatch batch(*this);
+    EraseAddressIndex(batch, vect);
+    return WriteBatch(batch);
+}
+
+void CIndexDB::EraseAddressIndex(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
     batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
-    return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::ReadAddressIndex(uint160 addressHash, AddressType type,
-                                    std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                                    int start, int end) {
+bool CIndexDB::ReadAddressIndex(uint160 addressHash, AddressType type,
+                                std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                                int start, int end,
+                                const CAddressIndexKey *pCursor, size_t nLimit) {
 
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    if (start > 0 && end > 0) {
+    if (pCursor) {
+        SeekPastCursor(*pcursor, std::make_pair(DB_ADDRESSINDEX, *pCursor));
+    } else if (start > 0 && end > 0) {
         pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
     } else {
         pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
     }
 
-    while (pcursor->Valid()) {
+    // no limit if nLimit is 0
+    size_t nLimitSize = addressIndex.size() + nLimit;
+    while (pcursor->Valid() && (nLimit == 0 || addressIndex.size() < nLimitSize)) {
         boost::this_thread::interruption_point();
         std::pair<char,CAddressIndexKey> key;
         if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.hashBytes == addressHash && key.second.type == type) {
@@ -310,13 +374,169 @@ bool CBlockTreeDB::ReadAddressIndex(uint160 addressHash, AddressType type,
 }
 
 
-bool CBlockTreeDB::WriteTimestampIndex(const CTimestampIndexKey &timestampIndex) {
+// Height of the last address index entry of the address below the given height, 0 if there's none
+static int FindLastAddressIndexHeight(CDBIterator& cursor, uint160 addressHash, AddressType type, int height)
+{
+    cursor.Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, height)));
+    if (cursor.Valid())
+        cursor.Prev();
+    else
+        cursor.SeekToLast();
+
+    std::pair<char, CAddressIndexKey> key;
+    if (cursor.Valid() && cursor.GetKey(key) && key.first == DB_ADDRESSINDEX
+            && key.second.hashBytes == addressHash && key.second.type == type)
+        return key.second.blockHeight;
+    return 0;
+}
+
+bool CIndexDB::UpdateAddressBalanceIndex(const std::map<std::pair<AddressType, uint160>, CAddressBalanceDelta> &deltas,
+                                         int height, bool fDisconnect) {
     CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex), 0);
+    UpdateAddressBalanceIndex(batch, deltas, height, fDisconnect);
+    return WriteBatch(batch);
+}
+
+void CIndexDB::UpdateAddressBalanceIndex(CDBBatch &batch, const std::map<std::pair<AddressType, uint160>, CAddressBalanceDelta> &deltas,
+                                         int height, bool fDisconnect) {
+    boost::scoped_ptr<CDBIterator> pcursor;
+
+    for (const auto &it : deltas) {
+        auto key = std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(it.first.first, it.first.second));
+        const CAddressBalanceDelta &delta = it.second;
+
+        CAddressBalanceValue value;
+        Read(key, value);
+
+        if (!fDisconnect) {
+            if (value.IsNull())
+                value.firstHeight = height;
+            value.lastHeight = height;
+            value.balance += delta.balance;
+            value.received += delta.received;
+            value.txCount += delta.txCount;
+        } else {
+            value.balance -= delta.balance;
+            value.received -= delta.received;
+            value.txCount -= delta.txCount;
+
+            if (value.txCount <= 0) {
+                batch.Erase(key);
+                continue;
+            }
+
+            // the deltas of the block are below the height we look for, no need to wait for their removal
+            if (value.lastHeight >= height) {
+                if (!pcursor)
+                    pcursor.reset(NewIterator());
+                value.lastHeight = FindLastAddressIndexHeight(*pcursor, it.first.second, it.first.first, height);
+            }
+        }
+
+        batch.Write(key, value);
+    }
+}
+
+bool CIndexDB::ReadAddressBalanceIndex(uint160 addressHash, AddressType type, CAddressBalanceValue &value) {
+    value.SetNull();
+    // no record means no history
+    Read(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(type, addressHash)), value);
+    return true;
+}
+
+bool CIndexDB::BuildAddressBalanceIndex() {
+    LogPrintf("Building the address balance index...\n");
+
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey()));
+
+    CDBBatch batch(*this);
+    size_t nRecords = 0;
+
+    // entries are sorted by address then height, so each address is done when the next one starts
+    CAddressIndexIteratorKey address;
+    CAddressBalanceValue value;
+    uint256 lastTxHash;
+    auto writeAddress = [&]() -> bool {
+        if (value.IsNull())
+            return true;
+        batch.Write(std::make_pair(DB_ADDRESSBALANCEINDEX, address), value);
+        if (++nRecords % 10000 == 0) {
+            if (!WriteBatch(batch))
+                return false;
+            batch.Clear();
+        }
+        return true;
+    };
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX)
+            break;
+
+        CAmount nValue;
+        if (!pcursor->GetValue(nValue))
+            return error("failed to get address index value");
+
+        if (key.second.type != address.type || key.second.hashBytes != address.hashBytes) {
+            if (!writeAddress())
+                return error("failed to write address balance index");
+            address = CAddressIndexIteratorKey(key.second.type, key.second.hashBytes);
+            value.SetNull();
+            value.firstHeight = key.second.blockHeight;
+        }
+
+        value.balance += nValue;
+        if (nValue > 0)
+            value.received += nValue;
+        // same as the deltas, a transaction is counted once per block it's in
+        if (value.IsNull() || key.second.txhash != lastTxHash || key.second.blockHeight != value.lastHeight) {
+            value.txCount++;
+            lastTxHash = key.second.txhash;
+        }
+        value.lastHeight = key.second.blockHeight;
+
+        pcursor->Next();
+    }
+
+    if (!writeAddress() || !WriteBatch(batch))
+        return error("failed to write address balance index");
+
+    LogPrintf("Address balance index built, %d addresses\n", nRecords);
+    return true;
+}
+
+bool CIndexDB::ReadAddressIndexBestBlock(uint256 &hash) {
+    return Read(DB_ADDRESSINDEX_BEST_BLOCK, hash);
+}
+
+void CIndexDB::WriteAddressIndexBestBlock(CDBBatch &batch, const uint256 &hash) {
+    batch.Write(DB_ADDRESSINDEX_BEST_BLOCK, hash);
+}
+
+void CIndexDB::UpdateAddressIndex(CDBBatch &batch, const CDbIndexHelper &dbIndexHelper, int height, bool fDisconnect,
+                                  const uint256 &hashBest) {
+    if (!fDisconnect)
+        WriteAddressIndex(batch, dbIndexHelper.getAddressIndex());
+    else
+        EraseAddressIndex(batch, dbIndexHelper.getAddressIndex());
+    UpdateAddressBalanceIndex(batch, dbIndexHelper.getAddressBalanceIndex(), height, fDisconnect);
+    UpdateAddressUnspentIndex(batch, dbIndexHelper.getAddressUnspentIndex());
+    WriteAddressIndexBestBlock(batch, hashBest);
+}
+
+bool CIndexDB::WriteTimestampIndex(const CTimestampIndexKey &timestampIndex) {
+    CDBBatch batch(*this);
+    WriteTimestampIndex(batch, timestampIndex);
     return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes) {
+void CIndexDB::WriteTimestampIndex(CDBBatch &batch, const CTimestampIndexKey &timestampIndex) {
+    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex), 0);
+}
+
+bool CIndexDB::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes) {
 
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
@@ -336,6 +556,121 @@ bool CBlockTreeDB::ReadTimestampIndex(const unsigned int &high, const unsigned i
     return true;
 }
 
+// Size of the batches records are moved in from the block index database
+static const size_t INDEX_MOVE_BATCH_SIZE = 16 << 20;
+
+template <typename K, typename V>
+static bool MoveIndexRecords(char prefix, CDBWrapper &from, CDBWrapper &to, size_t &nMoved)
+{
+    boost::scoped_ptr<CDBIterator> pcursor(from.NewIterator());
+    pcursor->Seek(prefix);
+
+    CDBBatch batch(to);
+    CDBBatch eraseBatch(from);
+    auto flush = [&]() -> bool {
+        // the copies must be on disk before the originals go
+        if (!to.WriteBatch(batch, true) || !from.WriteBatch(eraseBatch))
+            return false;
+        batch.Clear();
+        eraseBatch.Clear();
+        return true;
+    };
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, K> key;
+        if (!pcursor->GetKey(key) || key.first != prefix)
+            break;
+
+        V value;
+        if (!pcursor->GetValue(value))
+            return error("%s: failed to read index record", __func__);
+
+        batch.Write(key, value);
+        eraseBatch.Erase(key);
+        if (batch.SizeEstimate() > INDEX_MOVE_BATCH_SIZE && !flush())
+            return error("%s: failed to move index records", __func__);
+
+        nMoved++;
+        pcursor->Next();
+    }
+
+    if (!flush())
+        return error("%s: failed to move index records", __func__);
+    return true;
+}
+
+bool CIndexDB::MoveIndexesFrom(CBlockTreeDB &blockTree) {
+    size_t nMoved = 0;
+    if (!MoveIndexRecords<CAddressIndexKey, CAmount>(DB_ADDRESSINDEX, blockTree, *this, nMoved) ||
+            !MoveIndexRecords<CAddressUnspentKey, CAddressUnspentValue>(DB_ADDRESSUNSPENTINDEX, blockTree, *this, nMoved) ||
+            !MoveIndexRecords<CAddressIndexIteratorKey, CAddressBalanceValue>(DB_ADDRESSBALANCEINDEX, blockTree, *this, nMoved) ||
+            !MoveIndexRecords<CTimestampIndexKey, int>(DB_TIMESTAMPINDEX, blockTree, *this, nMoved) ||
+            !MoveIndexRecords<CSpentIndexKey, CSpentIndexValue>(DB_SPENTINDEX, blockTree, *this, nMoved))
+        return false;
+
+    if (nMoved > 0) {
+        LogPrintf("Moved %u index records out of the block index database\n", nMoved);
+        // give the space back, one prefix at a time as other records lie between them
+        for (char prefix : {DB_ADDRESSINDEX, DB_ADDRESSUNSPENTINDEX, DB_ADDRESSBALANCEINDEX, DB_TIMESTAMPINDEX, DB_SPENTINDEX})
+            blockTree.CompactRange(prefix, (char)(prefix + 1));
+    }
+    return true;
+}
+
+bool CIndexDB::ReadBuildState(CIndexBuildState &state) {
+    return Read(DB_INDEX_BUILD_STATE, state);
+}
+
+void CIndexDB::WriteBuildState(CDBBatch &batch, const CIndexBuildState &state) {
+    batch.Write(DB_INDEX_BUILD_STATE, state);
+}
+
+bool CIndexDB::EraseBuildState() {
+    return Erase(DB_INDEX_BUILD_STATE, true);
+}
+
+template <typename K>
+static bool EraseIndexRecords(char prefix, CDBWrapper &db)
+{
+    boost::scoped_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(prefix);
+
+    CDBBatch batch(db);
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, K> key;
+        if (!pcursor->GetKey(key) || key.first != prefix)
+            break;
+
+        batch.Erase(key);
+        if (batch.SizeEstimate() > INDEX_MOVE_BATCH_SIZE) {
+            if (!db.WriteBatch(batch))
+                return false;
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+    return db.WriteBatch(batch);
+}
+
+bool CIndexDB::EraseAddressBalanceIndex() {
+    return EraseIndexRecords<CAddressIndexIteratorKey>(DB_ADDRESSBALANCEINDEX, *this) &&
+            Erase(DB_ADDRESSINDEX_BEST_BLOCK, true);
+}
+
+bool CIndexDB::EraseIndexes(bool fAddressIndex, bool fSpentIndex, bool fTimestampIndex) {
+    if (fAddressIndex && (!EraseIndexRecords<CAddressIndexKey>(DB_ADDRESSINDEX, *this) ||
+                          !EraseIndexRecords<CAddressUnspentKey>(DB_ADDRESSUNSPENTINDEX, *this) ||
+                          !EraseAddressBalanceIndex()))
+        return error("%s: failed to erase the address index", __func__);
+    if (fSpentIndex && !EraseIndexRecords<CSpentIndexKey>(DB_SPENTINDEX, *this))
+        return error("%s: failed to erase the spent index", __func__);
+    if (fTimestampIndex && !EraseIndexRecords<CTimestampIndexKey>(DB_TIMESTAMPINDEX, *this))
+        return error("%s: failed to erase the timestamp index", __func__);
+    return true;
+}
+
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
     return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
 }
@@ -450,6 +785,11 @@ bool CBlockTreeDB::AddTotalSupply(CAmount const & supply)
     return Write(DB_TOTAL_SUPPLY, current);
 }
 
+bool CBlockTreeDB::WriteTotalSupply(CAmount const & supply)
+{
+    return Write(DB_TOTAL_SUPPLY, supply);
+}
+
 bool CBlockTreeDB::ReadTotalSupply(CAmount & supply)
 {
     CAmount current = 0;
@@ -467,6 +807,7 @@ CDbIndexHelper::CDbIndexHelper(bool addressIndex_, bool spentIndex_)
     if (addressIndex_) {
         addressIndex.reset(AddressIndex());
         addressUnspentIndex.reset(AddressUnspentIndex());
+        addressBalanceIndex.reset(AddressBalanceIndex());
     }
 
     if (spentIndex_)
@@ -603,6 +944,8 @@ void handleOutput(const CTxOut &out, size_t outNo, uint256 const & txHash, int h
 
 void CDbIndexHelper::ConnectTransaction(CTransaction const & tx, int height, int txNumber, CCoinsViewCache const & view)
 {
+    size_t pAddressBegin = addressIndex ? addressIndex->size() : 0;
+
     size_t no = 0;
     if(!tx.IsCoinBase() && !tx.IsZerocoinSpend() && !tx.IsSigmaSpend() && !tx.IsZerocoinRemint() && !tx.IsLelantusJoinSplit()) {
         for (CTxIn const & input : tx.vin) {
@@ -630,6 +973,8 @@ void CDbIndexHelper::ConnectTransaction(CTransaction const & tx, int height, int
     for (CTxOut const & out : tx.vout) {
         handleOutput(out, no++, tx.GetHash(), height, txNumber, view, txIsCoinBase, addressIndex, addressUnspentIndex, spentIndex);
     }
+
+    addBalanceDeltas(pAddressBegin);
 }
 
 
@@ -664,6 +1009,8 @@ void CDbIndexHelper::DisconnectTransactionInputs(CTransaction const & tx, int he
             handleInput(input, no++, tx.GetHash(), height, txNumber, view, addressIndex, addressUnspentIndex, spentIndex);
         }
 
+    addBalanceDeltas(pAddressBegin);
+
     if(addressIndex){
         std::reverse(addressIndex->begin() + pAddressBegin, addressIndex->end());
         std::reverse(addressUnspentIndex->begin() + pUnspentBegin, addressUnspentIndex->end());
@@ -678,6 +1025,8 @@ void CDbIndexHelper::DisconnectTransactionInputs(CTransaction const & tx, int he
 
 void CDbIndexHelper::DisconnectTransactionOutputs(CTransaction const & tx, int height, int txNumber, CCoinsViewCache const & view)
 {
+    size_t pAddressBegin = addressIndex ? addressIndex->size() : 0;
+
     if(tx.IsZerocoinSpend() || tx.IsSigmaSpend() || tx.IsLelantusJoinSplit())
         handleZerocoinSpend(tx.vout.begin(), tx.vout.end(), tx.GetHash(), height, txNumber, view, addressIndex, tx);
 
@@ -687,6 +1036,8 @@ void CDbIndexHelper::DisconnectTransactionOutputs(CTransaction const & tx, int h
         handleOutput(out, no++, tx.GetHash(), height, txNumber, view, txIsCoinBase, addressIndex, addressUnspentIndex, spentIndex);
     }
 
+    addBalanceDeltas(pAddressBegin);
+
     if(addressIndex)
     {
         std::reverse(addressIndex->begin(), addressIndex->end());
@@ -714,6 +1065,22 @@ CDbIndexHelper::SpentIndex const & CDbIndexHelper::getSpentIndex() const
     return *spentIndex;
 }
 
+
+CDbIndexHelper::AddressBalanceIndex const & CDbIndexHelper::getAddressBalanceIndex() const
+{
+    return *addressBalanceIndex;
+}
+
+
+void CDbIndexHelper::addBalanceDeltas(size_t begin)
+{
+    if(!addressIndex)
+        return;
+
+    for(AddressIndex::const_iterator iter = addressIndex->begin() + begin; iter != addressIndex->end(); ++iter)
+        (*addressBalanceIndex)[std::make_pair(iter->first.type, iter->first.hashBytes)].Add(iter->first, iter->second);
+}
+
 namespace {
 
 //! Legacy class to deserialize pre-pertxout database entries without reindex.
@@ -12,6 +12,7 @@
 #include "spentindex.h"
 
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -42,6 +43,10 @@ static const int64_t nMaxBlockDBCache = 2;
 static const int64_t nMaxBlockDBAndTxIndexCache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! Max memory allocated to the index DB cache, if any of the optional indexes is enabled (MiB)
+static const int64_t nMaxIndexDBCache = 256;
+//! Memory allocated to the index DB cache if no optional index is enabled (MiB)
+static const int64_t nMinIndexDBCache = 1;
 
 struct CDiskTxPos : public CDiskBlockPos
 {
@@ -123,28 +128,117 @@ public:
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindex);
     bool ReadReindexing(bool &fReindex);
+    //! Blocks holding proofs which failed batch verification while shutting down, invalidated on the next start
+    bool WriteFailedBatchBlocks(const std::set<uint256> &blocks);
+    bool ReadFailedBatchBlocks(std::set<uint256> &blocks);
     bool ReadTxIndex(const uint256 &txid, CDiskTxPos &pos);
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &list);
+    bool WriteFlag(const std::string &name, bool fValue);
+    bool ReadFlag(const std::string &name, bool &fValue);
+    bool LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex);
+    int GetBlockIndexVersion();
+    int GetBlockIndexVersion(uint256 const & blockHash);
+    bool AddTotalSupply(CAmount const & supply);
+    bool WriteTotalSupply(CAmount const & supply);
+    bool ReadTotalSupply(CAmount & supply);
+};
+
+class CDbIndexHelper;
+
+/** Progress of the background build of indexes the node was started without (see indexbuilder.h) */
+struct CIndexBuildState
+{
+    //! Indexes being built
+    bool fAddressIndex;
+    bool fSpentIndex;
+    bool fTimestampIndex;
+    //! Last block of the active chain the indexes were built up to
+    uint256 hashBlock;
+    //! Total supply up to that block, kept along with the address index
+    CAmount nTotalSupply;
+
+    CIndexBuildState() : fAddressIndex(false), fSpentIndex(false), fTimestampIndex(false), nTotalSupply(0) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(fAddressIndex);
+        READWRITE(fSpentIndex);
+        READWRITE(fTimestampIndex);
+        READWRITE(hashBlock);
+        READWRITE(nTotalSupply);
+    }
+
+    bool IsNull() const { return !fAddressIndex && !fSpentIndex && !fTimestampIndex; }
+};
+
+/**
+ * Access to the optional address, spent and timestamp indexes (indexes/)
+ *
+ * They are most of the data written by an indexed node, so they are kept out of the block
+ * index database: their writes don't go through its compactions and synced flushes, and
+ * they have a cache of their own, mostly spent on write buffers.
+ */
+class CIndexDB : public CDBWrapper
+{
+public:
+    CIndexDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+private:
+    CIndexDB(const CIndexDB&);
+    void operator=(const CIndexDB&);
+public:
     bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
     bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
+    //! Adds the changes to the given batch instead of writing them, same for the other batch overloads
+    void UpdateSpentIndex(CDBBatch &batch, const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
     bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
+    void UpdateAddressUnspentIndex(CDBBatch &batch, const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
+    //! pCursor, if given, is the last key returned by a previous call, reading resumes right after it.
+    //! At most nLimit entries are read if it's not 0 (same for ReadAddressIndex)
     bool ReadAddressUnspentIndex(uint160 addressHash, AddressType type,
-                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect,
+                                 const CAddressUnspentKey *pCursor = nullptr, size_t nLimit = 0);
     bool WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
+    void WriteAddressIndex(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
     bool EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
+    void EraseAddressIndex(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
     bool ReadAddressIndex(uint160 addressHash, AddressType type,
                           std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                          int start = 0, int end = 0);
+                          int start = 0, int end = 0,
+                          const CAddressIndexKey *pCursor = nullptr, size_t nLimit = 0);
+    bool UpdateAddressBalanceIndex(const std::map<std::pair<AddressType, uint160>, CAddressBalanceDelta> &deltas,
+                                   int height, bool fDisconnect);
+    void UpdateAddressBalanceIndex(CDBBatch &batch, const std::map<std::pair<AddressType, uint160>, CAddressBalanceDelta> &deltas,
+                                   int height, bool fDisconnect);
+    bool ReadAddressBalanceIndex(uint160 addressHash, AddressType type, CAddressBalanceValue &value);
+    //! Builds the balance records from an address index written by a version without them
+    bool BuildAddressBalanceIndex();
+    //! Erases the balance records, along with the block they were written up to
+    bool EraseAddressBalanceIndex();
+
+    //! Block the address index was last written with. The balance records are changed by deltas,
+    //! which must be applied once per block. False if the index was written by a version without it
+    bool ReadAddressIndexBestBlock(uint256 &hash);
+    void WriteAddressIndexBestBlock(CDBBatch &batch, const uint256 &hash);
+    //! Adds the address index records of a block, or removes them if fDisconnect, and moves the
+    //! index to hashBest in the same batch
+    void UpdateAddressIndex(CDBBatch &batch, const CDbIndexHelper &dbIndexHelper, int height, bool fDisconnect,
+                            const uint256 &hashBest);
 
     bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
+    void WriteTimestampIndex(CDBBatch &batch, const CTimestampIndexKey &timestampIndex);
     bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &vect);
-    bool WriteFlag(const std::string &name, bool fValue);
-    bool ReadFlag(const std::string &name, bool &fValue);
-    bool LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex);
-    int GetBlockIndexVersion();
-    int GetBlockIndexVersion(uint256 const & blockHash);
-    bool AddTotalSupply(CAmount const & supply);
-    bool ReadTotalSupply(CAmount & supply);
+
+    //! Moves here the index records written to the block index database by earlier versions.
+    //! Records are copied before being erased there, so an interrupted move is resumed on the next start
+    bool MoveIndexesFrom(CBlockTreeDB &blockTree);
+
+    bool ReadBuildState(CIndexBuildState &state);
+    void WriteBuildState(CDBBatch &batch, const CIndexBuildState &state);
+    bool EraseBuildState();
+    //! Erases all the records of the given indexes, for their build to start over
+    bool EraseIndexes(bool fAddressIndex, bool fSpentIndex, bool fTimestampIndex);
 };
 
 
@@ -168,13 +262,20 @@ public:
     using AddressIndex = std::vector<std::pair<CAddressIndexKey, CAmount> >;
     using AddressUnspentIndex = std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >;
     using SpentIndex = std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >;
+    using AddressBalanceIndex = std::map<std::pair<AddressType, uint160>, CAddressBalanceDelta>;
 
     AddressIndex const & getAddressIndex() const;
     AddressUnspentIndex const & getAddressUnspentIndex() const;
     SpentIndex const & getSpentIndex() const;
+    //! Balance changes of the addresses, to be applied along with (or undone as) the address index
+    AddressBalanceIndex const & getAddressBalanceIndex() const;
 
 private:
+    //! Adds the address index entries from position begin on to the balance changes
+    void addBalanceDeltas(size_t begin);
+
     boost::optional<AddressIndex> addressIndex;
+    boost::optional<AddressBalanceIndex> addressBalanceIndex;
     boost::optional<AddressUnspentIndex> addressUnspentIndex;
     boost::optional<SpentIndex> spentIndex;
 };
@@ -20,6 +20,7 @@
 #include "init.h"
 #include "base58.h"
 #include "merkleblock.h"
+#include "mtp_precheck.h"
 #include "net.h"
 #include "policy/fees.h"
 #include "policy/policy.h"
@@ -40,6 +41,8 @@
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "batchproof_container.h"
+#include "privacyproof_check.h"
+#include "privacystatedb.h"
 #include "sigma.h"
 #include "lelantus.h"
 #include "utilmoneystr.h"
@@ -108,13 +111,14 @@ bool fReindex = false;
 bool fTxIndex = false;
 bool fHavePruned = false;
 bool fPruneMode = false;
-bool fAddressIndex = false;
-bool fSpentIndex = false;
-bool fTimestampIndex = false;
+std::atomic_bool fAddressIndex(false);
+std::atomic_bool fSpentIndex(false);
+std::atomic_bool fTimestampIndex(false);
 bool fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
 bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
+bool fParanoidBlockReads = DEFAULT_PARANOID_BLOCK_READS;
 size_t nCoinCacheUsage = 5000 * 300;
 uint64_t nPruneTarget = 0;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
@@ -275,6 +279,7 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 
 CCoinsViewCache *pcoinsTip = NULL;
 CBlockTreeDB *pblocktree = NULL;
+CIndexDB *pindexdb = NULL;
 
 enum FlushStateMode {
     FLUSH_STATE_NONE,
@@ -578,7 +583,7 @@ int GetUTXOConfirmations(const COutPoint& outpoint)
     return (nPrevoutHeight > -1 && chainActive.Tip()) ? chainActive.Height() - nPrevoutHeight + 1 : -1;
 }
 
-bool CheckTransaction(const CTransaction &tx, CValidationState &state, bool fCheckDuplicateInputs, uint256 hashTx,  bool isVerifyDB, int nHeight, bool isCheckWallet, bool fStatefulZerocoinCheck, sigma::CSigmaTxInfo *sigmaTxInfo, lelantus::CLelantusTxInfo* lelantusTxInfo)
+bool CheckTransaction(const CTransaction &tx, CValidationState &state, bool fCheckDuplicateInputs, uint256 hashTx,  bool isVerifyDB, int nHeight, bool isCheckWallet, bool fStatefulZerocoinCheck, sigma::CSigmaTxInfo *sigmaTxInfo, lelantus::CLelantusTxInfo* lelantusTxInfo, std::vector<CPrivacyProofCheck> *pvProofChecks)
 {
     LogPrintf("CheckTransaction nHeight=%s, isVerifyDB=%s, isCheckWallet=%s, txHash=%s\n", nHeight, isVerifyDB, isCheckWallet, tx.GetHash().ToString());
 
@@ -652,12 +657,12 @@ bool CheckTransaction(const CTransaction &tx, CValidationState &state, bool fChe
                 return state.DoS(10, false, REJECT_INVALID, "bad-txns-prevout-null");
 
         if (tx.IsZerocoinV3SigmaTransaction()) {
-            if (!CheckSigmaTransaction(tx, state, hashTx, isVerifyDB, nHeight, isCheckWallet, fStatefulZerocoinCheck, sigmaTxInfo))
+            if (!CheckSigmaTransaction(tx, state, hashTx, isVerifyDB, nHeight, isCheckWallet, fStatefulZerocoinCheck, sigmaTxInfo, pvProofChecks))
                 return false;
         }
 
         if (tx.IsLelantusTransaction()) {
-            if (!CheckLelantusTransaction(tx, state, hashTx, isVerifyDB, nHeight, isCheckWallet, fStatefulZerocoinCheck, sigmaTxInfo, lelantusTxInfo))
+            if (!CheckLelantusTransaction(tx, state, hashTx, isVerifyDB, nHeight, isCheckWallet, fStatefulZerocoinCheck, sigmaTxInfo, lelantusTxInfo, pvProofChecks))
                 return false;
         }
 
@@ -1521,7 +1526,7 @@ bool GetTransaction(const uint256 &hash, CTransactionRef &txOut, const Consensus
 
     if (pindexSlow) {
         CBlock block;
-        if (ReadBlockFromDisk(block, pindexSlow, consensusParams)) {
+        if (ReadBlockFromDisk(block, pindexSlow, consensusParams, false)) {
             for (const auto& tx : block.vtx) {
                 if (tx->GetHash() == hash) {
                     txOut = tx;
@@ -1540,7 +1545,7 @@ bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, std::v
     if (!fTimestampIndex)
         return error("Timestamp index not enabled");
 
-    if (!pblocktree->ReadTimestampIndex(high, low, hashes))
+    if (!pindexdb->ReadTimestampIndex(high, low, hashes))
         return error("Unable to get hashes for timestamps");
 
     return true;
@@ -1555,31 +1560,44 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
     if (mempool.getSpentIndex(key, value))
         return true;
 
-    if (!pblocktree->ReadSpentIndex(key, value))
+    if (!pindexdb->ReadSpentIndex(key, value))
         return false;
 
     return true;
 }
 
 bool GetAddressIndex(uint160 addressHash, AddressType type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end)
+                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end,
+                     const CAddressIndexKey *pCursor, size_t nLimit)
 {
     if (!fAddressIndex)
         return error("address index not enabled");
 
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end))
+    if (!pindexdb->ReadAddressIndex(addressHash, type, addressIndex, start, end, pCursor, nLimit))
         return error("unable to get txids for address");
 
     return true;
 }
 
+bool GetAddressBalance(uint160 addressHash, AddressType type, CAddressBalanceValue &balance)
+{
+    if (!fAddressIndex)
+        return error("address index not enabled");
+
+    if (!pindexdb->ReadAddressBalanceIndex(addressHash, type, balance))
+        return error("unable to get balance for address");
+
+    return true;
+}
+
 bool GetAddressUnspent(uint160 addressHash, AddressType type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                       const CAddressUnspentKey *pCursor, size_t nLimit)
 {
     if (!fAddressIndex)
         return error("address index not enabled");
 
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs))
+    if (!pindexdb->ReadAddressUnspentIndex(addressHash, type, unspentOutputs, pCursor, nLimit))
         return error("unable to get txids for address");
 
     return true;
@@ -1613,7 +1631,22 @@ bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHea
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, int nHeight, const Consensus::Params& consensusParams)
+static std::atomic<uint64_t> nBlockReadsVerified(0);
+static std::atomic<uint64_t> nBlockReadsTrusted(0);
+static std::atomic<int64_t> nBlockReadVerifyTime(0);
+
+CBlockReadStats GetBlockReadStats()
+{
+    CBlockReadStats stats;
+    stats.nVerified = nBlockReadsVerified;
+    stats.nTrusted = nBlockReadsTrusted;
+    stats.nVerifyTime = nBlockReadVerifyTime;
+    // Trusted reads would have cost as much as the ones we did verify on average
+    stats.nSkippedTimeEstimate = stats.nVerified > 0 ? (int64_t)(stats.nVerifyTime * stats.nTrusted / stats.nVerified) : 0;
+    return stats;
+}
+
+static bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, int nHeight, const Consensus::Params& consensusParams, bool fCheckPOW, bool fKeepMTPHashData = true)
 {
     block.SetNull();
 
@@ -1624,12 +1657,29 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, int nHeight, con
 
     // Read block
     try {
-        filein >> block;
+        if (fCheckPOW || fKeepMTPHashData) {
+            filein >> block;
+        }
+        else {
+            // Firo - MTP
+            // The MTP proof data isn't needed, stream past it instead of allocating it
+            block.SerializationOp(filein, CBlockHeader::CReadBlockHeader());
+            if (block.IsMTP())
+                CMTPHashData::Skip(filein);
+            filein >> block.vtx;
+        }
     }
     catch (const std::exception &e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
 
+    if (!fCheckPOW) {
+        nBlockReadsTrusted++;
+        return true;
+    }
+
+    int64_t nTimeStart = GetTimeMicros();
+
     // Firo - MTP
     if (!CheckMerkleTreeProof(block, consensusParams)){
     	return error("ReadBlockFromDisk: CheckMerkleTreeProof: Errors in block header at %s", pos.ToString());
@@ -1639,11 +1689,26 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, int nHeight, con
     if (!CheckProofOfWork(block.GetPoWHash(nHeight), block.nBits, consensusParams))
         return error("ReadBlockFromDisk: CheckProofOfWork: Errors in block header at %s", pos.ToString());
 
+    nBlockReadVerifyTime += GetTimeMicros() - nTimeStart;
+    nBlockReadsVerified++;
+
+    if (!fKeepMTPHashData)
+        block.mtpHashData.reset();
+
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus::Params &consensusParams) {
-    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), pindex->nHeight, consensusParams))
+bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, int nHeight, const Consensus::Params& consensusParams)
+{
+    return ReadBlockFromDisk(block, pos, nHeight, consensusParams, true);
+}
+
+bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus::Params &consensusParams, bool fKeepMTPHashData) {
+    // Proof of work (and the MTP proof) of a block which has been fully validated was already
+    // checked when it was accepted. The hash check below still makes sure the header on disk is
+    // the one we validated, the MTP proof data is only re-checked with -paranoidblockreads.
+    bool fCheckPOW = fParanoidBlockReads || !pindex->IsValid(BLOCK_VALID_SCRIPTS);
+    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), pindex->nHeight, consensusParams, fCheckPOW, fKeepMTPHashData))
         return false;
 
     if (block.GetHash() != pindex->GetBlockHash()) {
@@ -1653,6 +1718,45 @@ bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus
     return true;
 }
 
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& messageStart)
+{
+    // The block is preceded by the message start and its size in the file, see WriteBlockToDisk
+    CDiskBlockPos pos = pindex->GetBlockPos();
+    if (pos.nPos < CMessageHeader::MESSAGE_START_SIZE + sizeof(unsigned int))
+        return error("ReadRawBlockFromDisk: invalid block position %s", pos.ToString());
+    pos.nPos -= CMessageHeader::MESSAGE_START_SIZE + sizeof(unsigned int);
+
+    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("ReadRawBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+
+    try {
+        CMessageHeader::MessageStartChars blockStart;
+        unsigned int nSize;
+        filein >> FLATDATA(blockStart) >> nSize;
+
+        if (memcmp(blockStart, messageStart, CMessageHeader::MESSAGE_START_SIZE) != 0)
+            return error("ReadRawBlockFromDisk: message start mismatch for %s at %s", pindex->ToString(), pos.ToString());
+        if (nSize > MAX_SIZE)
+            return error("ReadRawBlockFromDisk: invalid block size %u for %s at %s", nSize, pindex->ToString(), pos.ToString());
+
+        block.resize(nSize);
+        filein.read((char*)block.data(), nSize);
+    }
+    catch (const std::exception &e) {
+        return error("%s: Read or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+    }
+
+    // Same check as ReadBlockFromDisk: the block hash only covers the header fields, which
+    // are serialized at the start of the block, before the MTP proof data
+    size_t nHeaderSize = ::GetSerializeSize(pindex->GetBlockHeader(), SER_GETHASH, PROTOCOL_VERSION);
+    if (block.size() < nHeaderSize || Hash(block.begin(), block.begin() + nHeaderSize) != pindex->GetBlockHash())
+        return error("ReadRawBlockFromDisk: hash doesn't match index for %s at %s", pindex->ToString(), pos.ToString());
+
+    nBlockReadsTrusted++;
+    return true;
+}
+
 bool ReadBlockHeaderFromDisk(CBlock &block, const CDiskBlockPos &pos) {
     CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull())
@@ -2183,6 +2287,8 @@ bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint
     return true;
 }
 
+} // anon namespace
+
 bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uint256& hashBlock)
 {
     // Open history file to read
@@ -2209,8 +2315,6 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uin
     return true;
 }
 
-} // anon namespace
-
 /** Abort with a message */
 bool AbortNode(const std::string& strMessage, const std::string& userMessage)
 {
@@ -2266,6 +2370,29 @@ int ApplyTxInUndo(Coin&& undo, CCoinsViewCache& view, const COutPoint& out)
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
+// The address index is written once per block, as its balance records are changed by deltas. Sets fUpdate
+// to whether the records of the block are to be added (removed if fDisconnect) to it, not if the index has
+// them already, which is the case of the blocks reconnected by VerifyDB. Fails if the index is at another
+// block than the one the block is connected to (or disconnected from).
+static bool GetAddressIndexUpdate(const CBlockIndex* pindex, bool fDisconnect, bool& fUpdate)
+{
+    fUpdate = true;
+    uint256 hashBest;
+    // written by a version which didn't keep track of it
+    if (!pindexdb->ReadAddressIndexBestBlock(hashBest))
+        return true;
+    if (hashBest == (fDisconnect ? pindex->GetBlockHash() : pindex->pprev->GetBlockHash()))
+        return true;
+
+    BlockMap::const_iterator mi = mapBlockIndex.find(hashBest);
+    if (!fDisconnect && mi != mapBlockIndex.end() && mi->second->GetAncestor(pindex->nHeight) == pindex) {
+        fUpdate = false;
+        return true;
+    }
+    return error("%s: the address index is at block %s, it can't %s block %s", __func__, hashBest.ToString(),
+                 fDisconnect ? "disconnect" : "connect", pindex->GetBlockHash().ToString());
+}
+
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
  *  When UNCLEAN or FAILED is returned, view is left in an indeterminate state. */
 static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& state, const CBlockIndex* pindex, CCoinsViewCache& view, bool *pfClean = nullptr)
@@ -2364,20 +2491,24 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
     //When called from there, no real disconnect happens.
     if(!pfClean) {
         if (fAddressIndex) {
-            if (!pblocktree->EraseAddressIndex(dbIndexHelper.getAddressIndex())) {
-                AbortNode(state, "Failed to delete address index");
-                error("Failed to delete address index");
-                return DISCONNECT_FAILED;
-            }
-            if (!pblocktree->UpdateAddressUnspentIndex(dbIndexHelper.getAddressUnspentIndex())) {
-                AbortNode(state, "Failed to write address unspent index");
-                error("Failed to write address unspent index");
+            bool fUpdate;
+            if (!GetAddressIndexUpdate(pindex, true, fUpdate)) {
+                AbortNode(state, "Address index inconsistent with the chain state, restart with -reindex-chainstate");
                 return DISCONNECT_FAILED;
             }
-            if (!pblocktree->AddTotalSupply(-(block.vtx[0]->GetValueOut() - nFees))) {
-                AbortNode(state, "Failed to write total supply");
-                error("Failed to write total supply");
-                return DISCONNECT_FAILED;
+            if (fUpdate) {
+                CDBBatch batch(*pindexdb);
+                pindexdb->UpdateAddressIndex(batch, dbIndexHelper, pindex->nHeight, true, pindex->pprev->GetBlockHash());
+                if (!pindexdb->WriteBatch(batch)) {
+                    AbortNode(state, "Failed to delete address index");
+                    error("Failed to delete address index");
+                    return DISCONNECT_FAILED;
+                }
+                if (!pblocktree->AddTotalSupply(-(block.vtx[0]->GetValueOut() - nFees))) {
+                    AbortNode(state, "Failed to write total supply");
+                    error("Failed to write total supply");
+                    return DISCONNECT_FAILED;
+                }
             }
         }
     }
@@ -2432,6 +2563,14 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+// Every Sigma/Lelantus proof is heavy enough to be dispatched to the workers one by one
+static CCheckQueue<CPrivacyProofCheck> privacyproofcheckqueue(1);
+
+void ThreadPrivacyProofCheck() {
+    RenameThread("firo-proofcheck");
+    privacyproofcheckqueue.Thread();
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -2503,7 +2642,10 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     //btzc: update nHeight, isVerifyDB
     // Check it again in case a previous version let a bad block in
     LogPrintf("ConnectBlock nHeight=%s, hash=%s\n", pindex->nHeight, block.GetHash().ToString());
-    if (!CheckBlock(block, state, chainparams.GetConsensus(), !fJustCheck, !fJustCheck, pindex->nHeight, false)) {
+    // The MTP proof of a block with BLOCK_VALID_TRANSACTIONS was verified when it was accepted,
+    // it may have been read back from disk without the proof data since
+    bool fCheckMTPProof = !pindex->IsValid(BLOCK_VALID_TRANSACTIONS);
+    if (!CheckBlock(block, state, chainparams.GetConsensus(), !fJustCheck, !fJustCheck, pindex->nHeight, false, fCheckMTPProof)) {
         LogPrintf("--> failed\n");
         return error("%s: Consensus::CheckBlock: %s", __func__, FormatStateMessage(state));
     }
@@ -2636,6 +2778,8 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     CBlockUndo blockundo;
 
     CCheckQueueControl<CScriptCheck> control(fScriptChecks && nScriptCheckThreads ? &scriptcheckqueue : NULL);
+    // Sigma/Lelantus proofs are always verified, regardless of fScriptChecks
+    CCheckQueueControl<CPrivacyProofCheck> proofControl(nScriptCheckThreads ? &privacyproofcheckqueue : NULL);
 
     std::vector<int> prevheights;
     CAmount nFees = 0;
@@ -2652,10 +2796,14 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
 
     std::set<uint256> txIds;
     bool isMainNet = chainparams.GetConsensus().IsMain();
-    // batch verify Lelantus/Sigma if block is older than a day, that means we are syncing or reindexing
+    // batch verify Lelantus/Sigma if block is older than a day, that means we are syncing or reindexing,
+    // proofs of recent blocks are still batch verified, but one block at a time before it is accepted
     BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
-    batchProofContainer->fCollectProofs = ((GetSystemTimeInSeconds() - pindex->GetBlockTime()) > 86400) && GetBoolArg("-batching", true);
-    batchProofContainer->init();
+    bool fBatching = GetBoolArg("-batching", true);
+    bool fCollectProofs = ((GetSystemTimeInSeconds() - pindex->GetBlockTime()) > 86400) && fBatching;
+    bool fBatchBlockProofs = !fCollectProofs && fBatching;
+    batchProofContainer->fCollectProofs = fCollectProofs || fBatchBlockProofs;
+    batchProofContainer->init(pindex->GetBlockHash());
 
     block.sigmaTxInfo = std::make_shared<sigma::CSigmaTxInfo>();
     block.lelantusTxInfo = std::make_shared<lelantus::CLelantusTxInfo>();
@@ -2717,10 +2865,13 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
                 }
             }
 
-            // Check transaction against signa/lelantus state
-            if (!CheckTransaction(tx, state, false, txHash, false, pindex->nHeight, false, true, block.sigmaTxInfo.get(), block.lelantusTxInfo.get()))
+            // Check transaction against signa/lelantus state, proofs themselves are queued for the check threads
+            std::vector<CPrivacyProofCheck> vProofChecks;
+            if (!CheckTransaction(tx, state, false, txHash, false, pindex->nHeight, false, true, block.sigmaTxInfo.get(), block.lelantusTxInfo.get(),
+                                  nScriptCheckThreads ? &vProofChecks : NULL))
                 return state.DoS(100, error("stateful zerocoin check failed"),
                                  REJECT_INVALID, "bad-txns-zerocoin");
+            proofControl.Add(vProofChecks);
         }
 
         if (!fJustCheck)
@@ -2771,6 +2922,18 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
 
     if (!control.Wait())
         return state.DoS(100, false);
+    if (!proofControl.Wait())
+        return state.DoS(100, error("ConnectBlock(): sigma/lelantus proof verification failed"),
+                         REJECT_INVALID, "bad-txns-zerocoin");
+    if (fBatchBlockProofs) {
+        std::set<uint256> failedTxs;
+        if (!batchProofContainer->verify_block(failedTxs)) {
+            for (const uint256& hash : failedTxs)
+                LogPrintf("ConnectBlock(): invalid sigma/lelantus proof in transaction %s\n", hash.ToString());
+            return state.DoS(100, error("ConnectBlock(): sigma/lelantus batch proof verification failed"),
+                             REJECT_INVALID, "bad-txns-zerocoin");
+        }
+    }
     int64_t nTime4 = GetTimeMicros(); nTimeVerify += nTime4 - nTime2;
     LogPrint("bench", "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs]\n", nInputs - 1, 0.001 * (nTime4 - nTime2), nInputs <= 1 ? 0 : 0.001 * (nTime4 - nTime2) / (nInputs-1), nTimeVerify * 0.000001);
 
@@ -2858,23 +3021,28 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
         if (!pblocktree->WriteTxIndex(vPos))
             return AbortNode(state, "Failed to write transaction index");
     if (fAddressIndex) {
-        if (!pblocktree->WriteAddressIndex(dbIndexHelper.getAddressIndex()))
-            return AbortNode(state, "Failed to write address index");
+        bool fUpdate;
+        if (!GetAddressIndexUpdate(pindex, false, fUpdate))
+            return AbortNode(state, "Address index inconsistent with the chain state, restart with -reindex-chainstate");
 
-        if (!pblocktree->UpdateAddressUnspentIndex(dbIndexHelper.getAddressUnspentIndex()))
-            return AbortNode(state, "Failed to write address unspent index");
+        if (fUpdate) {
+            CDBBatch batch(*pindexdb);
+            pindexdb->UpdateAddressIndex(batch, dbIndexHelper, pindex->nHeight, false, pindex->GetBlockHash());
+            if (!pindexdb->WriteBatch(batch))
+                return AbortNode(state, "Failed to write address index");
 
-        if (!pblocktree->AddTotalSupply(block.vtx[0]->GetValueOut() - nFees))
-            return AbortNode(state, "Failed to write total supply");
+            if (!pblocktree->AddTotalSupply(block.vtx[0]->GetValueOut() - nFees))
+                return AbortNode(state, "Failed to write total supply");
+        }
     }
 
     if (fSpentIndex)
-        if (!pblocktree->UpdateSpentIndex(dbIndexHelper.getSpentIndex()))
+        if (!pindexdb->UpdateSpentIndex(dbIndexHelper.getSpentIndex()))
             return AbortNode(state, "Failed to write transaction index");
 
 
     if (fTimestampIndex)
-        if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())))
+        if (!pindexdb->WriteTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())))
             return AbortNode(state, "Failed to write timestamp index");
 
     // add this block to the view's block chain
@@ -3179,7 +3347,7 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     assert(pindexDelete);
     // Read block from disk.
     CBlock block;
-    if (!ReadBlockFromDisk(block, pindexDelete, chainparams.GetConsensus()))
+    if (!ReadBlockFromDisk(block, pindexDelete, chainparams.GetConsensus(), false))
         return AbortNode(state, "Failed to read block");
 
 
@@ -3386,7 +3554,8 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     if (!pblock) {
         std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
         connectTrace.blocksConnected.emplace_back(pindexNew, pblockNew);
-        if (!ReadBlockFromDisk(*pblockNew, pindexNew, chainparams.GetConsensus()))
+        // the block was checked when accepted, so its MTP proof data isn't needed to connect it
+        if (!ReadBlockFromDisk(*pblockNew, pindexNew, chainparams.GetConsensus(), false))
             return AbortNode(state, "Failed to read block");
     } else {
         connectTrace.blocksConnected.emplace_back(pindexNew, pblock);
@@ -3822,6 +3991,10 @@ bool ActivateBestChain(CValidationState &state, const CChainParams& chainparams,
             if (!ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && pblock->GetHash() == pindexMostWork->GetBlockHash() ? pblock : nullBlockPtr, fInvalidFound, connectTrace))
                 return false;
 
+            // proofs collected from earlier blocks may have failed batch verification in the last ConnectBlock
+            if (InvalidateBlocksFailedBatchVerification(state, chainparams))
+                fInvalidFound = true;
+
             if (fInvalidFound) {
                 // Wipe cache, we may need another branch now.
                 pindexMostWork = NULL;
@@ -3938,6 +4111,52 @@ bool InvalidateBlock(CValidationState& state, const CChainParams& chainparams, C
     return true;
 }
 
+bool InvalidateBlocksFailedBatchVerification(CValidationState& state, const CChainParams& chainparams)
+{
+    AssertLockHeld(cs_main);
+
+    bool fInvalidated = false;
+    for (const uint256& hash : BatchProofContainer::get_instance()->takeFailedBlocks()) {
+        BlockMap::iterator it = mapBlockIndex.find(hash);
+        if (it == mapBlockIndex.end())
+            continue;
+
+        LogPrintf("%s: block %s contains proofs which failed batch verification, invalidating it\n", __func__, hash.ToString());
+        if (InvalidateBlock(state, chainparams, it->second))
+            fInvalidated = true;
+    }
+    return fInvalidated;
+}
+
+bool WriteBlocksFailedBatchVerification()
+{
+    std::set<uint256> failedBlocks = BatchProofContainer::get_instance()->takeFailedBlocks();
+    if (failedBlocks.empty())
+        return true;
+
+    LogPrintf("%s: %u blocks contain proofs which failed batch verification, they are invalidated on the next start\n",
+              __func__, failedBlocks.size());
+    return pblocktree->WriteFailedBatchBlocks(failedBlocks);
+}
+
+bool LoadBlocksFailedBatchVerification(CValidationState& state, const CChainParams& chainparams)
+{
+    AssertLockHeld(cs_main);
+
+    std::set<uint256> failedBlocks;
+    if (!pblocktree->ReadFailedBatchBlocks(failedBlocks))
+        return error("%s: failed to read the blocks which failed batch verification", __func__);
+    if (failedBlocks.empty())
+        return true;
+
+    BatchProofContainer::get_instance()->addFailedBlocks(failedBlocks);
+    InvalidateBlocksFailedBatchVerification(state, chainparams);
+    if (state.IsError())
+        return false;
+
+    return pblocktree->WriteFailedBatchBlocks(std::set<uint256>());
+}
+
 bool ResetBlockFailureFlags(CBlockIndex *pindex) {
     AssertLockHeld(cs_main);
 
@@ -4160,7 +4379,7 @@ bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const
     return true;
 }
 
-bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot, int nHeight, bool isVerifyDB) {
+bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot, int nHeight, bool isVerifyDB, bool fCheckMTPProof) {
     // CheckBlock not only checks the block, but also fills up lelantusTxInfo and sigmaTxInfo.
     if (!block.sigmaTxInfo)
         block.sigmaTxInfo = std::make_shared<sigma::CSigmaTxInfo>();
@@ -4195,7 +4414,7 @@ bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::P
             return state.DoS(100, false, REJECT_INVALID, "bad-txns-duplicate", true, "duplicate transaction");
 
         // Firo - MTP
-        if (block.IsMTP() && !CheckMerkleTreeProof(block, consensusParams))
+        if (fCheckMTPProof && block.IsMTP() && !MTPPrecheck::get_instance()->check(block, consensusParams))
             return state.DoS(100, false, REJECT_INVALID, "bad-diffbits", false, "incorrect proof of work");
     }
 
@@ -5018,16 +5237,35 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     pblocktree->ReadFlag("txindex", fTxIndex);
     LogPrintf("%s: transaction index %s\n", __func__, fTxIndex ? "enabled" : "disabled");
 
+    // Indexes used to be written to the block index database
+    if (!pindexdb->MoveIndexesFrom(*pblocktree))
+        return error("%s: failed to move the indexes to their database", __func__);
+
     // Check whether we have an address index
-    pblocktree->ReadFlag("addressindex", fAddressIndex);
+    bool fReadAddressIndex = false;
+    pblocktree->ReadFlag("addressindex", fReadAddressIndex);
+    fAddressIndex = fReadAddressIndex;
     LogPrintf("%s: address index %s\n", __func__, fAddressIndex ? "enabled" : "disabled");
 
+    // Address indexes written before the balance records were introduced get them from their history, once
+    bool fAddressBalanceIndex = false;
+    pblocktree->ReadFlag("addressbalanceindex", fAddressBalanceIndex);
+    if (fAddressIndex && !fAddressBalanceIndex) {
+        if (!pindexdb->BuildAddressBalanceIndex())
+            return error("%s: failed to build the address balance index", __func__);
+        pblocktree->WriteFlag("addressbalanceindex", true);
+    }
+
     // Check whether we have a timestamp index
-    pblocktree->ReadFlag("timestampindex", fTimestampIndex);
+    bool fReadTimestampIndex = false;
+    pblocktree->ReadFlag("timestampindex", fReadTimestampIndex);
+    fTimestampIndex = fReadTimestampIndex;
     LogPrintf("%s: timestamp index %s\n", __func__, fTimestampIndex ? "enabled" : "disabled");
 
     // Check whether we have a spent index
-    pblocktree->ReadFlag("spentindex", fSpentIndex);
+    bool fReadSpentIndex = false;
+    pblocktree->ReadFlag("spentindex", fReadSpentIndex);
+    fSpentIndex = fReadSpentIndex;
     LogPrintf("%s: spent index %s\n", __func__, fSpentIndex ? "enabled" : "disabled");
 
 
@@ -5039,8 +5277,13 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
 
     PruneBlockIndexCandidates();
 
-    sigma::BuildSigmaStateFromIndex(&chainActive);
-    lelantus::BuildLelantusStateFromIndex(&chainActive);
+    // Sigma and Lelantus state is loaded as stored at shutdown if it's still in sync with the tip,
+    // otherwise it's rebuilt from every block of the chain
+    if (!pprivacystatedb || !pprivacystatedb->ReadState(chainActive.Tip()->GetBlockHash(),
+            *sigma::CSigmaState::GetState(), *lelantus::CLelantusState::GetState())) {
+        sigma::BuildSigmaStateFromIndex(&chainActive);
+        lelantus::BuildLelantusStateFromIndex(&chainActive);
+    }
 
     // Initialize MTP state
     MTPState::GetMTPState()->InitializeFromChain(&chainActive, chainparams.GetConsensus());
@@ -5123,7 +5366,9 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
         }
         // check level 3: check for inconsistencies during memory-only disconnect of tip blocks
         if (nCheckLevel >= 3 && pindex == pindexState && (coins.DynamicMemoryUsage() + pcoinsTip->DynamicMemoryUsage()) <= nCoinCacheUsage) {
-            DisconnectResult res = DisconnectBlock(block, state, pindex, coins);
+            // the indexes are left as they are, the blocks are disconnected in memory only
+            bool fClean;
+            DisconnectResult res = DisconnectBlock(block, state, pindex, coins, &fClean);
             if (res == DISCONNECT_FAILED) {
                 return error("VerifyDB(): *** irrecoverable inconsistency in block data at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
             }
@@ -5149,7 +5394,7 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
             uiInterface.ShowProgress(_("Verifying blocks..."), std::max(1, std::min(99, 100 - (int)(((double)(chainActive.Height() - pindex->nHeight)) / (double)nCheckDepth * 50))));
             pindex = chainActive.Next(pindex);
             CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
+            if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus(), false))
                 return error("VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
             if (!ConnectBlock(block, state, pindex, coins, chainparams))
                 return error("VerifyDB(): *** found unconnectable block at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
@@ -5302,6 +5547,7 @@ bool InitBlockIndex(const CChainParams& chainparams)
     // Use the provided setting for -addressindex in the new database
     fAddressIndex = GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
     pblocktree->WriteFlag("addressindex", fAddressIndex);
+    pblocktree->WriteFlag("addressbalanceindex", fAddressIndex);
 
     fSpentIndex = GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
     pblocktree->WriteFlag("spentindex", fSpentIndex);
@@ -38,11 +38,14 @@
 #include <boost/filesystem/path.hpp>
 
 class CBlockIndex;
+class CBlockUndo;
 class CBlockTreeDB;
 class CBloomFilter;
 class CChainParams;
+class CIndexDB;
 class CInv;
 class CConnman;
+class CPrivacyProofCheck;
 class CScriptCheck;
 class CTxMemPool;
 class CTxPoolAggregate;
@@ -195,10 +198,16 @@ extern std::atomic_bool fImporting;
 extern bool fReindex;
 extern int nScriptCheckThreads;
 extern bool fTxIndex;
+/** Whether the optional indexes are maintained, written under cs_main and read without it */
+extern std::atomic_bool fAddressIndex;
+extern std::atomic_bool fSpentIndex;
+extern std::atomic_bool fTimestampIndex;
 extern bool fIsBareMultisigStd;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
+/** Re-check proof of work of already validated blocks when reading them from disk */
+extern bool fParanoidBlockReads;
 //extern int nBestHeight;
 
 // Settings
@@ -235,6 +244,7 @@ static const unsigned int MIN_BLOCKS_TO_KEEP = 288;
 
 static const signed int DEFAULT_CHECKBLOCKS = 6;
 static const unsigned int DEFAULT_CHECKLEVEL = 3;
+static const bool DEFAULT_PARANOID_BLOCK_READS = false;
 
 // Require that user allocate at least 550MB for block & undo files (blk???.dat and rev???.dat)
 // At 1MB per block, 288 blocks = 288MB.
@@ -297,6 +307,8 @@ bool LoadBlockIndex(const CChainParams& chainparams);
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the Sigma/Lelantus proof checking thread */
+void ThreadPrivacyProofCheck();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Format a string that describes several potential problems detected by the core.
@@ -426,7 +438,7 @@ void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, int nHeight);
 /** Transaction validation functions */
 
 /** Context-independent validity checks */
-bool CheckTransaction(const CTransaction& tx, CValidationState& state, bool fCheckDuplicateInputs, uint256 hashTx, bool isVerifyDB, int nHeight = INT_MAX, bool isCheckWallet = false, bool fStatefulZerocoinCheck = true, sigma::CSigmaTxInfo *sigmaTxInfo = NULL, lelantus::CLelantusTxInfo* lelantusTxInfo = NULL);
+bool CheckTransaction(const CTransaction& tx, CValidationState& state, bool fCheckDuplicateInputs, uint256 hashTx, bool isVerifyDB, int nHeight = INT_MAX, bool isCheckWallet = false, bool fStatefulZerocoinCheck = true, sigma::CSigmaTxInfo *sigmaTxInfo = NULL, lelantus::CLelantusTxInfo* lelantusTxInfo = NULL, std::vector<CPrivacyProofCheck> *pvProofChecks = NULL);
 
 namespace Consensus {
 
@@ -528,20 +540,38 @@ bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, std::v
 bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
 bool GetAddressIndex(uint160 addressHash, AddressType type,
                      std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                     int start = 0, int end = 0);
+                     int start = 0, int end = 0,
+                     const CAddressIndexKey *pCursor = nullptr, size_t nLimit = 0);
 bool GetAddressUnspent(uint160 addressHash, AddressType type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs);
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                       const CAddressUnspentKey *pCursor = nullptr, size_t nLimit = 0);
+bool GetAddressBalance(uint160 addressHash, AddressType type, CAddressBalanceValue &balance);
 
 /** Functions for disk access for blocks */
 bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, int nHeight, const Consensus::Params& consensusParams);
-bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+/** Reads the block of pindex. Without fKeepMTPHashData the MTP proof data is dropped (or not read at all
+ *  when the proof doesn't need to be checked); the block can't be serialized for peers or disk then. */
+bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams, bool fKeepMTPHashData = true);
+/** Reads the serialized block of pindex as it is stored on disk, without deserializing it or checking its proof of work */
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& messageStart);
+/** Reads the undo data of a block stored at pos, hashBlock being the hash of the parent of that block */
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uint256& hashBlock);
+
+/** Counters of the proof of work checks done (and skipped for validated blocks) by ReadBlockFromDisk */
+struct CBlockReadStats {
+    uint64_t nVerified;             //!< reads which checked the proof of work
+    uint64_t nTrusted;              //!< reads which skipped it as the block was already validated
+    int64_t nVerifyTime;            //!< time spent checking, in microseconds
+    int64_t nSkippedTimeEstimate;   //!< time saved by the skipped checks, estimated from the average
+};
+CBlockReadStats GetBlockReadStats();
 
 /** Functions for validating blocks and updating the block tree */
 
 /** Context-independent validity checks */
 bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true);
-bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true, int nHeight = INT_MAX, bool isVerifyDB = false);
+bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true, int nHeight = INT_MAX, bool isVerifyDB = false, bool fCheckMTPProof = true);
 
 bool IsTransactionInChain(const uint256& txId, int& nHeightTx, CTransactionRef & tx);
 bool IsTransactionInChain(const uint256& txId, int& nHeightTx);
@@ -600,6 +630,15 @@ bool PreciousBlock(CValidationState& state, const CChainParams& params, CBlockIn
 /** Mark a block as invalid. */
 bool InvalidateBlock(CValidationState& state, const CChainParams& chainparams, CBlockIndex *pindex);
 
+/** Invalidate the blocks BatchProofContainer found invalid Sigma/Lelantus proofs in. Returns true if any were invalidated. */
+bool InvalidateBlocksFailedBatchVerification(CValidationState& state, const CChainParams& chainparams);
+
+/** Store the blocks BatchProofContainer found invalid Sigma/Lelantus proofs in while shutting down. */
+bool WriteBlocksFailedBatchVerification();
+
+/** Invalidate the blocks stored by WriteBlocksFailedBatchVerification at the last shutdown. */
+bool LoadBlocksFailedBatchVerification(CValidationState& state, const CChainParams& chainparams);
+
 /** Remove invalidity status from a block and its descendants. */
 bool ResetBlockFailureFlags(CBlockIndex *pindex);
 
@@ -612,6 +651,9 @@ extern CCoinsViewCache *pcoinsTip;
 /** Global variable that points to the active block tree (protected by cs_main) */
 extern CBlockTreeDB *pblocktree;
 
+/** Global variable that points to the address, spent and timestamp indexes (protected by cs_main) */
+extern CIndexDB *pindexdb;
+
 /**
  * Return the spend height, which is one more than the inputs.GetBestBlock().
  * While checking, GetBestBlock() refers to the parent block. (protected by cs_main)
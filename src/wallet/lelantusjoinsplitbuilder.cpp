@@ -8,9 +8,12 @@
 
 
 #include "../lelantus.h"
+#include "../liblelantus/lelantus_prover.h"
 
 #include <boost/format.hpp>
+#include <list>
 #include <random>
+#include <tuple>
 
 struct CoinCompare
 {
@@ -19,6 +22,59 @@ struct CoinCompare
     }
 };
 
+namespace {
+
+// sigma set flag, group id (with the denomination for sigma), block hash of the set, set size
+typedef std::tuple<bool, uint32_t, uint256, std::size_t> AnonymitySetKey;
+
+struct PrecomputedAnonymitySet {
+    // sigma sets converted to lelantus coins, left empty for lelantus sets as the caller already holds them
+    std::vector<lelantus::PublicCoin> set;
+    std::shared_ptr<const secp_primitives::FixedBaseMultiExponent> multiexp;
+};
+
+// Anonymity sets of the latest spends with their multi-exponentiation precomputations,
+// so building several joinsplits from the same set doesn't redo them every time.
+const std::size_t ANONYMITY_SET_CACHE_SIZE = 4;
+
+CCriticalSection cs_anonymitySetCache;
+std::list<std::pair<AnonymitySetKey, std::shared_ptr<const PrecomputedAnonymitySet>>> anonymitySetCache;
+
+std::shared_ptr<const secp_primitives::FixedBaseMultiExponent> PrecomputeMultiExponent(const std::vector<lelantus::PublicCoin>& set)
+{
+    std::vector<GroupElement> points;
+    points.reserve(set.size());
+    for (const auto& coin : set)
+        points.emplace_back(coin.getValue());
+    return std::make_shared<const secp_primitives::FixedBaseMultiExponent>(points);
+}
+
+std::shared_ptr<const PrecomputedAnonymitySet> GetPrecomputedAnonymitySet(
+        const AnonymitySetKey& key,
+        const std::function<std::shared_ptr<const PrecomputedAnonymitySet>()>& build)
+{
+    {
+        LOCK(cs_anonymitySetCache);
+        for (auto it = anonymitySetCache.begin(); it != anonymitySetCache.end(); ++it) {
+            if (it->first == key) {
+                anonymitySetCache.splice(anonymitySetCache.begin(), anonymitySetCache, it);
+                return it->second;
+            }
+        }
+    }
+
+    auto entry = build();
+
+    LOCK(cs_anonymitySetCache);
+    anonymitySetCache.emplace_front(key, entry);
+    if (anonymitySetCache.size() > ANONYMITY_SET_CACHE_SIZE)
+        anonymitySetCache.pop_back();
+
+    return entry;
+}
+
+}
+
 LelantusJoinSplitBuilder::LelantusJoinSplitBuilder(CWallet& wallet, CHDMintWallet& mintWallet, const CCoinControl *coinControl) :
     wallet(wallet),
     mintWallet(mintWallet)
@@ -33,6 +89,9 @@ LelantusJoinSplitBuilder::LelantusJoinSplitBuilder(CWallet& wallet, CHDMintWalle
     }
 
     this->coinControl = coinControl;
+
+    int nThreads = GetArg("-lelantusproverthreads", DEFAULT_LELANTUS_PROVER_THREADS);
+    nProverThreads = nThreads > 0 ? nThreads : std::max(GetNumCores(), 1);
 }
 
 LelantusJoinSplitBuilder::~LelantusJoinSplitBuilder()
@@ -414,6 +473,7 @@ void LelantusJoinSplitBuilder::CreateJoinSplit(
     std::vector<std::pair<lelantus::PrivateCoin, uint32_t>> coins;
     coins.reserve(spendCoins.size());
     std::map<uint32_t, std::vector<lelantus::PublicCoin>> anonymity_sets;
+    lelantus::LelantusProver::PrecomputedSets precomputedSets;
     std::map<uint32_t, uint256> groupBlockHashes;
     int version = 0;
 
@@ -465,8 +525,16 @@ void LelantusJoinSplitBuilder::CreateJoinSplit(
                     setHash) < 2)
                 throw std::runtime_error(
                         _("Has to have at least two mint coins with at least 2 confirmation in order to spend a coin"));
+            auto precomputed = GetPrecomputedAnonymitySet(
+                    AnonymitySetKey(false, groupId, blockHash, set.size()),
+                    [&set]() {
+                        auto entry = std::make_shared<PrecomputedAnonymitySet>();
+                        entry->multiexp = PrecomputeMultiExponent(set);
+                        return std::shared_ptr<const PrecomputedAnonymitySet>(entry);
+                    });
             groupBlockHashes[groupId] = blockHash;
-            anonymity_sets[groupId] = set;
+            anonymity_sets[groupId] = std::move(set);
+            precomputedSets[groupId] = precomputed->multiexp;
             if (!setHash.empty())
                 anonymity_set_hashes.push_back(setHash);
         }
@@ -514,20 +582,28 @@ void LelantusJoinSplitBuilder::CreateJoinSplit(
                     group) < 2)
                 throw std::runtime_error(
                         _("Has to have at least two mint coins with at least 2 confirmation in order to spend a coin"));
-            std::vector<lelantus::PublicCoin> set;
-            set.reserve(group.size());
-            for(auto& coin : group) {
-                set.push_back(coin.getValue() + params->get_h1() * denom);
-            }
+            // the converted set is cached as well, it costs a multiplication per coin
+            auto precomputed = GetPrecomputedAnonymitySet(
+                    AnonymitySetKey(true, denom / 1000 + groupId, blockHash, group.size()),
+                    [&]() {
+                        auto entry = std::make_shared<PrecomputedAnonymitySet>();
+                        entry->set.reserve(group.size());
+                        for(auto& coin : group) {
+                            entry->set.push_back(coin.getValue() + params->get_h1() * denom);
+                        }
+                        entry->multiexp = PrecomputeMultiExponent(entry->set);
+                        return std::shared_ptr<const PrecomputedAnonymitySet>(entry);
+                    });
             groupBlockHashes[denom / 1000 + groupId] = blockHash;
-            anonymity_sets[denom / 1000 + groupId] = set;
+            anonymity_sets[denom / 1000 + groupId] = precomputed->set;
+            precomputedSets[denom / 1000 + groupId] = precomputed->multiexp;
         }
 
     }
 
     std::sort(coins.begin(), coins.end(), CoinCompare());
 
-    lelantus::JoinSplit joinSplit(params, coins, anonymity_sets, anonymity_set_hashes, Vout, Cout, fee, groupBlockHashes, txHash, version);
+    lelantus::JoinSplit joinSplit(params, coins, anonymity_sets, anonymity_set_hashes, Vout, Cout, fee, groupBlockHashes, txHash, version, nProverThreads, precomputedSets);
 
     std::vector<lelantus::PublicCoin>  pCout;
     pCout.reserve(Cout.size());
@@ -41,6 +41,9 @@ public:
     bool isSigmaToLelantusJoinSplit = false;
     CAmount fee = 0;
 
+    // threads used by Build() to generate the JoinSplit proof, from -lelantusproverthreads
+    std::size_t nProverThreads;
+
 private:
     CHDMintWallet& mintWallet;
 };
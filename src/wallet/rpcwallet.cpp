@@ -913,6 +913,56 @@ UniValue getunconfirmedbalance(const JSONRPCRequest &request)
     return ValueFromAmount(pwallet->GetUnconfirmedBalance());
 }
 
+static UniValue WalletBalancesToJSON(const CWalletBalances& balances)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("balance", ValueFromAmount(balances.nBalance)));
+    obj.push_back(Pair("unconfirmed_balance", ValueFromAmount(balances.nUnconfirmedBalance)));
+    obj.push_back(Pair("immature_balance", ValueFromAmount(balances.nImmatureBalance)));
+    obj.push_back(Pair("watchonly_balance", ValueFromAmount(balances.nWatchOnlyBalance)));
+    obj.push_back(Pair("unconfirmed_watchonly_balance", ValueFromAmount(balances.nUnconfirmedWatchOnlyBalance)));
+    obj.push_back(Pair("immature_watchonly_balance", ValueFromAmount(balances.nImmatureWatchOnlyBalance)));
+    obj.push_back(Pair("private_balance", ValueFromAmount(balances.nPrivateBalance)));
+    obj.push_back(Pair("unconfirmed_private_balance", ValueFromAmount(balances.nUnconfirmedPrivateBalance)));
+    obj.push_back(Pair("private_coins", (uint64_t)balances.nPrivateCoins));
+    obj.push_back(Pair("unconfirmed_private_coins", (uint64_t)balances.nUnconfirmedPrivateCoins));
+    return obj;
+}
+
+UniValue verifywalletbalances(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "verifywalletbalances\n"
+            "\nChecks the cached wallet balances against balances summed up from all wallet transactions and mints.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"consistent\": true|false,   (boolean) Whether the cached balances match the recomputed ones\n"
+            "  \"cached\": {...},            (object) The balances served by getbalance and friends\n"
+            "  \"computed\": {...}           (object) The balances summed up from scratch\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("verifywalletbalances", "")
+            + HelpExampleRpc("verifywalletbalances", "")
+        );
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    CWalletBalances cached = pwallet->GetCachedBalances();
+    CWalletBalances computed = pwallet->ComputeBalances();
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("consistent", cached == computed));
+    ret.push_back(Pair("cached", WalletBalancesToJSON(cached)));
+    ret.push_back(Pair("computed", WalletBalancesToJSON(computed)));
+    return ret;
+}
+
 
 UniValue movecmd(const JSONRPCRequest& request)
 {
@@ -4807,6 +4857,7 @@ static const CRPCCommand commands[] =
     { "wallet",             "getreceivedbyaddress",     &getreceivedbyaddress,     false,  {"address","minconf"} },
     { "wallet",             "gettransaction",           &gettransaction,           false,  {"txid","include_watchonly"} },
     { "wallet",             "getunconfirmedbalance",    &getunconfirmedbalance,    false,  {} },
+    { "wallet",             "verifywalletbalances",     &verifywalletbalances,     false,  {} },
     { "wallet",             "getwalletinfo",            &getwalletinfo,            false,  {} },
     { "wallet",             "importmulti",              &importmulti,              true,   {"requests","options"} },
     { "wallet",             "importprivkey",            &importprivkey,            true,   {"privkey","label","rescan"} },
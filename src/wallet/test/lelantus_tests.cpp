@@ -1,13 +1,87 @@
 #include "../../test/fixtures.h"
 #include "../../validation.h"
 #include "../../lelantus.h"
+#include "../../primitives/mint_spend.h"
 #include "../walletexcept.h"
 #include <exception>
+#include <set>
 
 #include "../wallet.h"
 
 #include <boost/test/unit_test.hpp>
 
+// Outputs of the unused mints of the wallet, found by matching every mint output of the wallet
+// against every unused mint, as ListAvailableLelantusMintCoins did before the mints were indexed.
+static std::set<std::pair<uint256, unsigned int>> ScanAvailableLelantusMintCoins(bool fOnlyConfirmed)
+{
+    std::set<std::pair<uint256, unsigned int>> outputs;
+
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+    auto ownCoins = pwalletMain->zwallet->GetTracker().MintsAsLelantusEntries(true, false);
+    for (auto const &item : pwalletMain->mapWallet) {
+        CWalletTx const &wtx = item.second;
+        if (!CheckFinalTx(wtx) || (fOnlyConfirmed && !wtx.IsTrusted()) || wtx.GetDepthInMainChain() < 0)
+            continue;
+
+        for (unsigned int i = 0; i != wtx.tx->vout.size(); i++) {
+            auto const &script = wtx.tx->vout[i].scriptPubKey;
+            if (!script.IsLelantusMint() && !script.IsLelantusJMint())
+                continue;
+
+            secp_primitives::GroupElement pubCoin;
+            lelantus::ParseLelantusMintScript(script, pubCoin);
+            for (auto const &coin : ownCoins) {
+                if (coin.value == pubCoin && !coin.IsUsed && !coin.randomness.isZero() && !coin.serialNumber.isZero())
+                    outputs.emplace(wtx.GetHash(), i);
+            }
+        }
+    }
+
+    return outputs;
+}
+
+static void CheckAvailableLelantusMintCoins()
+{
+    for (bool fOnlyConfirmed : {true, false}) {
+        std::vector<COutput> coins;
+        pwalletMain->ListAvailableLelantusMintCoins(coins, fOnlyConfirmed);
+
+        std::set<std::pair<uint256, unsigned int>> outputs;
+        for (auto const &out : coins)
+            outputs.emplace(out.tx->GetHash(), out.i);
+
+        BOOST_CHECK_EQUAL(outputs.size(), coins.size());
+        BOOST_CHECK(outputs == ScanAvailableLelantusMintCoins(fOnlyConfirmed));
+    }
+}
+
+// Checks the pubcoin lookups of the tracker against a scan of the mints it lists
+static void CheckLelantusMintIndex(std::vector<CLelantusMintMeta> const &mints)
+{
+    auto &tracker = pwalletMain->zwallet->GetTracker();
+    auto listed = tracker.ListLelantusMints(false, false, false, false, true);
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+
+    for (auto const &mint : mints) {
+        uint256 hashPubcoin = mint.GetPubCoinValueHash();
+        auto it = std::find_if(listed.begin(), listed.end(), [&hashPubcoin](CLelantusMintMeta const &m) {
+            return m.GetPubCoinValueHash() == hashPubcoin;
+        });
+        bool fListed = it != listed.end();
+
+        CLelantusMintMeta meta;
+        BOOST_CHECK_EQUAL(tracker.GetLelantusMetaFromPubcoin(hashPubcoin, meta), fListed);
+        if (fListed) {
+            BOOST_CHECK(meta.hashSerial == it->hashSerial);
+            BOOST_CHECK_EQUAL(meta.isUsed, it->isUsed);
+        }
+
+        // mint pool entries are keyed by the pubcoin without the amount
+        auto reducedPubcoin = mint.GetPubCoinValue() + lelantus::Params::get_default()->get_h1() * Scalar(mint.amount).negate();
+        BOOST_CHECK_EQUAL(tracker.HasPubcoinHash(primitives::GetPubCoinValueHash(reducedPubcoin), walletdb), fListed);
+    }
+}
+
 BOOST_FIXTURE_TEST_SUITE(wallet_lelantus_tests, LelantusTestingSetup)
 
 BOOST_AUTO_TEST_CASE(create_mint_recipient)
@@ -120,6 +194,55 @@ BOOST_AUTO_TEST_CASE(get_and_list_mints)
     BOOST_CHECK(!pwalletMain->GetMint(fakeSerial, entry));
 }
 
+BOOST_AUTO_TEST_CASE(mint_index_matches_scan)
+{
+    GenerateBlocks(120);
+    auto &tracker = pwalletMain->zwallet->GetTracker();
+
+    // added to the wallet
+    std::vector<CMutableTransaction> txs;
+    auto hdMints = GenerateMints({1 * COIN, 2 * COIN, 3 * COIN, 4 * COIN}, txs);
+    auto mints = tracker.ListLelantusMints(false, false, false, false, true);
+    BOOST_REQUIRE_EQUAL(mints.size(), hdMints.size());
+    CheckLelantusMintIndex(mints);
+    CheckAvailableLelantusMintCoins();
+
+    // updated from the block
+    GenerateBlock(txs);
+    std::vector<std::pair<lelantus::PublicCoin, std::pair<uint64_t, uint256>>> pubCoins;
+    for (auto const &mint : hdMints) {
+        pubCoins.emplace_back(mint.GetPubcoinValue(), std::make_pair(mint.GetAmount(), uint256()));
+    }
+    tracker.UpdateMintStateFromBlock(pubCoins);
+    CheckLelantusMintIndex(mints);
+    CheckAvailableLelantusMintCoins();
+
+    std::vector<COutput> coins;
+    pwalletMain->ListAvailableLelantusMintCoins(coins, false);
+    BOOST_CHECK_EQUAL(coins.size(), mints.size());
+
+    // spent
+    tracker.SetLelantusPubcoinUsed(mints[0].GetPubCoinValueHash(), GetRandHash());
+    CheckLelantusMintIndex(mints);
+    CheckAvailableLelantusMintCoins();
+
+    // archived
+    CLelantusMintMeta meta;
+    BOOST_CHECK(tracker.Archive(mints[1]));
+    BOOST_CHECK(!tracker.GetLelantusMetaFromPubcoin(mints[1].GetPubCoinValueHash(), meta));
+    CheckLelantusMintIndex(mints);
+    CheckAvailableLelantusMintCoins();
+
+    // listed again from the wallet database, which has the archived mint moved out
+    tracker.ListLelantusMints(false, false, false, true);
+    BOOST_CHECK(!tracker.GetLelantusMetaFromPubcoin(mints[1].GetPubCoinValueHash(), meta));
+    CheckLelantusMintIndex(mints);
+    CheckAvailableLelantusMintCoins();
+
+    pwalletMain->ListAvailableLelantusMintCoins(coins, false);
+    BOOST_CHECK_EQUAL(coins.size(), mints.size() - 2);
+}
+
 BOOST_AUTO_TEST_CASE(mintlelantus_and_mint_all)
 {
     // utils
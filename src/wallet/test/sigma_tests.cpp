@@ -241,6 +241,30 @@ static bool ContainTxOut(const std::vector<CTxOut>& outs, const std::pair<const
     return (expectedOccurrence < 0 && occurrence > 0) || (occurrence == expectedOccurrence);
 }
 
+// Checks the pubcoin lookups of the tracker against a scan of the mints it lists
+static void CheckSigmaMintIndex(const std::vector<CMintMeta>& mints)
+{
+    auto& tracker = pwalletMain->zwallet->GetTracker();
+    auto listed = tracker.ListMints(false, false, false, false, true);
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+
+    for (auto& mint : mints) {
+        uint256 hashPubcoin = mint.GetPubCoinValueHash();
+        auto it = std::find_if(listed.begin(), listed.end(), [&hashPubcoin](const CMintMeta& m) {
+            return m.GetPubCoinValueHash() == hashPubcoin;
+        });
+        bool fListed = it != listed.end();
+
+        CMintMeta meta;
+        BOOST_CHECK_EQUAL(tracker.GetMetaFromPubcoin(hashPubcoin, meta), fListed);
+        BOOST_CHECK_EQUAL(tracker.HasPubcoinHash(hashPubcoin, walletdb), fListed);
+        if (fListed) {
+            BOOST_CHECK(meta.hashSerial == it->hashSerial);
+            BOOST_CHECK_EQUAL(meta.isUsed, it->isUsed);
+        }
+    }
+}
+
 BOOST_FIXTURE_TEST_SUITE(wallet_sigma_tests, WalletSigmaTestingSetup)
 
 BOOST_AUTO_TEST_CASE(get_coin_no_coin)
@@ -610,6 +634,51 @@ BOOST_AUTO_TEST_CASE(create_spend_with_coins_more_than_1)
     sigmaState->Reset();
 }
 
+BOOST_AUTO_TEST_CASE(mint_index_matches_scan)
+{
+    auto& tracker = pwalletMain->zwallet->GetTracker();
+
+    // added to the wallet
+    GenerateBlockWithCoins({
+        std::make_pair(sigma::CoinDenomination::SIGMA_DENOM_10, 2),
+        std::make_pair(sigma::CoinDenomination::SIGMA_DENOM_1, 2)
+    });
+    auto mints = tracker.ListMints(false, false, false, false, true);
+    BOOST_REQUIRE_EQUAL(mints.size(), 4u);
+    CheckSigmaMintIndex(mints);
+
+    // updated from the chain
+    GenerateEmptyBlocks(5);
+    std::vector<sigma::PublicCoin> pubCoins;
+    for (auto& mint : mints) {
+        pubCoins.emplace_back(mint.GetPubCoinValue(), mint.denom);
+    }
+    tracker.UpdateMintStateFromBlock(pubCoins);
+    CheckSigmaMintIndex(mints);
+
+    // spent
+    tracker.SetPubcoinUsed(mints[0].GetPubCoinValueHash(), GetRandHash());
+    CheckSigmaMintIndex(mints);
+
+    // archived
+    CMintMeta meta;
+    BOOST_CHECK(tracker.Archive(mints[1]));
+    BOOST_CHECK(!tracker.GetMetaFromPubcoin(mints[1].GetPubCoinValueHash(), meta));
+    CheckSigmaMintIndex(mints);
+
+    // listed again from the wallet database, which has the archived mint moved out
+    tracker.ListMints(false, false, false, true);
+    BOOST_CHECK(!tracker.GetMetaFromPubcoin(mints[1].GetPubCoinValueHash(), meta));
+    CheckSigmaMintIndex(mints);
+
+    // the mints of this fixture have no transactions in the wallet, so none of them is listed
+    std::vector<COutput> coins;
+    pwalletMain->ListAvailableSigmaMintCoins(coins, false);
+    BOOST_CHECK(coins.empty());
+
+    sigmaState->Reset();
+}
+
 BOOST_AUTO_TEST_CASE(spend)
 {
     CWalletTx tx;
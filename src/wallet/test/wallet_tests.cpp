@@ -430,6 +430,68 @@ BOOST_FIXTURE_TEST_CASE(rescan, TestChain100Setup)
     }
 }
 
+// Verify cached balances are recomputed when the chain tip moves, even when the
+// wallet isn't notified about the block.
+BOOST_FIXTURE_TEST_CASE(balance_cache, TestChain100Setup)
+{
+    LOCK(cs_main);
+
+    CWallet wallet;
+    LOCK(wallet.cs_wallet);
+    wallet.AddKeyPubKey(coinbaseKey, coinbaseKey.GetPubKey());
+    wallet.ScanForWalletTransactions(chainActive.Genesis());
+
+    CAmount nBalance = wallet.GetBalance();
+    CAmount nImmature = wallet.GetImmatureBalance();
+    BOOST_CHECK(wallet.GetCachedBalances() == wallet.ComputeBalances());
+
+    // Maturing a coinbase moves its value from the immature to the spendable balance
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    BOOST_CHECK(wallet.GetCachedBalances() == wallet.ComputeBalances());
+    BOOST_CHECK_EQUAL(wallet.GetBalance() + wallet.GetImmatureBalance(), nBalance + nImmature);
+    BOOST_CHECK(wallet.GetBalance() > nBalance);
+
+    // Transactions added to the wallet invalidate the cache
+    nImmature = wallet.GetImmatureBalance();
+    wallet.ScanForWalletTransactions(chainActive.Tip());
+    BOOST_CHECK(wallet.GetCachedBalances() == wallet.ComputeBalances());
+    BOOST_CHECK(wallet.GetImmatureBalance() > nImmature);
+}
+
+// Verify the unconfirmed balance is recomputed when a wallet transaction leaves the
+// mempool without being mined.
+BOOST_FIXTURE_TEST_CASE(balance_cache_mempool_removal, TestChain100Setup)
+{
+    LOCK(cs_main);
+
+    CWallet wallet;
+    mempool.NotifyEntryRemoved.connect(boost::bind(&CWallet::TransactionRemovedFromMempool, &wallet, _1, _2));
+    {
+        LOCK(wallet.cs_wallet);
+        wallet.AddKeyPubKey(coinbaseKey, coinbaseKey.GetPubKey());
+
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout.hash = GetRandHash();
+        mtx.vin[0].prevout.n = 0;
+        mtx.vout.resize(1);
+        mtx.vout[0].nValue = 11 * CENT;
+        mtx.vout[0].scriptPubKey = GetScriptForRawPubKey(coinbaseKey.GetPubKey());
+        CTransaction tx(mtx);
+
+        TestMemPoolEntryHelper entry;
+        mempool.addUnchecked(tx.GetHash(), entry.FromTx(tx));
+        wallet.AddToWallet(CWalletTx(&wallet, MakeTransactionRef(tx)));
+        BOOST_CHECK_EQUAL(wallet.GetUnconfirmedBalance(), 11 * CENT);
+
+        // Expiry is not a wallet event, the mempool notification drops the cache
+        mempool.removeRecursive(tx, MemPoolRemovalReason::EXPIRY);
+        BOOST_CHECK(wallet.GetCachedBalances() == wallet.ComputeBalances());
+        BOOST_CHECK_EQUAL(wallet.GetUnconfirmedBalance(), 0);
+    }
+    mempool.NotifyEntryRemoved.disconnect(boost::bind(&CWallet::TransactionRemovedFromMempool, &wallet, _1, _2));
+}
+
 // Verify importwallet RPC starts rescan at earliest block with timestamp
 // greater or equal than key birthday. Previously there was a bug where
 // importwallet RPC would start the scan at the latest block with timestamp less
@@ -1034,6 +1034,7 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         BOOST_FOREACH(PAIRTYPE(const uint256, CWalletTx)& item, mapWallet)
             item.second.MarkDirty();
+        MarkBalancesDirty();
     }
 }
 
@@ -1197,6 +1198,7 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
 
     // Break debit/credit balance caches:
     wtx.MarkDirty();
+    MarkBalancesDirty();
 
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
@@ -1222,6 +1224,7 @@ bool CWallet::LoadToWallet(const CWalletTx& wtxIn)
     wtx.BindWallet(this);
     wtxOrdered.insert(make_pair(wtx.nOrderPos, TxPair(&wtx, (CAccountingEntry*)0)));
     AddToSpends(hash);
+    MarkBalancesDirty();
     BOOST_FOREACH(const CTxIn& txin, wtx.tx->vin) {
         if (mapWallet.count(txin.prevout.hash)) {
             CWalletTx& prevtx = mapWallet[txin.prevout.hash];
@@ -1318,6 +1321,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
             wtx.nIndex = -1;
             wtx.setAbandoned();
             wtx.MarkDirty();
+            MarkBalancesDirty();
             walletdb.WriteTx(wtx);
             NotifyTransactionChanged(this, wtx.GetHash(), CT_UPDATED);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them abandoned too
@@ -1476,6 +1480,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, const uint256& hashTx)
             wtx.nIndex = -1;
             wtx.hashBlock = hashBlock;
             wtx.MarkDirty();
+            MarkBalancesDirty();
             walletdb.WriteTx(wtx);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
             TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
@@ -1511,6 +1516,7 @@ void CWallet::SyncTransaction(const CTransaction& tx, const CBlockIndex *pindex,
         if (mapWallet.count(txin.prevout.hash))
             mapWallet[txin.prevout.hash].MarkDirty();
     }
+    MarkBalancesDirty();
 }
 
 
@@ -2127,7 +2133,7 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex *pindexStart, bool f
             }
 
             CBlock block;
-            if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            if (ReadBlockFromDisk(block, pindex, Params().GetConsensus(), false)) {
                 for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
                     AddToWalletIfInvolvingMe(*block.vtx[posInBlock], pindex, posInBlock, fUpdate);
                 }
@@ -2552,39 +2558,27 @@ void CWallet::ResendWalletTransactions(int64_t nBestBlockTime, CConnman* connman
  */
 
 
-CAmount CWallet::GetBalance(bool fExcludeLocked) const
+CWalletBalances CWallet::ComputeBalances() const
 {
-    CAmount nTotal = 0;
+    CWalletBalances balances;
+
+    LOCK2(cs_main, cs_wallet);
+    for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
     {
-        LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-        {
-            const CWalletTx* pcoin = &(*it).second;
-            if (pcoin->IsTrusted())
-                nTotal += pcoin->GetAvailableCredit(true, fExcludeLocked);
+        const CWalletTx* pcoin = &(*it).second;
+        if (pcoin->IsTrusted()) {
+            balances.nBalance += pcoin->GetAvailableCredit();
+            balances.nWatchOnlyBalance += pcoin->GetAvailableWatchOnlyCredit();
+        } else if (pcoin->GetDepthInMainChain() == 0 && (pcoin->InMempool() || pcoin->InStempool())) {
+            balances.nUnconfirmedBalance += pcoin->GetAvailableCredit();
+            balances.nUnconfirmedWatchOnlyBalance += pcoin->GetAvailableWatchOnlyCredit();
         }
+        balances.nImmatureBalance += pcoin->GetImmatureCredit();
+        balances.nImmatureWatchOnlyBalance += pcoin->GetImmatureWatchOnlyCredit();
     }
 
-    return nTotal;
-}
-
-std::pair<CAmount, CAmount> CWallet::GetPrivateBalance() const
-{
-    size_t confirmed, unconfirmed;
-    return GetPrivateBalance(confirmed, unconfirmed);
-}
-
-std::pair<CAmount, CAmount> CWallet::GetPrivateBalance(size_t &confirmed, size_t &unconfirmed) const
-{
-    std::pair<CAmount, CAmount> balance = {0, 0};
-
-    confirmed = 0;
-    unconfirmed = 0;
-
-    auto zwallet = pwalletMain->zwallet.get();
-
-    if(!zwallet)
-        return balance;
+    if (!zwallet)
+        return balances;
 
     auto lelantusCoins = zwallet->GetTracker().ListLelantusMints(true, false, false);
     for (auto const &c : lelantusCoins) {
@@ -2597,11 +2591,11 @@ std::pair<CAmount, CAmount> CWallet::GetPrivateBalance(size_t &confirmed, size_t
             ? chainActive.Height() - c.nHeight + 1 : 0;
 
         if (conf >= ZC_MINT_CONFIRMATIONS) {
-            confirmed++;
-            balance.first += c.amount;
+            balances.nPrivateCoins++;
+            balances.nPrivateBalance += c.amount;
         } else {
-            unconfirmed++;
-            balance.second += c.amount;
+            balances.nUnconfirmedPrivateCoins++;
+            balances.nUnconfirmedPrivateBalance += c.amount;
         }
     }
 
@@ -2621,15 +2615,91 @@ std::pair<CAmount, CAmount> CWallet::GetPrivateBalance(size_t &confirmed, size_t
             ? chainActive.Height() - c.nHeight + 1 : 0;
 
         if (conf >= ZC_MINT_CONFIRMATIONS) {
-            confirmed++;
-            balance.first += amount;
+            balances.nPrivateCoins++;
+            balances.nPrivateBalance += amount;
         } else {
-            unconfirmed++;
-            balance.second += amount;
+            balances.nUnconfirmedPrivateCoins++;
+            balances.nUnconfirmedPrivateBalance += amount;
         }
     }
 
-    return balance;
+    return balances;
+}
+
+const CWalletBalances& CWallet::GetCachedBalances() const
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    uint64_t nTrackerCounter = zwallet ? zwallet->GetTracker().GetUpdateCounter() : 0;
+    if (!fBalancesCached || pindexBalancesTip != chainActive.Tip() || nBalancesTrackerCounter != nTrackerCounter) {
+        int64_t nTimeStart = GetTimeMicros();
+        // set before summing up, a transaction leaving the mempool meanwhile clears it again
+        fBalancesCached = true;
+        fBalanceExcludeLockedCached = false;
+        cachedBalances = ComputeBalances();
+        pindexBalancesTip = chainActive.Tip();
+        nBalancesTrackerCounter = nTrackerCounter;
+        LogPrint("bench", "%s: recomputed wallet balances over %u transactions: %.2fms\n", __func__,
+            mapWallet.size(), 0.001 * (GetTimeMicros() - nTimeStart));
+    }
+
+    return cachedBalances;
+}
+
+void CWallet::MarkBalancesDirty()
+{
+    LOCK(cs_wallet);
+    fBalancesCached = false;
+    fBalanceExcludeLockedCached = false;
+}
+
+void CWallet::TransactionRemovedFromMempool(CTransactionRef tx, MemPoolRemovalReason reason)
+{
+    // the pool lock is held here, taking cs_wallet would invert the lock order, so every
+    // removal drops the cache; mined transactions are covered by the moved chain tip
+    if (reason == MemPoolRemovalReason::BLOCK)
+        return;
+    fBalancesCached = false;
+    fBalanceExcludeLockedCached = false;
+}
+
+CAmount CWallet::GetBalance(bool fExcludeLocked) const
+{
+    LOCK2(cs_main, cs_wallet);
+    const CWalletBalances& balances = GetCachedBalances();
+    if (!fExcludeLocked)
+        return balances.nBalance;
+
+    if (!fBalanceExcludeLockedCached) {
+        CAmount nTotal = 0;
+        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+        {
+            const CWalletTx* pcoin = &(*it).second;
+            if (pcoin->IsTrusted())
+                nTotal += pcoin->GetAvailableCredit(true, true);
+        }
+        nBalanceExcludeLockedCached = nTotal;
+        fBalanceExcludeLockedCached = true;
+    }
+
+    return nBalanceExcludeLockedCached;
+}
+
+std::pair<CAmount, CAmount> CWallet::GetPrivateBalance() const
+{
+    size_t confirmed, unconfirmed;
+    return GetPrivateBalance(confirmed, unconfirmed);
+}
+
+std::pair<CAmount, CAmount> CWallet::GetPrivateBalance(size_t &confirmed, size_t &unconfirmed) const
+{
+    LOCK2(cs_main, cs_wallet);
+    const CWalletBalances& balances = GetCachedBalances();
+
+    confirmed = balances.nPrivateCoins;
+    unconfirmed = balances.nUnconfirmedPrivateCoins;
+    return {balances.nPrivateBalance, balances.nUnconfirmedPrivateBalance};
 }
 
 std::vector<CRecipient> CWallet::CreateSigmaMintRecipients(
@@ -2955,7 +3025,7 @@ std::list<CLelantusEntry> CWallet::GetAvailableLelantusCoins(const CCoinControl
 
         // Check group size
         uint256 hashOut;
-        std::vector<lelantus::PublicCoin> coinOuts;
+        lelantus::AnonymitySetPtr coinOuts;
         std::vector<unsigned char> setHash;
         state->GetCoinSetForSpend(
             &chainActive,
@@ -2966,7 +3036,7 @@ std::list<CLelantusEntry> CWallet::GetAvailableLelantusCoins(const CCoinControl
             setHash
         );
 
-        if (!includeUnsafe && coinOuts.size() < 2) {
+        if (!includeUnsafe && (!coinOuts || coinOuts->nCoins < 2)) {
             return true;
         }
 
@@ -3280,71 +3350,29 @@ bool CWallet::GetCoinsToJoinSplit(
 }
 
 CAmount CWallet::GetUnconfirmedBalance() const {
-    CAmount nTotal = 0;
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
-            const CWalletTx *pcoin = &(*it).second;
-            if (!pcoin->IsTrusted() && pcoin->GetDepthInMainChain() == 0 &&
-                (pcoin->InMempool() || pcoin->InStempool()))
-                nTotal += pcoin->GetAvailableCredit();
-        }
-    }
-    return nTotal;
+    LOCK2(cs_main, cs_wallet);
+    return GetCachedBalances().nUnconfirmedBalance;
 }
 
 CAmount CWallet::GetImmatureBalance() const {
-    CAmount nTotal = 0;
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
-            const CWalletTx *pcoin = &(*it).second;
-            nTotal += pcoin->GetImmatureCredit();
-        }
-    }
-    return nTotal;
+    LOCK2(cs_main, cs_wallet);
+    return GetCachedBalances().nImmatureBalance;
 }
 
 CAmount CWallet::GetWatchOnlyBalance() const {
-    CAmount nTotal = 0;
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
-            const CWalletTx *pcoin = &(*it).second;
-            if (pcoin->IsTrusted())
-                nTotal += pcoin->GetAvailableWatchOnlyCredit();
-        }
-    }
-
-    return nTotal;
+    LOCK2(cs_main, cs_wallet);
+    return GetCachedBalances().nWatchOnlyBalance;
 }
 
 CAmount CWallet::GetUnconfirmedWatchOnlyBalance() const {
-    CAmount nTotal = 0;
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
-            const CWalletTx *pcoin = &(*it).second;
-            if (!pcoin->IsTrusted() && pcoin->GetDepthInMainChain() == 0 &&
-                (pcoin->InMempool() || pcoin->InStempool()))
-                nTotal += pcoin->GetAvailableWatchOnlyCredit();
-        }
-    }
-    return nTotal;
+    LOCK2(cs_main, cs_wallet);
+    return GetCachedBalances().nUnconfirmedWatchOnlyBalance;
 }
 
 CAmount CWallet::GetImmatureWatchOnlyBalance() const
 {
-    CAmount nTotal = 0;
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-        {
-            const CWalletTx* pcoin = &(*it).second;
-            nTotal += pcoin->GetImmatureWatchOnlyCredit();
-        }
-    }
-    return nTotal;
+    LOCK2(cs_main, cs_wallet);
+    return GetCachedBalances().nImmatureWatchOnlyBalance;
 }
 
 void CWallet::AvailableCoins(std::vector <COutput> &vCoins, bool fOnlyConfirmed, const CCoinControl *coinControl, bool fIncludeZeroValue) const
@@ -3546,49 +3574,53 @@ void CWallet::ListAvailableSigmaMintCoins(std::vector<COutput> &vCoins, bool fOn
 
     vCoins.clear();
     LOCK2(cs_main, cs_wallet);
-    std::list<CSigmaEntry> listOwnCoins;
-    CWalletDB walletdb(pwalletMain->strWalletFile);
-    listOwnCoins = zwallet->GetTracker().MintsAsSigmaEntries(true, false);
-    LogPrintf("listOwnCoins.size()=%s\n", listOwnCoins.size());
-    for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
+    // Start from the unused mints of the tracker and look up their transactions, rather
+    // than walking all of mapWallet for mint outputs.
+    for (const CMintMeta& meta : zwallet->GetTracker().ListMints(true, false, false)) {
+        // non-deterministic mints have no txid until their status is updated from the chain,
+        // those are found by the outpoint of their pubcoin
+        std::map<uint256, CWalletTx>::const_iterator it = mapWallet.find(meta.txid);
+        COutPoint outPoint;
+        if (it == mapWallet.end() && sigma::GetOutPoint(outPoint, meta.GetPubCoinValue()))
+            it = mapWallet.find(outPoint.hash);
+        if (it == mapWallet.end())
+            continue;
+
         const CWalletTx *pcoin = &(*it).second;
-//        LogPrintf("pcoin=%s\n", pcoin->GetHash().ToString());
-        if (!CheckFinalTx(*pcoin)) {
-            LogPrintf("!CheckFinalTx(*pcoin)=%s\n", !CheckFinalTx(*pcoin));
+        if (!CheckFinalTx(*pcoin))
             continue;
-        }
 
-        if (fOnlyConfirmed && !pcoin->IsTrusted()) {
-            LogPrintf("fOnlyConfirmed = %s, !pcoin->IsTrusted()\n", fOnlyConfirmed, !pcoin->IsTrusted());
+        if (fOnlyConfirmed && !pcoin->IsTrusted())
             continue;
-        }
 
-        if (pcoin->IsCoinBase() && pcoin->GetBlocksToMaturity() > 0) {
-            LogPrintf("Not trusted\n");
+        if (pcoin->IsCoinBase() && pcoin->GetBlocksToMaturity() > 0)
             continue;
-        }
 
         int nDepth = pcoin->GetDepthInMainChain();
-        if (nDepth < 0) {
-            LogPrintf("nDepth=%s\n", nDepth);
+        if (nDepth < 0)
+            continue;
+
+        CSigmaEntry entry;
+        if (!GetMint(meta.hashSerial, entry))
+            continue;
+        if (entry.IsUsed || entry.randomness == uint64_t(0) || entry.serialNumber == uint64_t(0))
             continue;
-        }
-        LogPrintf("pcoin->tx->vout.size()=%s\n", pcoin->tx->vout.size());
 
         for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-            if (pcoin->tx->vout[i].scriptPubKey.IsSigmaMint()) {
-                CTxOut txout = pcoin->tx->vout[i];
-                secp_primitives::GroupElement pubCoin = sigma::ParseSigmaMintScript(
-                    txout.scriptPubKey);
-                LogPrintf("Pubcoin=%s\n", pubCoin.tostring());
-                // CHECKING PROCESS
-                BOOST_FOREACH(const CSigmaEntry &ownCoinItem, listOwnCoins) {
-                   if (ownCoinItem.value == pubCoin && ownCoinItem.IsUsed == false &&
-                        ownCoinItem.randomness != uint64_t(0) && ownCoinItem.serialNumber != uint64_t(0)) {
-                        vCoins.push_back(COutput(pcoin, i, nDepth, true, true));
-                        LogPrintf("-->OK\n");
-                    }
-                }
+            const CScript& script = pcoin->tx->vout[i].scriptPubKey;
+            if (!script.IsSigmaMint())
+                continue;
+
+            secp_primitives::GroupElement pubCoin;
+            try {
+                pubCoin = sigma::ParseSigmaMintScript(script);
+            } catch (std::invalid_argument&) {
+                continue;
+            }
+
+            if (pubCoin == entry.value) {
+                vCoins.push_back(COutput(pcoin, i, nDepth, true, true));
+                break;
             }
         }
     }
@@ -3599,49 +3631,49 @@ void CWallet::ListAvailableLelantusMintCoins(std::vector<COutput> &vCoins, bool
 
     vCoins.clear();
     LOCK2(cs_main, cs_wallet);
-    std::list<CLelantusEntry> listOwnCoins;
-    CWalletDB walletdb(pwalletMain->strWalletFile);
-    listOwnCoins = zwallet->GetTracker().MintsAsLelantusEntries(true, false);
-    LogPrintf("listOwnCoins.size()=%s\n", listOwnCoins.size());
-    for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
+    for (const CLelantusMintMeta& meta : zwallet->GetTracker().ListLelantusMints(true, false, false)) {
+        std::map<uint256, CWalletTx>::const_iterator it = mapWallet.find(meta.txid);
+        COutPoint outPoint;
+        if (it == mapWallet.end() && lelantus::GetOutPoint(outPoint, meta.GetPubCoinValue()))
+            it = mapWallet.find(outPoint.hash);
+        if (it == mapWallet.end())
+            continue;
+
         const CWalletTx *pcoin = &(*it).second;
-//        LogPrintf("pcoin=%s\n", pcoin->GetHash().ToString());
-        if (!CheckFinalTx(*pcoin)) {
-            LogPrintf("!CheckFinalTx(*pcoin)=%s\n", !CheckFinalTx(*pcoin));
+        if (!CheckFinalTx(*pcoin))
             continue;
-        }
 
-        if (fOnlyConfirmed && !pcoin->IsTrusted()) {
-            LogPrintf("fOnlyConfirmed = %s, !pcoin->IsTrusted() = %s\n", fOnlyConfirmed, !pcoin->IsTrusted());
+        if (fOnlyConfirmed && !pcoin->IsTrusted())
             continue;
-        }
 
-        if (pcoin->IsCoinBase() && pcoin->GetBlocksToMaturity() > 0) {
-            LogPrintf("Not trusted\n");
+        if (pcoin->IsCoinBase() && pcoin->GetBlocksToMaturity() > 0)
             continue;
-        }
 
         int nDepth = pcoin->GetDepthInMainChain();
-        if (nDepth < 0) {
-            LogPrintf("nDepth=%s\n", nDepth);
+        if (nDepth < 0)
+            continue;
+
+        CLelantusEntry entry;
+        if (!GetMint(meta.hashSerial, entry))
+            continue;
+        if (entry.IsUsed || entry.randomness.isZero() || entry.serialNumber.isZero())
             continue;
-        }
-        LogPrintf("pcoin->tx->vout.size()=%s\n", pcoin->tx->vout.size());
 
         for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-            if (pcoin->tx->vout[i].scriptPubKey.IsLelantusMint() || pcoin->tx->vout[i].scriptPubKey.IsLelantusJMint()) {
-                CTxOut txout = pcoin->tx->vout[i];
-                secp_primitives::GroupElement pubCoin;
-                lelantus::ParseLelantusMintScript(txout.scriptPubKey, pubCoin);
-                LogPrintf("Pubcoin=%s\n", pubCoin.tostring());
-                // CHECKING PROCESS
-                BOOST_FOREACH(const CLelantusEntry& ownCoinItem, listOwnCoins) {
-                    if (ownCoinItem.value == pubCoin && ownCoinItem.IsUsed == false &&
-                        !ownCoinItem.randomness.isZero() && !ownCoinItem.serialNumber.isZero()) {
-                        vCoins.push_back(COutput(pcoin, i, nDepth, true, true));
-                        LogPrintf("-->OK\n");
-                    }
-                }
+            const CScript& script = pcoin->tx->vout[i].scriptPubKey;
+            if (!script.IsLelantusMint() && !script.IsLelantusJMint())
+                continue;
+
+            secp_primitives::GroupElement pubCoin;
+            try {
+                lelantus::ParseLelantusMintScript(script, pubCoin);
+            } catch (std::invalid_argument&) {
+                continue;
+            }
+
+            if (pubCoin == entry.value) {
+                vCoins.push_back(COutput(pcoin, i, nDepth, true, true));
+                break;
             }
         }
     }
@@ -4365,6 +4397,7 @@ bool CWallet::EraseFromWallet(uint256 hash) {
         LOCK(cs_wallet);
         if (mapWallet.erase(hash))
             CWalletDB(strWalletFile).EraseTx(hash);
+        MarkBalancesDirty();
     }
     return true;
 }
@@ -6260,18 +6293,21 @@ void CWallet::LockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.insert(output);
+    fBalanceExcludeLockedCached = false;
 }
 
 void CWallet::UnlockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.erase(output);
+    fBalanceExcludeLockedCached = false;
 }
 
 void CWallet::UnlockAllCoins()
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.clear();
+    fBalanceExcludeLockedCached = false;
 }
 
 bool CWallet::IsLockedCoin(uint256 hash, unsigned int n) const
@@ -6477,6 +6513,7 @@ std::string CWallet::GetWalletHelpString(bool showDebug)
     strUsage += HelpMessageOpt("-mnemonic=<text>", _("User defined mnemonic for HD wallet (bip39). Only has effect during wallet creation/first start (default: randomly generated)"));
     strUsage += HelpMessageOpt("-mnemonicpassphrase=<text>", _("User defined mnemonic passphrase for HD wallet (BIP39). Only has effect during wallet creation/first start (default: empty string)"));
     strUsage += HelpMessageOpt("-hdseed=<hex>", _("User defined seed for HD wallet (should be in hex). Only has effect during wallet creation/first start (default: randomly generated)"));
+    strUsage += HelpMessageOpt("-lelantusproverthreads=<n>", strprintf(_("Set the number of threads generating Lelantus JoinSplit proofs (0 = number of cores, default: %d)"), DEFAULT_LELANTUS_PROVER_THREADS));
     strUsage += HelpMessageOpt("-batching", _("In case of sync/reindex verifies sigma/lelantus proofs with batch verification, default: true"));
     strUsage += HelpMessageOpt("-walletrbf", strprintf(_("Send transactions with full-RBF opt-in enabled (default: %u)"), DEFAULT_WALLET_RBF));
     strUsage += HelpMessageOpt("-upgradewallet", _("Upgrade wallet to latest format on startup"));
@@ -6649,6 +6686,8 @@ CWallet* CWallet::CreateWalletFromFile(const std::string walletFile)
     }
 
     RegisterValidationInterface(walletInstance);
+    mempool.NotifyEntryRemoved.connect(boost::bind(&CWallet::TransactionRemovedFromMempool, walletInstance, _1, _2));
+    txpools.getStemTxPool().NotifyEntryRemoved.connect(boost::bind(&CWallet::TransactionRemovedFromMempool, walletInstance, _1, _2));
 
     CBlockIndex *pindexRescan = chainActive.Tip();
     if (GetBoolArg("-rescan", false))
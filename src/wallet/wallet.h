@@ -92,6 +92,9 @@ static const bool DEFAULT_USE_HD_WALLET = true;
 //! if set, all keys will be derived by using BIP39
 static const bool DEFAULT_USE_MNEMONIC = true;
 
+//! number of threads generating Lelantus JoinSplit proofs, 0 = number of cores
+static const int DEFAULT_LELANTUS_PROVER_THREADS = 0;
+
 extern const char * DEFAULT_WALLET_DAT;
 
 const uint32_t BIP32_HARDENED_KEY_LIMIT = 0x80000000;
@@ -112,6 +115,7 @@ class CReserveKey;
 class CScript;
 class CTxMemPool;
 class CWalletTx;
+enum class MemPoolRemovalReason;
 namespace bip47 {
 class CPaymentChannel;
 }
@@ -145,6 +149,35 @@ struct CompactTallyItem
     }
 };
 
+/** Wallet balance totals, as returned by CWallet::GetBalance() and friends */
+struct CWalletBalances
+{
+    CAmount nBalance = 0;
+    CAmount nUnconfirmedBalance = 0;
+    CAmount nImmatureBalance = 0;
+    CAmount nWatchOnlyBalance = 0;
+    CAmount nUnconfirmedWatchOnlyBalance = 0;
+    CAmount nImmatureWatchOnlyBalance = 0;
+    CAmount nPrivateBalance = 0;
+    CAmount nUnconfirmedPrivateBalance = 0;
+    size_t nPrivateCoins = 0;
+    size_t nUnconfirmedPrivateCoins = 0;
+
+    friend bool operator==(const CWalletBalances& a, const CWalletBalances& b)
+    {
+        return a.nBalance == b.nBalance &&
+            a.nUnconfirmedBalance == b.nUnconfirmedBalance &&
+            a.nImmatureBalance == b.nImmatureBalance &&
+            a.nWatchOnlyBalance == b.nWatchOnlyBalance &&
+            a.nUnconfirmedWatchOnlyBalance == b.nUnconfirmedWatchOnlyBalance &&
+            a.nImmatureWatchOnlyBalance == b.nImmatureWatchOnlyBalance &&
+            a.nPrivateBalance == b.nPrivateBalance &&
+            a.nUnconfirmedPrivateBalance == b.nUnconfirmedPrivateBalance &&
+            a.nPrivateCoins == b.nPrivateCoins &&
+            a.nUnconfirmedPrivateCoins == b.nUnconfirmedPrivateCoins;
+    }
+};
+
 
 /** A key pool entry */
 class CKeyPool
@@ -672,6 +705,20 @@ private:
     mutable bool fAnonymizableTallyCachedNonDenom;
     mutable std::vector<CompactTallyItem> vecAnonymizableTallyCachedNonDenom;
 
+    /**
+     * Balance totals, summed up once and then served until a wallet transaction or
+     * the mint tracker changes, the chain tip moves (which changes the depths) or a
+     * transaction leaves the mempool (which changes the unconfirmed balances).
+     * The locked coins excluding balance is only computed on request.
+     * The flags are cleared from mempool notifications, without cs_wallet.
+     */
+    mutable CWalletBalances cachedBalances;
+    mutable std::atomic<bool> fBalancesCached;
+    mutable std::atomic<bool> fBalanceExcludeLockedCached;
+    mutable CAmount nBalanceExcludeLockedCached;
+    mutable const CBlockIndex* pindexBalancesTip;
+    mutable uint64_t nBalancesTrackerCounter;
+
     /**
      * Used to keep track of spent outpoints, and
      * detect and report conflicts (double-spends or
@@ -781,6 +828,11 @@ public:
         fAnonymizableTallyCachedNonDenom = false;
         vecAnonymizableTallyCached.clear();
         vecAnonymizableTallyCachedNonDenom.clear();
+        fBalancesCached = false;
+        fBalanceExcludeLockedCached = false;
+        nBalanceExcludeLockedCached = 0;
+        pindexBalancesTip = NULL;
+        nBalancesTrackerCounter = 0;
         zwallet = NULL;
         bip47wallet.reset();
     }
@@ -915,6 +967,14 @@ public:
     CAmount GetWatchOnlyBalance() const;
     CAmount GetUnconfirmedWatchOnlyBalance() const;
     CAmount GetImmatureWatchOnlyBalance() const;
+    //! Sums up all balances from scratch, bypassing the cache
+    CWalletBalances ComputeBalances() const;
+    //! Cached balances, recomputed if outdated. Requires cs_main and cs_wallet
+    const CWalletBalances& GetCachedBalances() const;
+    //! Drop the cached balances, to be called when a wallet transaction changed
+    void MarkBalancesDirty();
+    /** Mempool callback, drops the cached balances when a transaction leaves the mempool other than by being mined */
+    void TransactionRemovedFromMempool(CTransactionRef tx, MemPoolRemovalReason reason);
     CAmount GetLegacyBalance(const isminefilter& filter, int minDepth, const std::string* account) const;
 
     static std::vector<CRecipient> CreateSigmaMintRecipients(